@@ -0,0 +1,70 @@
+//
+// Copyright 2020 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include <random>
+#include <string>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+
+#include "wasp/base/utf8.h"
+
+namespace wasp::bench {
+namespace {
+
+// Names like those in the name section of a large C++ program: mangled
+// symbols, which are nearly always ASCII.
+const std::vector<std::string>& GetNames() {
+  static std::vector<std::string> s_names = []() {
+    std::vector<std::string> names;
+    std::mt19937 rng{0};
+    for (int i = 0; i < 100000; ++i) {
+      std::string name = "_ZN4wasp6binary";
+      size_t length = 10 + rng() % 100;
+      while (name.size() < length) {
+        name += static_cast<char>('a' + rng() % 26);
+      }
+      if (i % 100 == 0) {
+        name += "\xc3\xa9";
+      }
+      names.push_back(name);
+    }
+    return names;
+  }();
+  return s_names;
+}
+
+template <bool (*IsValidFn)(string_view)>
+void BM_IsValidUtf8(::benchmark::State& state) {
+  const auto& names = GetNames();
+  size_t size = 0;
+  for (const auto& name : names) {
+    size += name.size();
+  }
+  for (auto _ : state) {
+    for (const auto& name : names) {
+      ::benchmark::DoNotOptimize(IsValidFn(name));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * names.size());
+  state.SetBytesProcessed(state.iterations() * size);
+}
+
+BENCHMARK_TEMPLATE(BM_IsValidUtf8, IsValidUtf8);
+BENCHMARK_TEMPLATE(BM_IsValidUtf8, IsValidUtf8Scalar);
+
+}  // namespace
+}  // namespace wasp::bench
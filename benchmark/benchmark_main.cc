@@ -0,0 +1,46 @@
+//
+// Copyright 2020 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include <filesystem>
+#include <iostream>
+
+#include "benchmark/benchmark.h"
+
+#include "benchmark/benchmark_utils.h"
+
+// Usage: wasp_benchmarks [--benchmark_* flags] [<file or directory>...]
+//
+// Benchmarks run over the given .wasm, .wat and .wast files (directories are
+// searched recursively), or over the spec testsuite when none are given. A
+// large synthetic module is always included. Use --benchmark_format=json (or
+// --benchmark_out=<file>) to get machine-readable results.
+int main(int argc, char** argv) {
+  ::benchmark::Initialize(&argc, argv);
+  for (int i = 1; i < argc; ++i) {
+    if (!wasp::bench::AddInput(argv[i])) {
+      std::cerr << "Error reading " << argv[i] << ".\n";
+      return 1;
+    }
+  }
+#ifdef WASP_BENCHMARK_TESTSUITE_DIR
+  if (argc == 1 &&
+      std::filesystem::is_directory(WASP_BENCHMARK_TESTSUITE_DIR)) {
+    wasp::bench::AddInput(WASP_BENCHMARK_TESTSUITE_DIR);
+  }
+#endif
+  ::benchmark::RunSpecifiedBenchmarks();
+  return 0;
+}
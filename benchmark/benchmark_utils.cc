@@ -0,0 +1,271 @@
+//
+// Copyright 2020 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "benchmark/benchmark_utils.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <iterator>
+#include <utility>
+
+#include "absl/strings/str_format.h"
+
+#include "wasp/base/buffer.h"
+#include "wasp/base/buffered_errors.h"
+#include "wasp/binary/write.h"
+#include "wasp/convert/to_binary.h"
+#include "wasp/text/desugar.h"
+#include "wasp/text/read.h"
+#include "wasp/text/read/context.h"
+#include "wasp/text/read/tokenizer.h"
+#include "wasp/text/resolve.h"
+
+namespace wasp::bench {
+
+namespace fs = std::filesystem;
+
+namespace {
+
+const Index kSyntheticFunctionCount = 5000;
+
+std::vector<InputFile>& InputFiles() {
+  static std::vector<InputFile> s_files;
+  return s_files;
+}
+
+bool IsBinary(SpanU8 data) {
+  return data.size() >= 4 && data.first(4) == "\0asm"_su8;
+}
+
+bool AddInputFile(const fs::path& path) {
+  auto optfile = MapFile(path.string());
+  if (!optfile) {
+    return false;
+  }
+  InputFiles().push_back(InputFile{path.string(), std::move(*optfile)});
+  return true;
+}
+
+void AddResolvableModule(const text::Module& module,
+                         std::vector<text::Module>& modules) {
+  BufferedErrors errors;
+  text::Module copy = module;
+  text::Resolve(copy, errors);
+  if (!errors.has_error()) {
+    modules.push_back(module);
+  }
+}
+
+// Reads the modules in a .wat or .wast file, keeping only those that resolve
+// without errors.
+void ReadTextModules(SpanU8 data, std::vector<text::Module>& modules) {
+  BufferedErrors errors;
+  text::Tokenizer tokenizer{data};
+  text::Context context{GetFeatures(), errors};
+  auto script = ReadScript(tokenizer, context);
+  if (script && !errors.has_error()) {
+    for (const auto& command : *script) {
+      if (command->is_script_module() &&
+          command->script_module().has_module()) {
+        AddResolvableModule(command->script_module().module(), modules);
+      }
+    }
+    return;
+  }
+
+  // Not a script; try a single module whose fields are at the top level.
+  errors.Clear();
+  text::Tokenizer module_tokenizer{data};
+  text::Context module_context{GetFeatures(), errors};
+  auto module = ReadSingleModule(module_tokenizer, module_context);
+  if (module && !errors.has_error()) {
+    AddResolvableModule(*module, modules);
+  }
+}
+
+}  // namespace
+
+bool AddInput(string_view path_str) {
+  fs::path path{std::string{path_str}};
+  if (!fs::is_directory(path)) {
+    return AddInputFile(path);
+  }
+
+  std::vector<fs::path> paths;
+  for (const auto& entry : fs::recursive_directory_iterator(path)) {
+    auto extension = entry.path().extension();
+    if (extension == ".wasm" || extension == ".wat" || extension == ".wast") {
+      paths.push_back(entry.path());
+    }
+  }
+  std::sort(paths.begin(), paths.end());
+  for (const auto& path : paths) {
+    if (!AddInputFile(path)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+auto GetInputFiles() -> const std::vector<InputFile>& {
+  return InputFiles();
+}
+
+auto GetFeatures() -> const Features& {
+  static Features s_features = []() {
+    Features features;
+    features.EnableAll();
+    return features;
+  }();
+  return s_features;
+}
+
+auto GenerateSyntheticModule(Index function_count) -> std::string {
+  std::string result =
+      "(module\n"
+      "  (type $t (func (param i32 i32) (result i32)))\n"
+      "  (import \"env\" \"f\" (func $f_import (type $t)))\n"
+      "  (memory 1)\n"
+      "  (table 16 funcref)\n"
+      "  (global $g (mut i32) (i32.const 0))\n";
+  for (Index i = 0; i < function_count; ++i) {
+    std::string callee =
+        i == 0 ? "$f_import" : absl::StrFormat("$f%u", i - 1);
+    absl::StrAppendFormat(&result,
+        "  (func $f%u (export \"f%u\") (type $t) (local i32 i64 f64)\n"
+        "    block $exit\n"
+        "      loop $loop\n"
+        "        local.get 0\n"
+        "        local.get 1\n"
+        "        i32.add\n"
+        "        local.tee 2\n"
+        "        i32.load offset=4\n"
+        "        global.get $g\n"
+        "        i32.xor\n"
+        "        global.set $g\n"
+        "        local.get 3\n"
+        "        i64.const %u\n"
+        "        i64.mul\n"
+        "        local.set 3\n"
+        "        local.get 4\n"
+        "        f64.const 1.5\n"
+        "        f64.add\n"
+        "        local.set 4\n"
+        "        local.get 2\n"
+        "        local.get 1\n"
+        "        call %s\n"
+        "        drop\n"
+        "        local.get 2\n"
+        "        i32.const 1000\n"
+        "        i32.lt_u\n"
+        "        br_if $loop\n"
+        "        local.get 0\n"
+        "        br_table $exit $loop $exit\n"
+        "      end\n"
+        "    end\n"
+        "    local.get 2)\n",
+        i, i, i * 7919, callee);
+  }
+  result += "  (elem (i32.const 0) $f0 $f1)\n";
+  result += "  (data (i32.const 0) \"hello\"))\n";
+  return result;
+}
+
+auto GetTextInputs() -> std::vector<SpanU8> {
+  static const std::string s_synthetic =
+      GenerateSyntheticModule(kSyntheticFunctionCount);
+  std::vector<SpanU8> result;
+  for (const auto& input : InputFiles()) {
+    SpanU8 data = input.file.span();
+    if (!IsBinary(data)) {
+      result.push_back(data);
+    }
+  }
+  result.push_back(SpanU8{reinterpret_cast<const u8*>(s_synthetic.data()),
+                          s_synthetic.size()});
+  return result;
+}
+
+auto GetTextModules() -> const std::vector<text::Module>& {
+  static std::vector<text::Module> s_modules = []() {
+    std::vector<text::Module> modules;
+    for (auto data : GetTextInputs()) {
+      ReadTextModules(data, modules);
+    }
+    return modules;
+  }();
+  return s_modules;
+}
+
+auto GetDesugaredTextModules() -> const std::vector<text::Module>& {
+  static std::vector<text::Module> s_modules = []() {
+    std::vector<text::Module> modules = GetTextModules();
+    BufferedErrors errors;
+    for (auto& module : modules) {
+      text::Resolve(module, errors);
+      text::Desugar(module);
+    }
+    return modules;
+  }();
+  return s_modules;
+}
+
+auto GetBinaryModules() -> const std::vector<binary::Module>& {
+  // The binary modules refer to strings and buffers owned by the context.
+  static convert::Context s_context;
+  static std::vector<binary::Module> s_modules = []() {
+    std::vector<binary::Module> modules;
+    for (const auto& module : GetDesugaredTextModules()) {
+      modules.push_back(*convert::ToBinary(s_context, module));
+    }
+    return modules;
+  }();
+  return s_modules;
+}
+
+auto GetBinaryInputs() -> std::vector<SpanU8> {
+  static std::vector<Buffer> s_buffers = []() {
+    std::vector<Buffer> buffers;
+    for (const auto& module : GetBinaryModules()) {
+      Buffer buffer;
+      binary::Write(module, std::back_inserter(buffer));
+      buffers.push_back(std::move(buffer));
+    }
+    return buffers;
+  }();
+
+  std::vector<SpanU8> result;
+  for (const auto& input : InputFiles()) {
+    SpanU8 data = input.file.span();
+    if (IsBinary(data)) {
+      result.push_back(data);
+    }
+  }
+  for (const auto& buffer : s_buffers) {
+    result.push_back(buffer);
+  }
+  return result;
+}
+
+size_t TotalSize(const std::vector<SpanU8>& inputs) {
+  size_t size = 0;
+  for (auto data : inputs) {
+    size += data.size();
+  }
+  return size;
+}
+
+}  // namespace wasp::bench
@@ -0,0 +1,74 @@
+//
+// Copyright 2020 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef BENCHMARK_BENCHMARK_UTILS_H_
+#define BENCHMARK_BENCHMARK_UTILS_H_
+
+#include <string>
+#include <vector>
+
+#include "wasp/base/features.h"
+#include "wasp/base/file.h"
+#include "wasp/base/span.h"
+#include "wasp/base/string_view.h"
+#include "wasp/base/types.h"
+#include "wasp/binary/types.h"
+#include "wasp/text/types.h"
+
+namespace wasp::bench {
+
+struct InputFile {
+  std::string filename;
+  MappedFile file;
+};
+
+// Adds a .wasm, .wat or .wast file, or every such file in a directory
+// (recursively), as a benchmark input.
+bool AddInput(string_view path);
+auto GetInputFiles() -> const std::vector<InputFile>&;
+
+// All features are enabled when reading inputs, since the spec testsuite
+// includes proposals.
+auto GetFeatures() -> const Features&;
+
+// A text module with `function_count` functions, each a loop with a mix of
+// loads, arithmetic, calls and branches. It is valid, so validation
+// benchmarks visit the whole module.
+auto GenerateSyntheticModule(Index function_count) -> std::string;
+
+// The contents of the .wat and .wast inputs, followed by a large synthetic
+// module.
+auto GetTextInputs() -> std::vector<SpanU8>;
+
+// The modules in the text inputs, as read (i.e. not yet resolved or
+// desugared). Files that fail to parse are skipped.
+auto GetTextModules() -> const std::vector<text::Module>&;
+
+// GetTextModules(), resolved and desugared.
+auto GetDesugaredTextModules() -> const std::vector<text::Module>&;
+
+// GetDesugaredTextModules(), converted to binary.
+auto GetBinaryModules() -> const std::vector<binary::Module>&;
+
+// The .wasm inputs, followed by the encoded GetBinaryModules().
+auto GetBinaryInputs() -> std::vector<SpanU8>;
+
+// The total size of the inputs, for SetBytesProcessed.
+size_t TotalSize(const std::vector<SpanU8>&);
+
+}  // namespace wasp::bench
+
+#endif  // BENCHMARK_BENCHMARK_UTILS_H_
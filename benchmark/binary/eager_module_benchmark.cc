@@ -0,0 +1,78 @@
+//
+// Copyright 2020 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include <memory>
+
+#include "benchmark/benchmark.h"
+
+#include "benchmark/benchmark_utils.h"
+#include "wasp/base/errors_nop.h"
+#include "wasp/base/thread_pool.h"
+#include "wasp/binary/eager_module.h"
+
+namespace wasp::bench {
+namespace {
+
+using namespace ::wasp::binary;
+
+// Reads the binary inputs with ReadModuleEager; the argument is the number of
+// threads, or 0 to read without a thread pool.
+void BM_ReadModuleEager(::benchmark::State& state) {
+  auto inputs = GetBinaryInputs();
+  std::unique_ptr<ThreadPool> thread_pool;
+  if (state.range(0) > 0) {
+    thread_pool = std::make_unique<ThreadPool>(state.range(0));
+  }
+  ErrorsNop errors;
+  for (auto _ : state) {
+    for (auto data : inputs) {
+      auto module =
+          ReadModuleEager(data, GetFeatures(), errors, thread_pool.get());
+      ::benchmark::DoNotOptimize(module.codes.data());
+    }
+  }
+  state.SetBytesProcessed(state.iterations() * TotalSize(inputs));
+}
+
+BENCHMARK(BM_ReadModuleEager)->Arg(0)->Arg(1)->Arg(2)->Arg(4)->UseRealTime();
+
+// Like BM_ReadModuleEager, but the function bodies are read into arenas.
+void BM_ReadArenaModuleEager(::benchmark::State& state) {
+  auto inputs = GetBinaryInputs();
+  std::unique_ptr<ThreadPool> thread_pool;
+  if (state.range(0) > 0) {
+    thread_pool = std::make_unique<ThreadPool>(state.range(0));
+  }
+  ErrorsNop errors;
+  for (auto _ : state) {
+    for (auto data : inputs) {
+      auto module =
+          ReadArenaModuleEager(data, GetFeatures(), errors, thread_pool.get());
+      ::benchmark::DoNotOptimize(module.module.codes.data());
+    }
+  }
+  state.SetBytesProcessed(state.iterations() * TotalSize(inputs));
+}
+
+BENCHMARK(BM_ReadArenaModuleEager)
+    ->Arg(0)
+    ->Arg(1)
+    ->Arg(2)
+    ->Arg(4)
+    ->UseRealTime();
+
+}  // namespace
+}  // namespace wasp::bench
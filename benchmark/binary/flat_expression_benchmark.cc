@@ -0,0 +1,75 @@
+//
+// Copyright 2020 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "benchmark/benchmark.h"
+
+#include "benchmark/benchmark_utils.h"
+#include "wasp/base/errors_nop.h"
+#include "wasp/binary/flat_expression.h"
+#include "wasp/binary/lazy_module.h"
+#include "wasp/binary/sections.h"
+
+namespace wasp::bench {
+namespace {
+
+using namespace ::wasp::binary;
+
+// The bodies of all functions in the binary inputs.
+std::vector<SpanU8> GetCodeBodies() {
+  std::vector<SpanU8> result;
+  ErrorsNop errors;
+  for (auto data : GetBinaryInputs()) {
+    auto module = ReadModule(data, GetFeatures(), errors);
+    for (auto section : module.sections) {
+      if (section->id() == SectionId::Code) {
+        for (auto code : ReadCodeSection(*section->known(), module.context)
+                             .sequence) {
+          result.push_back(code->body->data);
+        }
+      }
+    }
+  }
+  return result;
+}
+
+void ReadFlatExpressions(::benchmark::State& state,
+                         ReadFlatExpressionFunction read) {
+  auto bodies = GetCodeBodies();
+  ErrorsNop errors;
+  Context context{GetFeatures(), errors};
+  size_t count = 0;
+  for (auto _ : state) {
+    for (auto body : bodies) {
+      count += read(body, context).size();
+    }
+  }
+  state.SetItemsProcessed(count);
+  state.SetBytesProcessed(state.iterations() * TotalSize(bodies));
+}
+
+void BM_ReadFlatExpressionRuntime(::benchmark::State& state) {
+  ReadFlatExpressions(state, ReadFlatExpression);
+}
+
+void BM_ReadFlatExpressionStatic(::benchmark::State& state) {
+  ReadFlatExpressions(state, GetReadFlatExpression(GetFeatures()));
+}
+
+BENCHMARK(BM_ReadFlatExpressionRuntime);
+BENCHMARK(BM_ReadFlatExpressionStatic);
+
+}  // namespace
+}  // namespace wasp::bench
@@ -0,0 +1,79 @@
+//
+// Copyright 2020 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "benchmark/benchmark.h"
+
+#include "benchmark/benchmark_utils.h"
+#include "wasp/base/errors_nop.h"
+#include "wasp/binary/lazy_module.h"
+#include "wasp/binary/visitor.h"
+
+namespace wasp::bench {
+namespace {
+
+using namespace ::wasp::binary;
+
+// Counts every item in the module, including instructions, so that the whole
+// module is decoded.
+struct CountingVisitor : visit::Visitor {
+  visit::Result OnSection(At<Section>) {
+    count++;
+    return visit::Result::Ok;
+  }
+
+  visit::Result OnInstruction(const At<Instruction>&) {
+    count++;
+    return visit::Result::Ok;
+  }
+
+  size_t count = 0;
+};
+
+void BM_LazyModuleSections(::benchmark::State& state) {
+  auto inputs = GetBinaryInputs();
+  ErrorsNop errors;
+  for (auto _ : state) {
+    for (auto data : inputs) {
+      auto module = ReadModule(data, GetFeatures(), errors);
+      for (auto section : module.sections) {
+        ::benchmark::DoNotOptimize(section);
+      }
+    }
+  }
+  state.SetBytesProcessed(state.iterations() * TotalSize(inputs));
+}
+
+void BM_LazyModuleVisit(::benchmark::State& state) {
+  auto inputs = GetBinaryInputs();
+  ErrorsNop errors;
+  size_t count = 0;
+  for (auto _ : state) {
+    for (auto data : inputs) {
+      auto module = ReadModule(data, GetFeatures(), errors);
+      CountingVisitor visitor;
+      visit::Visit(module, visitor);
+      count += visitor.count;
+    }
+  }
+  state.SetItemsProcessed(count);
+  state.SetBytesProcessed(state.iterations() * TotalSize(inputs));
+}
+
+BENCHMARK(BM_LazyModuleSections);
+BENCHMARK(BM_LazyModuleVisit);
+
+}  // namespace
+}  // namespace wasp::bench
@@ -0,0 +1,59 @@
+//
+// Copyright 2020 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include <vector>
+
+#include "benchmark/benchmark.h"
+
+#include "benchmark/benchmark_utils.h"
+#include "wasp/base/errors_nop.h"
+#include "wasp/binary/eager_module.h"
+#include "wasp/binary/types.h"
+
+namespace wasp::bench {
+namespace {
+
+// Reads the binary inputs with ReadModuleEager, or ReadArenaModuleEager if
+// `use_arena` is set, then times only dropping them.
+void BM_BinaryModuleTeardown(::benchmark::State& state, bool use_arena) {
+  const auto inputs = GetBinaryInputs();
+  ErrorsNop errors;
+  for (auto _ : state) {
+    state.PauseTiming();
+    std::vector<binary::Module> heap_modules;
+    std::vector<binary::ArenaModule> arena_modules;
+    for (auto data : inputs) {
+      if (use_arena) {
+        arena_modules.push_back(
+            binary::ReadArenaModuleEager(data, GetFeatures(), errors));
+      } else {
+        heap_modules.push_back(
+            binary::ReadModuleEager(data, GetFeatures(), errors));
+      }
+    }
+    state.ResumeTiming();
+
+    heap_modules.clear();
+    arena_modules.clear();
+  }
+  state.SetItemsProcessed(state.iterations() * inputs.size());
+}
+
+BENCHMARK_CAPTURE(BM_BinaryModuleTeardown, heap, false);
+BENCHMARK_CAPTURE(BM_BinaryModuleTeardown, arena, true);
+
+}  // namespace
+}  // namespace wasp::bench
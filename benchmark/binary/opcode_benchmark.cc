@@ -0,0 +1,101 @@
+//
+// Copyright 2020 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include <vector>
+
+#include "benchmark/benchmark.h"
+
+#include "benchmark/benchmark_utils.h"
+#include "wasp/base/buffer.h"
+#include "wasp/base/errors_nop.h"
+#include "wasp/binary/encoding.h"
+#include "wasp/binary/lazy_expression.h"
+#include "wasp/binary/lazy_module.h"
+#include "wasp/binary/read.h"
+#include "wasp/binary/sections.h"
+
+namespace wasp::bench {
+namespace {
+
+using namespace ::wasp::binary;
+
+// The encoded opcodes of all instructions in the binary inputs, concatenated.
+struct OpcodeStream {
+  Buffer bytes;
+  size_t count = 0;
+};
+
+OpcodeStream CollectOpcodes() {
+  OpcodeStream stream;
+  ErrorsNop errors;
+  for (auto data : GetBinaryInputs()) {
+    auto module = ReadModule(data, GetFeatures(), errors);
+    for (auto section : module.sections) {
+      if (!section->is_known() || section->known()->id != SectionId::Code) {
+        continue;
+      }
+      auto code_section = ReadCodeSection(section->known(), module.context);
+      for (auto code : code_section.sequence) {
+        for (auto instr : ReadExpression(code->body, module.context)) {
+          Location loc = instr->opcode.loc();
+          stream.bytes.insert(stream.bytes.end(), loc.begin(), loc.end());
+          stream.count++;
+        }
+      }
+    }
+  }
+  return stream;
+}
+
+void BM_ReadOpcode(::benchmark::State& state) {
+  auto stream = CollectOpcodes();
+  ErrorsNop errors;
+  Context context{GetFeatures(), errors};
+  for (auto _ : state) {
+    SpanU8 data = stream.bytes;
+    while (!data.empty()) {
+      ::benchmark::DoNotOptimize(Read<Opcode>(&data, context));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * stream.count);
+  state.SetBytesProcessed(state.iterations() * stream.bytes.size());
+}
+
+// Decodes every (prefix, code) pair, including the unknown ones.
+void BM_DecodeOpcode(::benchmark::State& state) {
+  const Features& features = GetFeatures();
+  const u8 kPrefixes[] = {encoding::Opcode::GcPrefix,
+                          encoding::Opcode::MiscPrefix,
+                          encoding::Opcode::SimdPrefix,
+                          encoding::Opcode::ThreadsPrefix};
+  for (auto _ : state) {
+    for (u32 code = 0; code < 256; ++code) {
+      ::benchmark::DoNotOptimize(
+          encoding::Opcode::Decode(static_cast<u8>(code), features));
+      for (u8 prefix : kPrefixes) {
+        ::benchmark::DoNotOptimize(
+            encoding::Opcode::Decode(prefix, code, features));
+      }
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * 256 * 5);
+}
+
+BENCHMARK(BM_ReadOpcode);
+BENCHMARK(BM_DecodeOpcode);
+
+}  // namespace
+}  // namespace wasp::bench
@@ -0,0 +1,167 @@
+//
+// Copyright 2020 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include <iterator>
+#include <random>
+
+#include "benchmark/benchmark.h"
+
+#include "benchmark/benchmark_utils.h"
+#include "wasp/base/buffer.h"
+#include "wasp/base/errors_nop.h"
+#include "wasp/base/features.h"
+#include "wasp/binary/lazy_expression.h"
+#include "wasp/binary/lazy_module.h"
+#include "wasp/binary/read/read_var_int.h"
+#include "wasp/binary/sections.h"
+#include "wasp/binary/write.h"
+
+namespace wasp::bench {
+namespace {
+
+using namespace ::wasp::binary;
+
+// The LEB128-encoded immediates of a set of function bodies, concatenated.
+struct VarIntStream {
+  Buffer bytes;
+  size_t count = 0;
+};
+
+struct VarIntStreams {
+  VarIntStream u32s;
+  VarIntStream s32s;
+  VarIntStream s64s;
+};
+
+void Append(VarIntStream& stream, Location loc) {
+  stream.bytes.insert(stream.bytes.end(), loc.begin(), loc.end());
+  stream.count++;
+}
+
+void CollectVarInts(SpanU8 data, VarIntStreams& streams) {
+  ErrorsNop errors;
+  Features features;
+  features.EnableAll();
+  auto module = ReadModule(data, features, errors);
+  for (auto section : module.sections) {
+    if (!section->is_known() || section->known()->id != SectionId::Code) {
+      continue;
+    }
+    auto code_section = ReadCodeSection(section->known(), module.context);
+    for (auto code : code_section.sequence) {
+      for (auto instr : ReadExpression(code->body, module.context)) {
+        if (instr->has_index_immediate()) {
+          Append(streams.u32s, instr->index_immediate().loc());
+        } else if (instr->has_mem_arg_immediate()) {
+          Append(streams.u32s, instr->mem_arg_immediate()->align_log2.loc());
+          Append(streams.u32s, instr->mem_arg_immediate()->offset.loc());
+        } else if (instr->has_s32_immediate()) {
+          Append(streams.s32s, instr->s32_immediate().loc());
+        } else if (instr->has_s64_immediate()) {
+          Append(streams.s64s, instr->s64_immediate().loc());
+        }
+      }
+    }
+  }
+}
+
+// Roughly the length distribution seen in compiled code: mostly 1-byte
+// indices and constants, with a tail of larger offsets and addresses.
+template <typename T>
+void AddSynthetic(VarIntStream& stream, std::mt19937& rng, size_t count) {
+  std::discrete_distribution<int> bits_dist{{60, 25, 10, 4, 1}};
+  const int kBits[] = {6, 13, 20, 27, sizeof(T) * 8 - 1};
+  for (size_t i = 0; i < count; ++i) {
+    int bits = kBits[bits_dist(rng)];
+    auto value = static_cast<T>(rng() & ((u64{1} << bits) - 1));
+    if (std::is_signed_v<T> && (rng() & 1)) {
+      value = -value;
+    }
+    WriteVarInt(value, std::back_inserter(stream.bytes));
+    stream.count++;
+  }
+}
+
+const VarIntStreams& GetVarIntStreams() {
+  static VarIntStreams s_streams = []() {
+    VarIntStreams streams;
+    for (auto data : GetBinaryInputs()) {
+      CollectVarInts(data, streams);
+    }
+    std::mt19937 rng{0};
+    const size_t kSyntheticCount = 1 << 20;
+    if (streams.u32s.count == 0) {
+      AddSynthetic<u32>(streams.u32s, rng, kSyntheticCount);
+    }
+    if (streams.s32s.count == 0) {
+      AddSynthetic<s32>(streams.s32s, rng, kSyntheticCount);
+    }
+    if (streams.s64s.count == 0) {
+      AddSynthetic<s64>(streams.s64s, rng, kSyntheticCount);
+    }
+    return streams;
+  }();
+  return s_streams;
+}
+
+template <typename T, OptAt<T> (*ReadFn)(SpanU8*, Context&, string_view)>
+void BM_ReadVarInt(::benchmark::State& state, const VarIntStream& stream) {
+  ErrorsNop errors;
+  Context context{errors};
+  for (auto _ : state) {
+    SpanU8 data{stream.bytes};
+    while (!data.empty()) {
+      auto value = ReadFn(&data, context, "bench");
+      ::benchmark::DoNotOptimize(value);
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * stream.count);
+  state.SetBytesProcessed(state.iterations() * stream.bytes.size());
+}
+
+void BM_ReadVarIntU32_Fast(::benchmark::State& state) {
+  BM_ReadVarInt<u32, ReadVarInt<u32>>(state, GetVarIntStreams().u32s);
+}
+
+void BM_ReadVarIntU32_Slow(::benchmark::State& state) {
+  BM_ReadVarInt<u32, ReadVarIntSlow<u32>>(state, GetVarIntStreams().u32s);
+}
+
+void BM_ReadVarIntS32_Fast(::benchmark::State& state) {
+  BM_ReadVarInt<s32, ReadVarInt<s32>>(state, GetVarIntStreams().s32s);
+}
+
+void BM_ReadVarIntS32_Slow(::benchmark::State& state) {
+  BM_ReadVarInt<s32, ReadVarIntSlow<s32>>(state, GetVarIntStreams().s32s);
+}
+
+void BM_ReadVarIntS64_Fast(::benchmark::State& state) {
+  BM_ReadVarInt<s64, ReadVarInt<s64>>(state, GetVarIntStreams().s64s);
+}
+
+void BM_ReadVarIntS64_Slow(::benchmark::State& state) {
+  BM_ReadVarInt<s64, ReadVarIntSlow<s64>>(state, GetVarIntStreams().s64s);
+}
+
+BENCHMARK(BM_ReadVarIntU32_Fast);
+BENCHMARK(BM_ReadVarIntU32_Slow);
+BENCHMARK(BM_ReadVarIntS32_Fast);
+BENCHMARK(BM_ReadVarIntS32_Slow);
+BENCHMARK(BM_ReadVarIntS64_Fast);
+BENCHMARK(BM_ReadVarIntS64_Slow);
+
+}  // namespace
+}  // namespace wasp::bench
@@ -0,0 +1,46 @@
+//
+// Copyright 2020 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include <iterator>
+
+#include "benchmark/benchmark.h"
+
+#include "benchmark/benchmark_utils.h"
+#include "wasp/base/buffer.h"
+#include "wasp/binary/write.h"
+
+namespace wasp::bench {
+namespace {
+
+void BM_BinaryWrite(::benchmark::State& state) {
+  const auto& modules = GetBinaryModules();
+  size_t size = 0;
+  for (auto _ : state) {
+    for (const auto& module : modules) {
+      Buffer buffer;
+      binary::Write(module, std::back_inserter(buffer));
+      size += buffer.size();
+      ::benchmark::DoNotOptimize(buffer.data());
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * modules.size());
+  state.SetBytesProcessed(size);
+}
+
+BENCHMARK(BM_BinaryWrite);
+
+}  // namespace
+}  // namespace wasp::bench
@@ -0,0 +1,41 @@
+//
+// Copyright 2020 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "benchmark/benchmark.h"
+
+#include "benchmark/benchmark_utils.h"
+#include "wasp/convert/to_binary.h"
+
+namespace wasp::bench {
+namespace {
+
+void BM_ToBinary(::benchmark::State& state) {
+  const auto& modules = GetDesugaredTextModules();
+  for (auto _ : state) {
+    // The context owns the strings and buffers the binary modules refer to.
+    convert::Context context;
+    for (const auto& module : modules) {
+      auto binary_module = convert::ToBinary(context, module);
+      ::benchmark::DoNotOptimize(binary_module);
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * modules.size());
+}
+
+BENCHMARK(BM_ToBinary);
+
+}  // namespace
+}  // namespace wasp::bench
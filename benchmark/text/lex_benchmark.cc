@@ -0,0 +1,46 @@
+//
+// Copyright 2020 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "benchmark/benchmark.h"
+
+#include "benchmark/benchmark_utils.h"
+#include "wasp/text/read/lex.h"
+
+namespace wasp::bench {
+namespace {
+
+void BM_Lex(::benchmark::State& state) {
+  auto inputs = GetTextInputs();
+  size_t count = 0;
+  for (auto _ : state) {
+    for (auto data : inputs) {
+      while (true) {
+        auto token = text::Lex(&data);
+        count++;
+        if (token.type == text::TokenType::Eof) {
+          break;
+        }
+      }
+    }
+  }
+  state.SetItemsProcessed(count);
+  state.SetBytesProcessed(state.iterations() * TotalSize(inputs));
+}
+
+BENCHMARK(BM_Lex);
+
+}  // namespace
+}  // namespace wasp::bench
@@ -0,0 +1,75 @@
+//
+// Copyright 2020 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include <vector>
+
+#include "benchmark/benchmark.h"
+
+#include "benchmark/benchmark_utils.h"
+#include "wasp/base/buffered_errors.h"
+#include "wasp/text/desugar.h"
+#include "wasp/text/resolve.h"
+
+namespace wasp::bench {
+namespace {
+
+// Resolve and Desugar modify the module in place, so each iteration works on
+// a fresh copy; the copy isn't timed.
+template <typename F>
+void BM_TextTransform(::benchmark::State& state,
+                      const std::vector<text::Module>& modules,
+                      F&& transform) {
+  for (auto _ : state) {
+    state.PauseTiming();
+    std::vector<text::Module> copies = modules;
+    state.ResumeTiming();
+    for (auto& module : copies) {
+      transform(module);
+    }
+    state.PauseTiming();
+    copies.clear();
+    state.ResumeTiming();
+  }
+  state.SetItemsProcessed(state.iterations() * modules.size());
+}
+
+void BM_Resolve(::benchmark::State& state) {
+  BufferedErrors errors;
+  BM_TextTransform(state, GetTextModules(), [&](text::Module& module) {
+    text::Resolve(module, errors);
+  });
+}
+
+void BM_Desugar(::benchmark::State& state) {
+  // Desugar expects a resolved module, so run it on the resolved modules
+  // rather than the desugared ones (which it would leave unchanged).
+  static const std::vector<text::Module> s_resolved = []() {
+    std::vector<text::Module> modules = GetTextModules();
+    BufferedErrors errors;
+    for (auto& module : modules) {
+      text::Resolve(module, errors);
+    }
+    return modules;
+  }();
+  BM_TextTransform(state, s_resolved,
+                   [](text::Module& module) { text::Desugar(module); });
+}
+
+BENCHMARK(BM_Resolve);
+BENCHMARK(BM_Desugar);
+
+}  // namespace
+}  // namespace wasp::bench
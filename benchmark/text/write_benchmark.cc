@@ -0,0 +1,70 @@
+//
+// Copyright 2020 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+
+#include "benchmark/benchmark_utils.h"
+#include "wasp/text/formatters.h"
+#include "wasp/text/write.h"
+
+namespace wasp::bench {
+namespace {
+
+// The text reader appends an implicit `end` to each function body, but the
+// writer expects the body without it.
+auto GetWritableTextModules() -> const std::vector<text::Module>& {
+  static std::vector<text::Module> s_modules = []() {
+    std::vector<text::Module> modules = GetDesugaredTextModules();
+    for (auto& module : modules) {
+      for (auto& item : module) {
+        if (item.is_function()) {
+          auto& instructions = item.function()->instructions;
+          if (!instructions.empty() &&
+              instructions.back()->opcode == Opcode::End) {
+            instructions.pop_back();
+          }
+        }
+      }
+    }
+    return modules;
+  }();
+  return s_modules;
+}
+
+void BM_TextWrite(::benchmark::State& state) {
+  const auto& modules = GetWritableTextModules();
+  size_t size = 0;
+  for (auto _ : state) {
+    for (const auto& module : modules) {
+      text::WriteContext context;
+      std::string result;
+      text::Write(context, module, std::back_inserter(result));
+      size += result.size();
+      ::benchmark::DoNotOptimize(result.data());
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * modules.size());
+  state.SetBytesProcessed(size);
+}
+
+BENCHMARK(BM_TextWrite);
+
+}  // namespace
+}  // namespace wasp::bench
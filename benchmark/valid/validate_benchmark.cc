@@ -0,0 +1,94 @@
+//
+// Copyright 2020 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include <string>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+
+#include "benchmark/benchmark_utils.h"
+#include "wasp/base/buffered_errors.h"
+#include "wasp/base/concat.h"
+#include "wasp/base/optional.h"
+#include "wasp/binary/lazy_module.h"
+#include "wasp/binary/visitor.h"
+#include "wasp/valid/context.h"
+#include "wasp/valid/validate.h"
+#include "wasp/valid/validate_visitor.h"
+
+namespace wasp::bench {
+namespace {
+
+void BM_ValidateVisitor(::benchmark::State& state) {
+  auto inputs = GetBinaryInputs();
+  BufferedErrors errors;
+  for (auto _ : state) {
+    for (auto data : inputs) {
+      auto module = binary::ReadModule(data, GetFeatures(), errors);
+      valid::ValidateVisitor visitor{GetFeatures(), errors};
+      auto result = binary::visit::Visit(module, visitor);
+      ::benchmark::DoNotOptimize(result);
+    }
+    errors.Clear();
+  }
+  state.SetBytesProcessed(state.iterations() * TotalSize(inputs));
+}
+
+BENCHMARK(BM_ValidateVisitor);
+
+// A synthetic module with `count` functions, each exported once under a
+// unique name, e.g. as emitted by a toolchain that exports everything.
+void BM_ValidateExports(::benchmark::State& state) {
+  const Index count = static_cast<Index>(state.range(0));
+  std::vector<std::string> names;
+  std::vector<binary::Export> exports;
+  names.reserve(count);
+  exports.reserve(count);
+  for (Index i = 0; i < count; ++i) {
+    names.push_back(concat("export", i));
+  }
+  for (Index i = 0; i < count; ++i) {
+    exports.push_back(
+        binary::Export{ExternalKind::Function, names[i], count - 1 - i});
+  }
+
+  BufferedErrors errors;
+  valid::Context module_context{GetFeatures(), errors};
+  module_context.types.push_back(binary::DefinedType{binary::FunctionType{}});
+  module_context.defined_type_count = 1;
+  module_context.functions.assign(count, binary::Function{0});
+
+  // Copying (and destroying) the module context isn't timed.
+  optional<valid::Context> context;
+  for (auto _ : state) {
+    state.PauseTiming();
+    context.reset();
+    context.emplace(module_context, errors);
+    state.ResumeTiming();
+
+    bool valid = true;
+    for (const auto& export_ : exports) {
+      valid &= valid::Validate(*context, export_);
+    }
+    ::benchmark::DoNotOptimize(valid);
+  }
+  state.SetItemsProcessed(state.iterations() * count);
+}
+
+BENCHMARK(BM_ValidateExports)->Arg(100'000)->Arg(1'000'000);
+
+}  // namespace
+}  // namespace wasp::bench
@@ -56,10 +56,14 @@
     return H::combine(std::move(h), v.f1, v.f2, v.f3, v.f4, v.f5); \
   }
 
-#define WASP_ABSL_HASH_VALUE_CONTAINER(Name)    \
-  template <typename H>                         \
-  H AbslHashValue(H h, const ::wasp::Name& v) { \
-    return H::combine(std::move(h), v);         \
+// Hashes the elements directly, the same way absl hashes a vector or span.
+// Calling H::combine on the container would find this overload again if the
+// container is itself an absl type, such as InlinedVector.
+#define WASP_ABSL_HASH_VALUE_CONTAINER(Name)                          \
+  template <typename H>                                               \
+  H AbslHashValue(H h, const ::wasp::Name& v) {                       \
+    h = H::combine_contiguous(std::move(h), v.data(), v.size());      \
+    return H::combine(std::move(h), v.size());                        \
   }
 
 #endif  // WASP_BASE_ABSL_HASH_VALUE_MACROS_H_
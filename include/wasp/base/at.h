@@ -20,28 +20,38 @@
 #include <functional>
 #include <utility>
 
+#include "wasp/base/compact_location.h"
 #include "wasp/base/optional.h"
 #include "wasp/base/span.h"
 
 namespace wasp {
 
+// Building with WASP_COMPACT_LOCATIONS stores locations as 32-bit offsets
+// relative to the current LocationBase; see compact_location.h.
+#if WASP_COMPACT_LOCATIONS
+using AtLocation = CompactLocation;
+#else
+using AtLocation = Location;
+#endif
+
 template <typename T>
-struct At : std::pair<Location, T> {
+struct At : std::pair<AtLocation, T> {
   using value_type = T;
 
   At() = default;
-  At(T v) : std::pair<Location, T>{{}, std::move(v)} {}
-  explicit At(Location loc, T v) : std::pair<Location, T>{loc, std::move(v)} {}
+  At(T v) : std::pair<AtLocation, T>{{}, std::move(v)} {}
+  explicit At(Location loc, T v)
+      : std::pair<AtLocation, T>{AtLocation{loc}, std::move(v)} {}
 
   At& operator=(T v) {
-    this->first = Location{};
+    this->first = AtLocation{};
     this->second = v;
     return *this;
   }
 
   operator const T&() const { return this->second; }
 
-  Location loc() const { return this->first; }
+  Location loc() const { return ToLocation(this->first); }
 
   const T& value() const { return this->second; }
   T& value() { return this->second; }
@@ -0,0 +1,65 @@
+//
+// Copyright 2020 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef WASP_BASE_BUFFERED_ERRORS_H_
+#define WASP_BASE_BUFFERED_ERRORS_H_
+
+#include <string>
+#include <vector>
+
+#include "wasp/base/errors.h"
+#include "wasp/base/span.h"
+#include "wasp/base/string_view.h"
+
+namespace wasp {
+
+// Records errors so they can be replayed into another Errors object later,
+// e.g. to collect errors on worker threads and report them in a deterministic
+// order afterward.
+//
+// The context stack is only copied when an error occurs.
+class BufferedErrors : public Errors {
+ public:
+  // Number of errors recorded.
+  size_t size() const { return errors_.size(); }
+  bool has_error() const { return !errors_.empty(); }
+
+  void ReplayTo(Errors&) const;
+  // Replay the errors in [begin, end), along with their context.
+  void ReplayTo(Errors&, size_t begin, size_t end) const;
+  void Clear();
+
+ protected:
+  void HandleOnError(Location loc, string_view message) override;
+
+ private:
+  struct ErrorContext {
+    Location loc;
+    std::string desc;
+  };
+
+  struct BufferedError {
+    std::vector<ErrorContext> context;
+    Location loc;
+    std::string message;
+  };
+
+  std::vector<BufferedError> errors_;
+};
+
+}  // namespace wasp
+
+#endif  // WASP_BASE_BUFFERED_ERRORS_H_
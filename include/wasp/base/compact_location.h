@@ -0,0 +1,87 @@
+//
+// Copyright 2020 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef WASP_BASE_COMPACT_LOCATION_H_
+#define WASP_BASE_COMPACT_LOCATION_H_
+
+#include "wasp/base/span.h"
+#include "wasp/base/types.h"
+
+namespace wasp {
+
+// A Location stored as a 32-bit offset and size relative to the current
+// LocationBase of the thread that creates it, half the size of a Location. A
+// Location outside the base (or created when there is no base) is stored as an
+// empty location.
+//
+// At<T> uses this instead of Location when WASP_COMPACT_LOCATIONS is defined.
+class CompactLocation {
+ public:
+  CompactLocation() = default;
+  explicit CompactLocation(Location);
+
+  bool has_value() const { return offset_ != kNone; }
+
+  // Rebuilds the Location using this thread's current LocationBase, which
+  // must be the buffer that the location was created with.
+  auto ToLocation() const -> Location;
+
+ private:
+  static constexpr u32 kNone = ~u32{0};
+
+  u32 offset_ = kNone;
+  u32 size_ = 0;
+};
+
+// Compares the located bytes, like Location's operator==.
+bool operator==(const CompactLocation&, const CompactLocation&);
+bool operator!=(const CompactLocation&, const CompactLocation&);
+
+inline auto ToLocation(Location loc) -> Location { return loc; }
+inline auto ToLocation(const CompactLocation& loc) -> Location {
+  return loc.ToLocation();
+}
+
+// Makes `buffer` the current base for CompactLocations on this thread, until
+// this object is destroyed or a newer LocationBase is created on the thread.
+// Bases don't have to be destroyed in reverse order; the newest one that is
+// still alive is current. A LocationBase must be destroyed on the thread that
+// created it, and the buffer must outlive it.
+//
+// LazyModule (and so binary::ReadModule) has one for its data, as do the
+// tools' error reporters for the files that they report on. ThreadPool tasks
+// use the current base of the thread that called ParallelFor.
+class LocationBase {
+ public:
+  explicit LocationBase(SpanU8 buffer);
+  ~LocationBase();
+
+  LocationBase(const LocationBase&) = delete;
+  LocationBase& operator=(const LocationBase&) = delete;
+
+  // This thread's current base, or an empty span if there is none.
+  static auto Get() -> SpanU8;
+
+ private:
+  SpanU8 buffer_;
+  // The thread's other bases, so any of them can be removed.
+  LocationBase* older_;
+  LocationBase* newer_ = nullptr;
+};
+
+}  // namespace wasp
+
+#endif  // WASP_BASE_COMPACT_LOCATION_H_
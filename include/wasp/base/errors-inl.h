@@ -17,11 +17,12 @@
 namespace wasp {
 
 inline void Errors::PushContext(Location loc, string_view desc) {
-  HandlePushContext(loc, desc);
+  context_.push_back(Context{loc, desc});
 }
 
 inline void Errors::PopContext() {
-  HandlePopContext();
+  assert(!context_.empty());
+  context_.pop_back();
 }
 
 inline void Errors::OnError(Location loc, string_view message) {
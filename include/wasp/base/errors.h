@@ -17,6 +17,9 @@
 #ifndef WASP_BASE_ERRORS_H_
 #define WASP_BASE_ERRORS_H_
 
+#include <cassert>
+#include <vector>
+
 #include "wasp/base/span.h"
 #include "wasp/base/string_view.h"
 
@@ -24,15 +27,29 @@ namespace wasp {
 
 class Errors {
  public:
+  struct Context {
+    Location loc;
+    string_view desc;
+  };
+
   virtual ~Errors() {}
+
+  // The context stack is kept here rather than in the subclasses, so pushing
+  // and popping context is just a non-virtual vector update. Subclasses read
+  // it in HandleOnError, i.e. only when an error actually occurs. `desc` must
+  // outlive the matching PopContext.
   void PushContext(Location loc, string_view desc);
   void PopContext();
   void OnError(Location loc, string_view message);
 
+  // The current context, outermost first.
+  auto context() const -> const std::vector<Context>& { return context_; }
+
  protected:
-  virtual void HandlePushContext(Location loc, string_view desc) = 0;
-  virtual void HandlePopContext() = 0;
   virtual void HandleOnError(Location loc, string_view message) = 0;
+
+ private:
+  std::vector<Context> context_;
 };
 
 }  // namespace wasp
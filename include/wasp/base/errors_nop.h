@@ -23,8 +23,6 @@ namespace wasp {
 
 class ErrorsNop : public Errors {
  protected:
-  void HandlePushContext(Location loc, string_view desc) override {}
-  void HandlePopContext() override {}
   void HandleOnError(Location loc, string_view message) override {}
 };
 
@@ -43,6 +43,21 @@ class Features {
 #undef WASP_V
   };
 
+  // Bits of a default-constructed Features.
+  static constexpr Bits kDefaultBits = 0
+#define WASP_V(enum_, variable, flag, default_) \
+  | (default_ ? Bits{enum_} : Bits{0})
+#include "wasp/base/features.inc"
+#undef WASP_V
+      ;
+
+  // Bits of a Features after EnableAll().
+  static constexpr Bits kAllBits = 0
+#define WASP_V(enum_, variable, flag, default_) | Bits{enum_}
+#include "wasp/base/features.inc"
+#undef WASP_V
+      ;
+
   explicit Features();
   explicit Features(Bits);
 
@@ -83,6 +98,22 @@ class Features {
   Bits bits_ = 0;
 };
 
+// A feature set that is fixed at compile time. It has the same
+// `*_enabled()` queries as Features, so code that is templated on its
+// features type can be instantiated with a StaticFeatures to fold away the
+// checks for disabled proposals. `kBits` must already include the features
+// that the enabled ones depend on (see Features::UpdateDependencies).
+template <Features::Bits kBits>
+struct StaticFeatures {
+  static constexpr Features::Bits bits() { return kBits; }
+
+#define WASP_V(enum_, variable, flag, default_) \
+  static constexpr bool variable##_enabled() {  \
+    return (kBits & Features::enum_) != 0;      \
+  }
+#include "wasp/base/features.inc"
+#undef WASP_V
+};
 
 }  // namespace wasp
 
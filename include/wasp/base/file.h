@@ -28,6 +28,45 @@ namespace wasp {
 
 optional<Buffer> ReadFile(string_view filename);
 
+// Hint passed to the OS about how a mapped file will be accessed.
+enum class FileAccess {
+  Sequential,  // Read front-to-back once, e.g. validate or dump.
+  Random,      // Jump around the file, e.g. dump -f or cfg.
+};
+
+// Read-only view of a file's contents. Regular files are memory-mapped, so the
+// data is paged in on demand rather than copied. Anything that can't be mapped
+// (pipes, character devices, stdin given as "-", or platforms without mmap)
+// falls back to reading the contents into a Buffer.
+class MappedFile {
+ public:
+  MappedFile() = default;
+  explicit MappedFile(Buffer);
+  ~MappedFile();
+
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+  MappedFile(MappedFile&&) noexcept;
+  MappedFile& operator=(MappedFile&&) noexcept;
+
+  bool is_mapped() const { return map_ != nullptr; }
+  SpanU8 span() const { return span_; }
+  operator SpanU8() const { return span_; }
+
+ private:
+  friend optional<MappedFile> MapFile(string_view, FileAccess);
+
+  void Reset();
+
+  void* map_ = nullptr;
+  size_t map_size_ = 0;
+  Buffer buffer_;
+  SpanU8 span_;
+};
+
+optional<MappedFile> MapFile(string_view filename,
+                             FileAccess = FileAccess::Sequential);
+
 }  // namespace wasp
 
 #endif  // WASP_BASE_FILE_H_
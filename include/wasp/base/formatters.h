@@ -23,6 +23,7 @@
 #include "wasp/base/at.h"
 #include "wasp/base/features.h"
 #include "wasp/base/formatter_macros.h"
+#include "wasp/base/inlined_vector.h"
 #include "wasp/base/optional.h"
 #include "wasp/base/span.h"
 #include "wasp/base/string_view.h"
@@ -65,9 +66,13 @@ std::ostream& operator<<(std::ostream&, ::wasp::SpanU8);
 template <typename T, size_t N>
 std::ostream& operator<<(std::ostream&, const ::std::array<T, N>&);
 
-// std::vector<T>
-template <typename T>
-std::ostream& operator<<(std::ostream&, const ::std::vector<T>&);
+// std::vector<T, A>
+template <typename T, typename A>
+std::ostream& operator<<(std::ostream&, const ::std::vector<T, A>&);
+
+// InlinedVector<T, N, A>
+template <typename T, size_t N, typename A>
+std::ostream& operator<<(std::ostream&, const ::wasp::InlinedVector<T, N, A>&);
 
 // variant<Ts...>
 template <typename... Ts>
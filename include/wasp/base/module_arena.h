@@ -0,0 +1,146 @@
+//
+// Copyright 2020 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef WASP_BASE_MODULE_ARENA_H_
+#define WASP_BASE_MODULE_ARENA_H_
+
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+#include "wasp/base/inlined_vector.h"
+#include "wasp/base/types.h"
+
+namespace wasp {
+
+// A monotonic arena for the many small vectors that make up a decoded
+// module (instruction lists, value type lists, br_table targets, ...).
+// Deallocation is a no-op; all memory is released at once when the arena is
+// destroyed, so dropping a large module doesn't free each vector separately.
+//
+// Arena use is explicit: a container only allocates from an arena if its
+// ArenaAllocator was constructed with one, e.g. by a reader whose context has
+// an arena (see binary::ReadArenaModuleEager, which returns the module along
+// with the arenas that it owns). The arena must outlive everything allocated
+// from it; debug builds check this when the arena is destroyed. An arena is
+// not thread-safe, so each thread needs its own.
+class ModuleArena {
+ public:
+  static constexpr size_t kDefaultBlockSize = 64 * 1024;
+
+  explicit ModuleArena(size_t block_size = kDefaultBlockSize);
+  ~ModuleArena();
+
+  ModuleArena(const ModuleArena&) = delete;
+  ModuleArena& operator=(const ModuleArena&) = delete;
+
+  void* Allocate(size_t size, size_t align);
+  // Only counts the live allocations, so debug builds can check that none
+  // outlive the arena; the memory is released when the arena is destroyed.
+  void Deallocate();
+
+  // The total size of all allocations, not including unused block space.
+  size_t bytes_allocated() const { return bytes_allocated_; }
+  size_t block_count() const { return blocks_.size(); }
+
+ private:
+  u8* AllocateBlock(size_t size);
+
+  size_t block_size_;
+  std::vector<std::unique_ptr<u8[]>> blocks_;
+  u8* ptr_ = nullptr;
+  u8* end_ = nullptr;
+  size_t bytes_allocated_ = 0;
+  size_t live_allocations_ = 0;
+};
+
+// Allocates from the ModuleArena it was constructed with, or from the heap
+// when default-constructed. Moving a container keeps its arena; copying a
+// container always makes a heap copy, so a copy never depends on an arena
+// that it doesn't know about.
+template <typename T>
+class ArenaAllocator {
+ public:
+  using value_type = T;
+  using propagate_on_container_move_assignment = std::true_type;
+  using propagate_on_container_swap = std::true_type;
+
+  ArenaAllocator() : arena_{nullptr} {}
+  explicit ArenaAllocator(ModuleArena* arena) : arena_{arena} {}
+
+  template <typename U>
+  ArenaAllocator(const ArenaAllocator<U>& other) : arena_{other.arena()} {}
+
+  T* allocate(size_t n) {
+    if (arena_) {
+      return static_cast<T*>(arena_->Allocate(n * sizeof(T), alignof(T)));
+    }
+    return std::allocator<T>{}.allocate(n);
+  }
+
+  void deallocate(T* p, size_t n) {
+    if (arena_) {
+      arena_->Deallocate();
+    } else {
+      std::allocator<T>{}.deallocate(p, n);
+    }
+  }
+
+  ArenaAllocator select_on_container_copy_construction() const {
+    return ArenaAllocator{};
+  }
+
+  ModuleArena* arena() const { return arena_; }
+
+ private:
+  ModuleArena* arena_;
+};
+
+template <typename T, typename U>
+bool operator==(const ArenaAllocator<T>& lhs, const ArenaAllocator<U>& rhs) {
+  return lhs.arena() == rhs.arena();
+}
+
+template <typename T, typename U>
+bool operator!=(const ArenaAllocator<T>& lhs, const ArenaAllocator<U>& rhs) {
+  return lhs.arena() != rhs.arena();
+}
+
+template <typename T>
+using ArenaVector = std::vector<T, ArenaAllocator<T>>;
+
+// For lists that usually have at most N elements; only larger ones allocate.
+// InlinedVector's copy constructor reuses the source's allocator, rather than
+// calling select_on_container_copy_construction, so it is done here instead.
+template <typename T, size_t N>
+class ArenaInlinedVector : public InlinedVector<T, N, ArenaAllocator<T>> {
+  using Base = InlinedVector<T, N, ArenaAllocator<T>>;
+
+ public:
+  using Base::Base;
+
+  ArenaInlinedVector() = default;
+  ArenaInlinedVector(const ArenaInlinedVector& other)
+      : Base(other, ArenaAllocator<T>{}) {}
+  ArenaInlinedVector(ArenaInlinedVector&&) = default;
+  ArenaInlinedVector& operator=(const ArenaInlinedVector&) = default;
+  ArenaInlinedVector& operator=(ArenaInlinedVector&&) = default;
+};
+
+}  // namespace wasp
+
+#endif  // WASP_BASE_MODULE_ARENA_H_
@@ -0,0 +1,87 @@
+//
+// Copyright 2020 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef WASP_BASE_THREAD_POOL_H_
+#define WASP_BASE_THREAD_POOL_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "wasp/base/span.h"
+#include "wasp/base/types.h"
+
+namespace wasp {
+
+// A fixed set of worker threads for running loops in parallel.
+//
+// ParallelFor splits the index range evenly between the workers up front; a
+// worker that runs out of indexes steals half of the remaining range of
+// another worker, so uneven item costs (e.g. function bodies of very
+// different sizes) still balance out.
+class ThreadPool {
+ public:
+  using Task = std::function<void(size_t index, int worker)>;
+
+  // The calling thread also acts as worker 0, so thread_count - 1 threads are
+  // started.
+  explicit ThreadPool(int thread_count);
+  ~ThreadPool();
+
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+
+  int thread_count() const { return thread_count_; }
+
+  // Calls task(index, worker) for each index in [0, count), and returns when
+  // all calls have finished. worker is in [0, thread_count()). The calls use
+  // the caller's LocationBase, so compact locations are relative to the same
+  // buffer on every worker.
+  void ParallelFor(size_t count, const Task& task);
+
+ private:
+  struct alignas(64) WorkRange {
+    // [begin, end) packed as (begin << 32) | end, so it can be updated with a
+    // single compare-and-swap.
+    std::atomic<u64> packed{0};
+  };
+
+  void ThreadMain(int worker);
+  void RunWorker(int worker);
+  bool PopLocal(int worker, size_t* index);
+  bool Steal(int worker, size_t* index);
+
+  int thread_count_;
+  std::vector<std::thread> threads_;
+  std::unique_ptr<WorkRange[]> ranges_;
+
+  std::mutex mutex_;
+  std::condition_variable start_cv_;
+  std::condition_variable done_cv_;
+  const Task* task_ = nullptr;
+  SpanU8 location_base_;
+  u64 generation_ = 0;
+  int running_ = 0;
+  bool stop_ = false;
+};
+
+}  // namespace wasp
+
+#endif  // WASP_BASE_THREAD_POOL_H_
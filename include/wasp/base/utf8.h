@@ -21,8 +21,14 @@
 
 namespace wasp {
 
+// Uses SIMD (SSE2 or AVX2 on x86, NEON on ARM64) to skip over ASCII chunks;
+// other chunks go through the same DFA as IsValidUtf8Scalar, so the results
+// are identical.
 bool IsValidUtf8(string_view);
 
+// Byte-at-a-time DFA.
+bool IsValidUtf8Scalar(string_view);
+
 }  // namespace wasp
 
 #endif  // WASP_BASE_UTF8_H_
@@ -0,0 +1,65 @@
+//
+// Copyright 2020 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef WASP_BINARY_CODE_SECTION_INDEX_H_
+#define WASP_BINARY_CODE_SECTION_INDEX_H_
+
+#include <vector>
+
+#include "wasp/base/at.h"
+#include "wasp/base/optional.h"
+#include "wasp/base/span.h"
+#include "wasp/base/types.h"
+#include "wasp/binary/types.h"
+
+namespace wasp::binary {
+
+struct Context;
+
+// Random access to the entries of a code section. Building the index only
+// reads each entry's size, so it is much cheaper than iterating a
+// LazyCodeSection; afterward any function can be read in O(1).
+//
+// Indexes are for defined functions only, i.e. they don't include imported
+// functions.
+class CodeSectionIndex {
+ public:
+  struct Entry {
+    u32 offset;  // Offset of the entry (including its size) in the section.
+    u32 size;
+  };
+
+  CodeSectionIndex() = default;
+  explicit CodeSectionIndex(SpanU8 section_data, std::vector<Entry>);
+
+  Index size() const { return static_cast<Index>(entries_.size()); }
+  bool empty() const { return entries_.empty(); }
+
+  // The bytes of the code entry, starting with its size.
+  auto GetEntryData(Index) const -> optional<SpanU8>;
+  auto GetCode(Index, Context&) const -> OptAt<Code>;
+
+ private:
+  SpanU8 section_data_;
+  std::vector<Entry> entries_;
+};
+
+auto ReadCodeSectionIndex(SpanU8, Context&) -> CodeSectionIndex;
+auto ReadCodeSectionIndex(KnownSection, Context&) -> CodeSectionIndex;
+
+}  // namespace wasp::binary
+
+#endif  // WASP_BINARY_CODE_SECTION_INDEX_H_
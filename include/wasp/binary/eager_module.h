@@ -0,0 +1,84 @@
+//
+// Copyright 2020 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef WASP_BINARY_EAGER_MODULE_H_
+#define WASP_BINARY_EAGER_MODULE_H_
+
+#include <memory>
+#include <vector>
+
+#include "wasp/base/features.h"
+#include "wasp/base/module_arena.h"
+#include "wasp/base/span.h"
+#include "wasp/binary/types.h"
+
+namespace wasp {
+
+class Errors;
+class ThreadPool;
+
+namespace binary {
+
+// Reads every known section of a module into a binary::Module, including
+// the instructions of each function body. Like a LazyModule, the result
+// refers to `data`, which must outlive it.
+//
+// The other sections are read in order on the calling thread. The function
+// bodies are read on `thread_pool` if it is non-null, largest first, into
+// their own slots of Module::codes. Each body's errors are buffered and then
+// reported in function order, so `errors` gets the same errors in the same
+// order with or without a thread pool.
+Module ReadModuleEager(SpanU8, const Features&, Errors&, ThreadPool* = nullptr);
+
+// A Module whose function bodies are allocated from arenas that it owns, so
+// dropping it releases them all at once instead of freeing each list. The
+// arenas are destroyed after `module`, and moving an ArenaModule keeps them,
+// so the module's lists are valid for as long as the ArenaModule is. Copies
+// of its lists are ordinary heap copies, but lists moved out of `module` keep
+// referring to the arenas and must not outlive them.
+class ArenaModule {
+  // Declared before `module`, so they are destroyed after it.
+  std::vector<std::unique_ptr<ModuleArena>> arenas_;
+
+ public:
+  ArenaModule() = default;
+  ArenaModule(ArenaModule&&) = default;
+  ArenaModule& operator=(ArenaModule&&);
+
+  // The total size of the arena allocations.
+  size_t bytes_allocated() const;
+
+  Module module;
+
+ private:
+  friend ArenaModule ReadArenaModuleEager(SpanU8,
+                                          const Features&,
+                                          Errors&,
+                                          ThreadPool*);
+};
+
+// Like ReadModuleEager, but the instructions, immediates and locals of each
+// function body are read into arenas owned by the result, one per thread.
+// The other sections are few and small, so they stay on the heap.
+ArenaModule ReadArenaModuleEager(SpanU8,
+                                 const Features&,
+                                 Errors&,
+                                 ThreadPool* = nullptr);
+
+}  // namespace binary
+}  // namespace wasp
+
+#endif  // WASP_BINARY_EAGER_MODULE_H_
@@ -0,0 +1,128 @@
+//
+// Copyright 2020 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "wasp/base/features.h"
+#include "wasp/base/optional.h"
+
+namespace wasp::binary::encoding {
+
+// static
+template <typename FeaturesT>
+bool Opcode::IsPrefixByte(u8 code, const FeaturesT& features) {
+  switch (code) {
+    case GcPrefix:
+      return features.gc_enabled();
+
+    case MiscPrefix:
+      return features.saturating_float_to_int_enabled() ||
+             features.bulk_memory_enabled() ||
+             features.reference_types_enabled();
+
+    case SimdPrefix:
+      return features.simd_enabled();
+
+    case ThreadsPrefix:
+      return features.threads_enabled();
+
+    default:
+      return false;
+  }
+}
+
+namespace internal {
+
+// The feature that enables an opcode, as a Features::*Index.
+enum class OpcodeFeature : u8 {
+#define WASP_V(enum_, variable, flag, default_) \
+  variable = Features::enum_##Index,
+#include "wasp/base/features.inc"
+#undef WASP_V
+  None = 0xfe,     // Always enabled.
+  Invalid = 0xff,  // Not an opcode.
+};
+
+struct OpcodeTableEntry {
+  ::wasp::Opcode opcode = {};
+  OpcodeFeature feature = OpcodeFeature::Invalid;
+
+  template <typename FeaturesT>
+  bool IsEnabled(const FeaturesT& features) const {
+    return feature == OpcodeFeature::None ||
+           (feature != OpcodeFeature::Invalid &&
+            (features.bits() >> static_cast<u8>(feature)) & 1);
+  }
+};
+
+// Dense decoding tables generated from opcode.inc, one for the single-byte
+// opcodes and one per prefix byte, indexed by code. All codes are currently
+// less than 256; a larger one would fail to build kOpcodeTables.
+struct OpcodeTables {
+  static constexpr u8 kFirstPrefix = Opcode::GcPrefix;
+  static constexpr u8 kLastPrefix = Opcode::ThreadsPrefix;
+  static constexpr u32 kCodeCount = 256;
+
+  constexpr OpcodeTables() {
+#define WASP_V(prefix, code, Name, str) \
+  single_byte[code] = {::wasp::Opcode::Name, OpcodeFeature::None};
+#define WASP_FEATURE_V(prefix, code, Name, str, feature) \
+  single_byte[code] = {::wasp::Opcode::Name, OpcodeFeature::feature};
+#define WASP_PREFIX_V(prefix, code, Name, str, feature) \
+  prefixed[prefix - kFirstPrefix][code] = {::wasp::Opcode::Name,   \
+                                           OpcodeFeature::feature};
+#include "wasp/base/inc/opcode.inc"
+#undef WASP_V
+#undef WASP_FEATURE_V
+#undef WASP_PREFIX_V
+  }
+
+  OpcodeTableEntry single_byte[kCodeCount] = {};
+  OpcodeTableEntry prefixed[kLastPrefix - kFirstPrefix + 1][kCodeCount] = {};
+};
+
+inline constexpr OpcodeTables kOpcodeTables;
+
+}  // namespace internal
+
+// static
+template <typename FeaturesT>
+optional<::wasp::Opcode> Opcode::Decode(u8 code, const FeaturesT& features) {
+  const auto& entry = internal::kOpcodeTables.single_byte[code];
+  if (!entry.IsEnabled(features)) {
+    return nullopt;
+  }
+  return entry.opcode;
+}
+
+// static
+template <typename FeaturesT>
+optional<::wasp::Opcode> Opcode::Decode(u8 prefix,
+                                        u32 code,
+                                        const FeaturesT& features) {
+  using internal::OpcodeTables;
+  if (prefix < OpcodeTables::kFirstPrefix ||
+      prefix > OpcodeTables::kLastPrefix || code >= OpcodeTables::kCodeCount) {
+    return nullopt;
+  }
+  const auto& entry =
+      internal::kOpcodeTables.prefixed[prefix - OpcodeTables::kFirstPrefix]
+                                      [code];
+  if (!entry.IsEnabled(features)) {
+    return nullopt;
+  }
+  return entry.opcode;
+}
+
+}  // namespace wasp::binary::encoding
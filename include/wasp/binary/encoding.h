@@ -113,6 +113,17 @@ struct Opcode {
   static EncodedOpcode Encode(::wasp::Opcode);
   static optional<::wasp::Opcode> Decode(u8 code, const Features&);
   static optional<::wasp::Opcode> Decode(u8 prefix, u32 code, const Features&);
+
+  // Same as above, but for any features type with the `*_enabled()` queries
+  // of Features, e.g. a StaticFeatures.
+  template <typename FeaturesT>
+  static bool IsPrefixByte(u8, const FeaturesT&);
+  template <typename FeaturesT>
+  static optional<::wasp::Opcode> Decode(u8 code, const FeaturesT&);
+  template <typename FeaturesT>
+  static optional<::wasp::Opcode> Decode(u8 prefix,
+                                         u32 code,
+                                         const FeaturesT&);
 };
 
 struct RefType {
@@ -190,4 +201,6 @@ struct ElemSegmentFlags {
 }  // namespace binary::encoding
 }  // namespace wasp
 
+#include "wasp/binary/encoding-inl.h"
+
 #endif // WASP_BINARY_ENCODING_H
@@ -0,0 +1,120 @@
+//
+// Copyright 2020 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef WASP_BINARY_FLAT_EXPRESSION_H_
+#define WASP_BINARY_FLAT_EXPRESSION_H_
+
+#include <cstring>
+#include <vector>
+
+#include "wasp/base/at.h"
+#include "wasp/base/span.h"
+#include "wasp/base/types.h"
+#include "wasp/binary/types.h"
+
+namespace wasp {
+
+class Features;
+
+}  // namespace wasp
+
+namespace wasp::binary {
+
+struct Context;
+
+// A fixed-size record for one instruction of a FlatExpression.
+//
+// `immediate` holds the instruction's immediate, if it fits in 64 bits:
+//
+//   s32, s64, f32, f64:         the value's bits; see the accessors below.
+//   Index, FuncBind, SimdLane:  the index (or lane).
+//   MemArg:                     align_log2 in the low half, offset in the high.
+//   CallIndirect:               index in the low half, table index in the high.
+//   Copy:                       dst index in the low half, src in the high.
+//   Init:                       segment index in the low half, dst in the high.
+//   BrOnExn:                    target in the low half, event index in the high.
+//   StructField:                struct index in the low half, field in the high.
+//   BrTable:                    see FlatExpression::GetBrTableTargets.
+//
+// For all other immediates (block types, heap types, v128, ...) it is 0; use
+// FlatExpression::ToInstruction to read them.
+struct FlatInstruction {
+  Opcode opcode;
+  u32 offset;  // Offset of the instruction in the expression.
+  u64 immediate;
+
+  s32 s32_immediate() const { return static_cast<s32>(immediate); }
+  s64 s64_immediate() const { return static_cast<s64>(immediate); }
+  f32 f32_immediate() const;
+  f64 f64_immediate() const;
+  Index index_immediate() const { return static_cast<Index>(immediate); }
+  u32 low_immediate() const { return static_cast<u32>(immediate); }
+  u32 high_immediate() const { return static_cast<u32>(immediate >> 32); }
+};
+
+static_assert(sizeof(FlatInstruction) == 16, "FlatInstruction is 16 bytes");
+
+// An expression decoded into a contiguous array of FlatInstructions, which is
+// much smaller (and faster to scan repeatedly) than a list of Instructions.
+// Decoded immediates that don't fit in a FlatInstruction are stored in side
+// buffers; the rest can be read again from `data`, which must outlive this.
+struct FlatExpression {
+  Index size() const { return static_cast<Index>(instructions.size()); }
+
+  // The bytes of the instruction at the given index.
+  SpanU8 GetInstructionData(Index) const;
+
+  // The targets of a br_table instruction, followed by its default target.
+  span<const Index> GetBrTableTargets(const FlatInstruction&) const;
+
+  // Reads the instruction at the given index again, with its immediates and
+  // locations.
+  OptAt<Instruction> ToInstruction(Index, Context&) const;
+
+  SpanU8 data;
+  std::vector<FlatInstruction> instructions;
+  std::vector<Index> br_table_targets;
+};
+
+// Decodes all instructions of an expression. Like iterating a LazyExpression,
+// decoding stops at the first error, which is reported to the context.
+FlatExpression ReadFlatExpression(SpanU8, Context&);
+FlatExpression ReadFlatExpression(Expression, Context&);
+
+using ReadFlatExpressionFunction = FlatExpression (*)(SpanU8, Context&);
+
+// Returns a ReadFlatExpression whose feature checks are resolved at compile
+// time, if one is built for `features` (currently the default features and
+// all features), or the runtime ReadFlatExpression otherwise. The returned
+// function must only be called with a context that has these features.
+ReadFlatExpressionFunction GetReadFlatExpression(const Features&);
+
+inline f32 FlatInstruction::f32_immediate() const {
+  u32 bits = static_cast<u32>(immediate);
+  f32 result;
+  memcpy(&result, &bits, sizeof(result));
+  return result;
+}
+
+inline f64 FlatInstruction::f64_immediate() const {
+  f64 result;
+  memcpy(&result, &immediate, sizeof(result));
+  return result;
+}
+
+}  // namespace wasp::binary
+
+#endif  // WASP_BINARY_FLAT_EXPRESSION_H_
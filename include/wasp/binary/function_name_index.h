@@ -0,0 +1,64 @@
+//
+// Copyright 2020 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef WASP_BINARY_FUNCTION_NAME_INDEX_H_
+#define WASP_BINARY_FUNCTION_NAME_INDEX_H_
+
+#include <vector>
+
+#include "wasp/base/hashmap.h"
+#include "wasp/base/optional.h"
+#include "wasp/base/string_view.h"
+#include "wasp/base/types.h"
+
+namespace wasp::binary {
+
+class LazyModule;
+
+// Maps function indexes to names and back, using the names given by a
+// module's imports, exports and "name" section.
+//
+// A function may have several names, and a name may be used by several
+// functions; in both cases the first one found wins, searching imports, then
+// exports, then the "name" section.
+class FunctionNameIndex {
+ public:
+  FunctionNameIndex() = default;
+
+  // Names for indexes less than `function_count` are stored densely; any
+  // others (which can only occur in malformed modules) are hashed.
+  explicit FunctionNameIndex(Index function_count);
+
+  auto GetName(Index) const -> optional<string_view>;
+  auto GetIndex(string_view name) const -> optional<Index>;
+
+  // The number of distinct names.
+  Index size() const { return static_cast<Index>(indexes_.size()); }
+  bool empty() const { return indexes_.empty(); }
+
+  void Insert(Index, string_view name);
+
+ private:
+  std::vector<optional<string_view>> names_;
+  flat_hash_map<Index, string_view> sparse_names_;
+  flat_hash_map<string_view, Index> indexes_;
+};
+
+auto ReadFunctionNameIndex(LazyModule&) -> FunctionNameIndex;
+
+}  // namespace wasp::binary
+
+#endif  // WASP_BINARY_FUNCTION_NAME_INDEX_H_
@@ -17,24 +17,64 @@
 #ifndef WASP_BINARY_LAZY_MODULE_H
 #define WASP_BINARY_LAZY_MODULE_H
 
+#include "wasp/base/compact_location.h"
 #include "wasp/base/features.h"
 #include "wasp/base/optional.h"
 #include "wasp/base/span.h"
+#include "wasp/binary/code_section_index.h"
+#include "wasp/binary/function_name_index.h"
 #include "wasp/binary/lazy_sequence.h"
+#include "wasp/binary/section_directory.h"
 #include "wasp/binary/sections.h"
 
 namespace wasp::binary {
 
 /// ---
 class LazyModule {
+  // Created before anything is read, so that compact locations in the module
+  // are relative to its data; see LocationBase.
+  LocationBase location_base_;
+
  public:
   explicit LazyModule(SpanU8, const Features&, Errors&);
 
+  // Built on first use, with one scan of the section headers. Errors in the
+  // section headers are not reported here; they are reported when iterating
+  // `sections`.
+  auto section_directory() -> const SectionDirectory&;
+
+  // Built on first use; empty if the module has no code section.
+  auto code_section_index() -> const CodeSectionIndex&;
+
+  // Built on first use, so the "name" section is only decoded if needed.
+  auto function_name_index() -> const FunctionNameIndex&;
+
+  // Read a section found with section_directory(), using `context`. Returns
+  // nullopt if the module has no such section.
+  auto type_section() -> optional<LazyTypeSection>;
+  auto import_section() -> optional<LazyImportSection>;
+  auto function_section() -> optional<LazyFunctionSection>;
+  auto table_section() -> optional<LazyTableSection>;
+  auto memory_section() -> optional<LazyMemorySection>;
+  auto global_section() -> optional<LazyGlobalSection>;
+  auto event_section() -> optional<LazyEventSection>;
+  auto export_section() -> optional<LazyExportSection>;
+  auto start_section() -> StartSection;
+  auto element_section() -> optional<LazyElementSection>;
+  auto data_count_section() -> DataCountSection;
+  auto code_section() -> optional<LazyCodeSection>;
+  auto data_section() -> optional<LazyDataSection>;
+
   SpanU8 data;
   Context context;
   optional<SpanU8> magic;
   optional<SpanU8> version;
   LazySequence<Section> sections;
+
+ private:
+  optional<SectionDirectory> section_directory_;
+  optional<CodeSectionIndex> code_section_index_;
+  optional<FunctionNameIndex> function_name_index_;
 };
 
 LazyModule ReadModule(SpanU8 data, const Features&, Errors&);
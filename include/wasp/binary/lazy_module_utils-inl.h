@@ -26,42 +26,33 @@ namespace wasp::binary {
 template <typename F>
 void ForEachFunctionName(LazyModule& module, F&& f) {
   ErrorsNop errors;
-  LazyModule copy{module.data, module.context.features, errors};
+  Context context{module.context.features, errors};
+  const auto& directory = module.section_directory();
 
-  Index imported_function_count = 0;
-  for (auto section : module.sections) {
-    if (section->is_known()) {
-      auto known = section->known();
-      switch (known->id) {
-        case SectionId::Import:
-          for (auto import : ReadImportSection(known, copy.context).sequence) {
-            if (import->kind() == ExternalKind::Function) {
-              f(IndexNamePair{imported_function_count++, import->name});
-            }
-          }
-          break;
-
-        case SectionId::Export:
-          for (auto export_ : ReadExportSection(known, copy.context).sequence) {
-            if (export_->kind == ExternalKind::Function) {
-              f(IndexNamePair{export_->index, export_->name});
-            }
-          }
-          break;
+  if (auto known = directory.GetKnownSection(SectionId::Import)) {
+    Index imported_function_count = 0;
+    for (auto import : ReadImportSection(*known, context).sequence) {
+      if (import->kind() == ExternalKind::Function) {
+        f(IndexNamePair{imported_function_count++, import->name});
+      }
+    }
+  }
 
-        default:
-          break;
+  if (auto known = directory.GetKnownSection(SectionId::Export)) {
+    for (auto export_ : ReadExportSection(*known, context).sequence) {
+      if (export_->kind == ExternalKind::Function) {
+        f(IndexNamePair{export_->index, export_->name});
       }
-    } else if (section->is_custom()) {
-      auto custom = section->custom();
-      if (*custom->name == "name") {
-        for (auto subsection : ReadNameSection(custom, copy.context)) {
-          if (subsection->id == NameSubsectionId::FunctionNames) {
-            for (auto name_assoc :
-                 ReadFunctionNamesSubsection(*subsection, copy.context)
-                     .sequence) {
-              f(IndexNamePair{name_assoc->index, name_assoc->name});
-            }
+    }
+  }
+
+  for (const auto& custom : directory.custom_sections()) {
+    if (custom.name == "name") {
+      for (auto subsection : ReadNameSection(custom.data, context)) {
+        if (subsection->id == NameSubsectionId::FunctionNames) {
+          for (auto name_assoc :
+               ReadFunctionNamesSubsection(*subsection, context).sequence) {
+            f(IndexNamePair{name_assoc->index, name_assoc->name});
           }
         }
       }
@@ -77,20 +68,17 @@ Iterator CopyFunctionNames(LazyModule& module, Iterator out) {
 }
 
 inline Index GetImportCount(LazyModule& module, ExternalKind kind) {
-  ErrorsNop errors;
-  LazyModule copy{module.data, module.context.features, errors};
+  auto known = module.section_directory().GetKnownSection(SectionId::Import);
+  if (!known) {
+    return 0;
+  }
 
+  ErrorsNop errors;
+  Context context{module.context.features, errors};
   Index count = 0;
-  for (auto section : copy.sections) {
-    if (section->is_known()) {
-      auto known = section->known();
-      if (known->id == SectionId::Import) {
-        for (auto import : ReadImportSection(known, copy.context).sequence) {
-          if (import->kind() == kind) {
-            count++;
-          }
-        }
-      }
+  for (auto import : ReadImportSection(*known, context).sequence) {
+    if (import->kind() == kind) {
+      count++;
     }
   }
   return count;
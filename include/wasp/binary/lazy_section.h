@@ -32,6 +32,10 @@ class LazySection {
  public:
   explicit LazySection(SpanU8, string_view name, Context&);
 
+  // A section whose items are read some other way, e.g. one at a time as they
+  // arrive. Only the count is available; the sequence is empty.
+  explicit LazySection(OptAt<Index> count, Context&);
+
   OptAt<Index> count;
   LazySequence<T> sequence;
 };
@@ -40,6 +44,10 @@ template <typename T>
 LazySection<T>::LazySection(SpanU8 data, string_view name, Context& context)
     : count{ReadCount(&data, context)}, sequence{data, count, name, context} {}
 
+template <typename T>
+LazySection<T>::LazySection(OptAt<Index> count, Context& context)
+    : count{count}, sequence{SpanU8{}, context} {}
+
 }  // namespace wasp::binary
 
 #endif // WASP_BINARY_LAZY_SECTION_H_
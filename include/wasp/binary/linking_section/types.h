@@ -21,6 +21,7 @@
 
 #include "wasp/base/absl_hash_value_macros.h"
 #include "wasp/base/at.h"
+#include "wasp/base/module_arena.h"
 #include "wasp/base/operator_eq_ne_macros.h"
 #include "wasp/base/optional.h"
 #include "wasp/base/span.h"
@@ -94,7 +95,7 @@ struct ComdatSymbol {
   At<Index> index;
 };
 
-using ComdatSymbols = std::vector<At<ComdatSymbol>>;
+using ComdatSymbols = ArenaVector<At<ComdatSymbol>>;
 
 struct Comdat {
   At<string_view> name;
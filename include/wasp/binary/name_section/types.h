@@ -21,6 +21,7 @@
 
 #include "wasp/base/absl_hash_value_macros.h"
 #include "wasp/base/at.h"
+#include "wasp/base/module_arena.h"
 #include "wasp/base/operator_eq_ne_macros.h"
 #include "wasp/base/span.h"
 #include "wasp/base/string_view.h"
@@ -44,7 +45,7 @@ struct NameAssoc {
   At<string_view> name;
 };
 
-using NameMap = std::vector<At<NameAssoc>>;
+using NameMap = ArenaVector<At<NameAssoc>>;
 
 struct IndirectNameAssoc {
   At<Index> index;
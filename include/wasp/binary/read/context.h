@@ -18,6 +18,7 @@
 #define WASP_BINARY_READ_CONTEXT_H_
 
 #include "wasp/base/features.h"
+#include "wasp/base/module_arena.h"
 #include "wasp/base/optional.h"
 #include "wasp/binary/types.h"
 
@@ -35,6 +36,9 @@ struct Context {
 
   Features features;
   Errors& errors;
+  // The arena that lists are read into, or nullptr for the heap. It must
+  // outlive the lists; see ReadArenaModuleEager.
+  ModuleArena* arena = nullptr;
 
   optional<SectionId> last_section_id;
   Index defined_function_count = 0;
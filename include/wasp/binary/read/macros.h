@@ -17,6 +17,8 @@
 #ifndef WASP_BINARY_MACROS_H_
 #define WASP_BINARY_MACROS_H_
 
+#include <utility>
+
 #include "wasp/base/concat.h"
 #include "wasp/base/errors.h"
 #include "wasp/base/errors_context_guard.h"
@@ -27,7 +29,7 @@
   if (!opt_##var) {              \
     return nullopt;              \
   }                              \
-  auto var = *opt_##var /* No semicolon. */
+  auto var = std::move(*opt_##var) /* No semicolon. */
 
 #define WASP_TRY_READ_CONTEXT(var, call, desc)         \
   ErrorsContextGuard guard_##var(context.errors, *data, desc); \
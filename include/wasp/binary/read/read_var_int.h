@@ -17,9 +17,14 @@
 #ifndef WASP_BINARY_READ_READ_VAR_INT_H_
 #define WASP_BINARY_READ_READ_VAR_INT_H_
 
+#include <algorithm>
 #include <type_traits>
 #include <iomanip>
 
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
 #include "wasp/base/concat.h"
 #include "wasp/base/errors_context_guard.h"
 #include "wasp/base/features.h"
@@ -44,8 +49,10 @@ S SignExtend(std::make_unsigned_t<S> x, int N) {
   return static_cast<S>(x << (kNumBits - N - 1)) >> (kNumBits - N - 1);
 }
 
+// The byte-at-a-time decoder. Every byte is read through Read<u8>, so
+// truncated and over-long values produce precise errors.
 template <typename T>
-OptAt<T> ReadVarInt(SpanU8* data, Context& context, string_view desc) {
+OptAt<T> ReadVarIntSlow(SpanU8* data, Context& context, string_view desc) {
   using U = std::make_unsigned_t<T>;
   constexpr bool is_signed = std::is_signed_v<T>;
   constexpr int kByteMask = VarInt<T>::kByteMask;
@@ -93,6 +100,104 @@ OptAt<T> ReadVarInt(SpanU8* data, Context& context, string_view desc) {
   }
 }
 
+inline int CountTrailingZeros(u64 x) {
+#if defined(_MSC_VER)
+  unsigned long index;
+  _BitScanForward64(&index, x);
+  return static_cast<int>(index);
+#else
+  return __builtin_ctzll(x);
+#endif
+}
+
+// Decodes a LEB128 value from the front of |data| using word-sized
+// arithmetic instead of per-byte reads. Returns the number of bytes used, or
+// 0 if the value can't be decoded this way: it is truncated, has an invalid
+// last byte, or is longer than 8 bytes. The caller then uses ReadVarIntSlow,
+// which reports the same errors it always has.
+template <typename T>
+int DecodeVarIntFast(SpanU8 data, T* out) {
+  using U = std::make_unsigned_t<T>;
+  constexpr bool is_signed = std::is_signed_v<T>;
+  constexpr int kMaxBytes = VarInt<T>::kMaxBytes;
+  constexpr int kMaxFastBytes = std::min(kMaxBytes, 8);
+  constexpr u64 kExtendBits = 0x8080808080808080ull;
+
+  const u8* p = data.data();
+  int length;
+  u64 word;
+  if (data.size() >= 8) {
+    // Compilers fold this into a single little-endian load.
+    word = u64(p[0]) | u64(p[1]) << 8 | u64(p[2]) << 16 | u64(p[3]) << 24 |
+           u64(p[4]) << 32 | u64(p[5]) << 40 | u64(p[6]) << 48 |
+           u64(p[7]) << 56;
+    u64 stop_bits = ~word & kExtendBits;
+    if (stop_bits == 0) {
+      return 0;
+    }
+    length = CountTrailingZeros(stop_bits) / 8 + 1;
+  } else {
+    word = 0;
+    length = 0;
+    for (size_t i = 0; i < data.size(); ++i) {
+      word |= u64(p[i]) << (i * 8);
+      if ((p[i] & VarInt<T>::kExtendBit) == 0) {
+        length = static_cast<int>(i) + 1;
+        break;
+      }
+    }
+    if (length == 0) {
+      return 0;
+    }
+  }
+
+  if (length > kMaxFastBytes) {
+    return 0;
+  }
+
+  if (length == kMaxBytes) {
+    // Same check as ReadVarIntSlow: the unused bits of the last byte must be
+    // a zero (or sign) extension.
+    constexpr int kLastByteMaskBits =
+        VarInt<T>::kUsedBitsInLastByte - (is_signed ? 1 : 0);
+    constexpr u8 kLastByteMask = ~((1 << kLastByteMaskBits) - 1);
+    constexpr u8 kLastByteOnes = kLastByteMask & VarInt<T>::kByteMask;
+    const u8 last = p[length - 1];
+    if (!((last & kLastByteMask) == 0 ||
+          (is_signed && (last & kLastByteMask) == kLastByteOnes))) {
+      return 0;
+    }
+  }
+
+  // Drop the bytes past the end of the value and the extend bits, then pack
+  // the 7-bit groups together: 8x7 -> 4x14 -> 2x28 -> 1x56.
+  if (length < 8) {
+    word &= (u64{1} << (length * 8)) - 1;
+  }
+  word &= 0x7f7f7f7f7f7f7f7full;
+  word = (word & 0x007f007f007f007full) | ((word & 0x7f007f007f007f00ull) >> 1);
+  word = (word & 0x00003fff00003fffull) | ((word & 0x3fff00003fff0000ull) >> 2);
+  word = (word & 0x000000000fffffffull) | ((word & 0x0fffffff00000000ull) >> 4);
+
+  if (is_signed && length < kMaxBytes) {
+    *out = SignExtend<T>(static_cast<U>(word), length * 7 - 1);
+  } else {
+    *out = static_cast<T>(static_cast<U>(word));
+  }
+  return length;
+}
+
+template <typename T>
+OptAt<T> ReadVarInt(SpanU8* data, Context& context, string_view desc) {
+  T value;
+  if (int length = DecodeVarIntFast(*data, &value)) {
+    Location loc = data->first(length);
+    data->remove_prefix(length);
+    return At{loc, value};
+  }
+  return ReadVarIntSlow<T>(data, context, desc);
+}
+
 }  // namespace wasp::binary
 
 #endif  // WASP_BINARY_READ_READ_VAR_INT_H_
@@ -17,9 +17,8 @@
 #ifndef WASP_BINARY_READ_READ_VECTOR_H_
 #define WASP_BINARY_READ_READ_VECTOR_H_
 
-#include <vector>
-
 #include "wasp/base/errors_context_guard.h"
+#include "wasp/base/module_arena.h"
 #include "wasp/base/optional.h"
 #include "wasp/base/span.h"
 #include "wasp/base/string_view.h"
@@ -30,12 +29,12 @@
 
 namespace wasp::binary {
 
-template <typename T>
-optional<std::vector<At<T>>> ReadVector(SpanU8* data,
-                                        Context& context,
-                                        string_view desc) {
+// Reads a vector of T into a `List`, which is an ArenaVector by default. The
+// list is allocated from the context's arena, if it has one.
+template <typename T, typename List = ArenaVector<At<T>>>
+optional<List> ReadVector(SpanU8* data, Context& context, string_view desc) {
   ErrorsContextGuard guard{context.errors, *data, desc};
-  std::vector<At<T>> result;
+  List result{typename List::allocator_type{context.arena}};
   WASP_TRY_READ(len, ReadCount(data, context));
   result.reserve(len);
   for (u32 i = 0; i < len; ++i) {
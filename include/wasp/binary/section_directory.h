@@ -0,0 +1,88 @@
+//
+// Copyright 2020 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef WASP_BINARY_SECTION_DIRECTORY_H_
+#define WASP_BINARY_SECTION_DIRECTORY_H_
+
+#include <array>
+#include <vector>
+
+#include "wasp/base/optional.h"
+#include "wasp/base/span.h"
+#include "wasp/base/string_view.h"
+#include "wasp/base/types.h"
+#include "wasp/binary/types.h"
+
+namespace wasp::binary {
+
+struct Context;
+
+// Where each section of a module lives, found with a single scan of the
+// section headers. Looking up a section afterward doesn't read the module
+// again.
+//
+// If a known section occurs more than once (which is malformed), only the
+// first one is recorded.
+class SectionDirectory {
+ public:
+  struct Entry {
+    SpanU8 data;            // The section contents, after the id and length.
+    optional<Index> count;  // The item count, for vector sections.
+  };
+
+  struct CustomEntry {
+    string_view name;
+    SpanU8 data;  // The section contents, after the name.
+  };
+
+  SectionDirectory() = default;
+
+  auto Find(SectionId) const -> optional<Entry>;
+  auto GetKnownSection(SectionId) const -> optional<KnownSection>;
+  auto GetCount(SectionId) const -> optional<Index>;
+
+  // Returns the first custom section with the given name.
+  auto FindCustom(string_view name) const -> optional<CustomEntry>;
+  auto GetCustomSection(string_view name) const -> optional<CustomSection>;
+
+  // All custom sections, in the order they occur in the module.
+  auto custom_sections() const -> const std::vector<CustomEntry>& {
+    return custom_sections_;
+  }
+
+  void Add(SectionId, Entry);
+  void AddCustom(CustomEntry);
+
+ private:
+  static constexpr size_t kSectionIdCount = 0
+#define WASP_V(...) +1
+#define WASP_FEATURE_V(...) +1
+#include "wasp/binary/inc/section_id.inc"
+#undef WASP_V
+#undef WASP_FEATURE_V
+      ;
+
+  std::array<optional<Entry>, kSectionIdCount> known_sections_;
+  std::vector<CustomEntry> custom_sections_;
+};
+
+// Reads the section headers in `data`, which starts after the module's magic
+// and version.
+auto ReadSectionDirectory(SpanU8, Context&) -> SectionDirectory;
+
+}  // namespace wasp::binary
+
+#endif  // WASP_BINARY_SECTION_DIRECTORY_H_
@@ -0,0 +1,313 @@
+//
+// Copyright 2020 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include <algorithm>
+
+#include "wasp/binary/encoding.h"
+#include "wasp/binary/read.h"
+#include "wasp/binary/read/context.h"
+#include "wasp/binary/sections.h"
+
+namespace wasp::binary {
+
+template <typename Visitor>
+StreamingModuleReader<Visitor>::StreamingModuleReader(
+    Visitor& visitor,
+    const Features& features,
+    StreamingErrors& errors)
+    : StreamingModuleReaderBase{features, errors}, visitor_{visitor} {}
+
+template <typename Visitor>
+auto StreamingModuleReader<Visitor>::Push(SpanU8 input) -> visit::Result {
+  while (!input.empty()) {
+    switch (state_) {
+      case State::Stopped:
+        return visit::Result::Ok;
+
+      case State::Skipped:
+        return visit::Result::Skip;
+
+      case State::Failed:
+        return visit::Result::Fail;
+
+      default:
+        if (Step(&input) == visit::Result::Fail) {
+          state_ = State::Failed;
+          return visit::Result::Fail;
+        }
+        break;
+    }
+  }
+  return state_ == State::Failed ? visit::Result::Fail : visit::Result::Ok;
+}
+
+template <typename Visitor>
+auto StreamingModuleReader<Visitor>::Finish() -> visit::Result {
+  switch (state_) {
+    case State::Header:
+      // Let the module report what is missing.
+      StartModule(buffer_);
+      ClearItem();
+      state_ = State::Failed;
+      return visit::Result::Fail;
+
+    case State::SectionHeader:
+      if (!buffer_.empty()) {
+        SpanU8 data = buffer_;
+        Read<Section>(&data, module_->context);
+      }
+      break;
+
+    case State::CodeCount: {
+      SpanU8 data = buffer_;
+      ReadIndex(&data, module_->context, "count");
+      break;
+    }
+
+    case State::Code: {
+      SpanU8 data = buffer_;
+      Read<Code>(&data, module_->context);
+      if (EndCodeSection() == visit::Result::Fail) {
+        state_ = State::Failed;
+        return visit::Result::Fail;
+      }
+      break;
+    }
+
+    case State::SkipSection: {
+      SpanU8 data;
+      ReadBytes(&data, section_remaining_, module_->context);
+      break;
+    }
+
+    case State::Stopped:
+      break;
+
+    case State::Skipped:
+      return visit::Result::Skip;
+
+    case State::Failed:
+      return visit::Result::Fail;
+  }
+
+  ClearItem();
+  state_ = State::Stopped;
+  EndModule(SpanU8{}, module_->context);
+  return visitor_.EndModule(*module_);
+}
+
+template <typename Visitor>
+auto StreamingModuleReader<Visitor>::Step(SpanU8* input) -> visit::Result {
+  switch (state_) {
+    case State::Header:
+      return OnHeader(input);
+
+    case State::SectionHeader:
+      return OnSectionHeader(input);
+
+    case State::CodeCount:
+      return OnCodeCount(input);
+
+    case State::Code:
+      return OnCode(input);
+
+    case State::SkipSection:
+      DropInput(input);
+      return visit::Result::Ok;
+
+    default:
+      return visit::Result::Ok;
+  }
+}
+
+template <typename Visitor>
+auto StreamingModuleReader<Visitor>::OnHeader(SpanU8* input) -> visit::Result {
+  auto item = TakeItem(input, header_.size());
+  if (!item) {
+    return visit::Result::Ok;
+  }
+  StartModule(*item);
+  ClearItem();
+
+  auto result = visitor_.BeginModule(*module_);
+  if (result == visit::Result::Skip) {
+    state_ = State::Skipped;
+  } else {
+    state_ = State::SectionHeader;
+  }
+  return result;
+}
+
+template <typename Visitor>
+auto StreamingModuleReader<Visitor>::OnSectionHeader(SpanU8* input)
+    -> visit::Result {
+  // The section id, followed by its length.
+  auto length = PeekVarU32(*input, 1, 5);
+  if (!length) {
+    BufferInput(input);
+    return visit::Result::Ok;
+  }
+
+  size_t header_size = 1 + length->length;
+  if (length->ok && PeekByte(*input, 0) ==
+                        encoding::SectionId::Encode(SectionId::Code)) {
+    // Don't wait for the whole code section; visit each entry as it arrives.
+    TakeItem(input, header_size);
+    code_section_offset_ = item_offset_;
+    ClearItem();
+    section_remaining_ = length->value;
+    return BeginCodeSection();
+  }
+
+  size_t size = length->ok ? header_size + length->value : header_size;
+  auto item = TakeItem(input, size);
+  if (!item) {
+    return visit::Result::Ok;
+  }
+
+  SpanU8 data = *item;
+  auto section = Read<Section>(&data, module_->context);
+  auto result = visit::Result::Ok;
+  if (section) {
+    result = visit::VisitSection(*module_, *section, visitor_);
+  } else {
+    // visit::Visit stops at the first malformed section.
+    state_ = State::Stopped;
+  }
+  ClearItem();
+  return result;
+}
+
+template <typename Visitor>
+auto StreamingModuleReader<Visitor>::BeginCodeSection() -> visit::Result {
+  // Read an empty code section, so the section id is checked (e.g. for
+  // ordering) the same way as other sections.
+  auto section = ReadEmptyCodeSection();
+  auto result = visitor_.OnSection(*section);
+  if (result == visit::Result::Fail) {
+    return visit::Result::Fail;
+  } else if (result == visit::Result::Skip) {
+    SkipRestOfSection();
+    return visit::Result::Ok;
+  }
+  state_ = State::CodeCount;
+  return visit::Result::Ok;
+}
+
+template <typename Visitor>
+auto StreamingModuleReader<Visitor>::OnCodeCount(SpanU8* input)
+    -> visit::Result {
+  auto count_length = PeekVarU32(
+      *input, 0, static_cast<size_t>(std::min<u64>(5, section_remaining_)));
+  if (!count_length) {
+    BufferInput(input);
+    return visit::Result::Ok;
+  }
+
+  auto item = TakeItem(input, count_length->length);
+  SpanU8 data = *item;
+  code_count_ = ReadIndex(&data, module_->context, "count");
+  SpanU8 section_end{item->end(), 0};
+  ClearItem();
+  if (!code_count_) {
+    state_ = State::Stopped;
+    return visit::Result::Ok;
+  }
+  section_remaining_ -= count_length->length;
+  codes_read_ = 0;
+
+  LazyCodeSection sec{code_count_, module_->context};
+  switch (visitor_.BeginCodeSection(sec)) {
+    case visit::Result::Fail:
+      return visit::Result::Fail;
+
+    case visit::Result::Skip:
+      module_->context.code_count += code_count_->value();
+      SkipRestOfSection();
+      return visit::Result::Ok;
+
+    case visit::Result::Ok:
+      break;
+  }
+
+  state_ = State::Code;
+  if (section_remaining_ == 0) {
+    CheckCodeCount(section_end);
+    return EndCodeSection();
+  }
+  return visit::Result::Ok;
+}
+
+template <typename Visitor>
+auto StreamingModuleReader<Visitor>::OnCode(SpanU8* input) -> visit::Result {
+  // The code entry's length, followed by its contents.
+  auto length = PeekVarU32(
+      *input, 0, static_cast<size_t>(std::min<u64>(5, section_remaining_)));
+  if (!length) {
+    BufferInput(input);
+    return visit::Result::Ok;
+  }
+
+  u64 size = length->ok ? std::min(length->length + length->value,
+                                   section_remaining_)
+                        : length->length;
+  auto item = TakeItem(input, static_cast<size_t>(size));
+  if (!item) {
+    return visit::Result::Ok;
+  }
+  section_remaining_ -= size;
+
+  SpanU8 data = visitor_.DefersCode() ? KeepCode(*item) : *item;
+  auto code = Read<Code>(&data, module_->context);
+  auto result = visit::Result::Ok;
+  if (code) {
+    codes_read_++;
+    result = visit::VisitCode(*module_, *code, visitor_);
+    if (visitor_.DefersCode()) {
+      ReleaseKeptCode(visitor_.DeferredCodeCount());
+    }
+  }
+  if (code && result != visit::Result::Fail && section_remaining_ == 0) {
+    CheckCodeCount(SpanU8{item->end(), 0});
+  }
+  ClearItem();
+  if (result == visit::Result::Fail) {
+    return visit::Result::Fail;
+  }
+
+  if (!code) {
+    // Like LazySequence, stop reading the section at the first error.
+    result = EndCodeSection();
+    if (result != visit::Result::Fail) {
+      SkipRestOfSection();
+    }
+    return result;
+  } else if (section_remaining_ == 0) {
+    return EndCodeSection();
+  }
+  return visit::Result::Ok;
+}
+
+template <typename Visitor>
+auto StreamingModuleReader<Visitor>::EndCodeSection() -> visit::Result {
+  state_ = State::SectionHeader;
+  LazyCodeSection sec{code_count_, module_->context};
+  auto result = visitor_.EndCodeSection(sec);
+  ReleaseKeptCode(0);
+  return result;
+}
+
+}  // namespace wasp::binary
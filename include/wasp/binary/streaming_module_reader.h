@@ -0,0 +1,212 @@
+//
+// Copyright 2020 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef WASP_BINARY_STREAMING_MODULE_READER_H_
+#define WASP_BINARY_STREAMING_MODULE_READER_H_
+
+#include <array>
+#include <deque>
+#include <map>
+#include <utility>
+#include <vector>
+
+#include "wasp/base/buffer.h"
+#include "wasp/base/errors.h"
+#include "wasp/base/features.h"
+#include "wasp/base/optional.h"
+#include "wasp/base/span.h"
+#include "wasp/base/types.h"
+#include "wasp/binary/lazy_module.h"
+#include "wasp/binary/visitor.h"
+
+namespace wasp::binary {
+
+class StreamingModuleReaderBase;
+
+// The errors of a StreamingModuleReader and its visitor. The reader reuses
+// its buffers as more input arrives, so each location into them is rebased
+// onto a copy of the located bytes, which is kept for the lifetime of this
+// object, before the error is forwarded to `errors`. module_offset() returns
+// where a forwarded location is in the module.
+class StreamingErrors : public Errors {
+ public:
+  explicit StreamingErrors(Errors& errors);
+
+  StreamingErrors(const StreamingErrors&) = delete;
+  StreamingErrors& operator=(const StreamingErrors&) = delete;
+
+  // The offset from the start of the module of a location that was forwarded
+  // by this object, or nullopt if it isn't one.
+  auto module_offset(Location) const -> optional<size_t>;
+
+ protected:
+  void HandleOnError(Location loc, string_view message) override;
+
+ private:
+  friend class StreamingModuleReaderBase;
+
+  auto Rebase(Location) -> Location;
+
+  Errors& errors_;
+  const StreamingModuleReaderBase* reader_ = nullptr;
+  // The copies of located bytes, by module offset and size.
+  std::map<std::pair<size_t, size_t>, Buffer> copies_;
+};
+
+// The parts of StreamingModuleReader that don't depend on the visitor.
+class StreamingModuleReaderBase {
+ public:
+  ~StreamingModuleReaderBase();
+
+  StreamingModuleReaderBase(const StreamingModuleReaderBase&) = delete;
+  StreamingModuleReaderBase& operator=(const StreamingModuleReaderBase&) =
+      delete;
+
+ protected:
+  enum class State {
+    Header,         // Waiting for the magic and version.
+    SectionHeader,  // Waiting for the next section.
+    CodeCount,      // Waiting for the code section's count.
+    Code,           // Waiting for the next code entry.
+    SkipSection,    // Dropping the rest of a section.
+    Stopped,        // Dropping the rest of the module.
+    Skipped,        // The visitor skipped the module.
+    Failed,         // The visitor failed.
+  };
+
+  struct VarU32 {
+    size_t length;
+    u64 value;
+    bool ok;  // False if the encoding is too long.
+  };
+
+  explicit StreamingModuleReaderBase(const Features&, StreamingErrors&);
+
+  // The byte `offset` bytes into the item being received, i.e. the buffered
+  // bytes followed by `input`. The byte must be available.
+  u8 PeekByte(SpanU8 input, size_t offset) const;
+
+  // Decodes a LEB128 at `offset` bytes into the item being received, without
+  // consuming it. Returns nullopt if more input is needed.
+  auto PeekVarU32(SpanU8 input, size_t offset, size_t max_length) const
+      -> optional<VarU32>;
+
+  // Returns the next `size` bytes of the item being received, or nullopt if
+  // more input is needed. Only items that span multiple chunks are copied.
+  // Call ClearItem() when finished with the item.
+  auto TakeItem(SpanU8* input, size_t size) -> optional<SpanU8>;
+  void BufferInput(SpanU8* input);
+  void ClearItem();
+
+  // Copies a code entry so it stays valid after the visitor's BeginCode, for
+  // visitors that defer code. ReleaseKeptCode() drops all but the last
+  // `count` kept entries.
+  auto KeepCode(SpanU8 item) -> SpanU8;
+  void ReleaseKeptCode(size_t count);
+
+  void StartModule(SpanU8 header);
+  auto ReadEmptyCodeSection() -> OptAt<Section>;
+  void SkipRestOfSection();
+  void DropInput(SpanU8* input);
+  // Reports a count mismatch at `section_end`, the empty span after the last
+  // byte of the code section, like LazySequence.
+  void CheckCodeCount(SpanU8 section_end);
+
+  Features features_;
+  StreamingErrors& errors_;
+  State state_ = State::Header;
+  std::array<u8, 8> header_;
+  std::vector<u8> buffer_;
+  optional<LazyModule> module_;
+
+  // The number of bytes consumed from the pushed input so far; the buffered
+  // bytes are the last buffer_.size() of them.
+  u64 consumed_ = 0;
+  // The item returned by TakeItem(), until ClearItem().
+  SpanU8 item_;
+  u64 item_offset_ = 0;
+  // The code entries that the visitor still keeps, oldest first.
+  struct KeptCode {
+    Buffer data;
+    u64 module_offset;
+  };
+  std::deque<KeptCode> kept_code_;
+  // The code section header is read from ReadEmptyCodeSection()'s bytes, so
+  // locations in them are mapped to the header in the input.
+  u64 code_section_offset_ = 0;
+
+  // The number of bytes left in the current code (or skipped) section.
+  u64 section_remaining_ = 0;
+  OptAt<Index> code_count_;
+  Index codes_read_ = 0;
+
+ private:
+  friend class StreamingErrors;
+
+  // The module offset of `loc`, if it is in one of the reader's buffers or
+  // the input item being read.
+  auto ModuleOffset(Location loc) const -> optional<u64>;
+};
+
+// Reads a module that arrives in chunks, e.g. from a pipe, calling the same
+// visitor functions as visit::Visit. Each section other than the code section
+// is buffered until all of its bytes have arrived, then visited. The code
+// section is visited one code entry at a time, and only an entry that is
+// partially received is buffered.
+//
+// There are a few differences from visit::Visit:
+//
+// * The spans passed to the visitor are only valid during the call, so the
+//   visitor must not keep them. The exception is a visitor whose
+//   DefersCode() returns true (e.g. ValidateVisitor with a thread pool): each
+//   code entry is then copied, and the copy is kept until the visitor
+//   releases the code (see visit::Visitor::DeferredCodeCount), or until
+//   EndCodeSection returns.
+// * The LazyModule passed to BeginModule and EndModule only contains the
+//   magic and version.
+// * The code section is passed to OnSection and BeginCodeSection before its
+//   contents have arrived, so its data and sequence are empty.
+// * Errors are reported through a StreamingErrors, which should also be
+//   given to the visitor. Their locations point into copies of the located
+//   bytes rather than into the module data; see StreamingErrors.
+template <typename Visitor>
+class StreamingModuleReader : private StreamingModuleReaderBase {
+ public:
+  explicit StreamingModuleReader(Visitor&, const Features&, StreamingErrors&);
+
+  auto Push(SpanU8) -> visit::Result;
+
+  // Call when all the data has been pushed. Reports an error if the module
+  // is incomplete.
+  auto Finish() -> visit::Result;
+
+ private:
+  auto Step(SpanU8* input) -> visit::Result;
+  auto OnHeader(SpanU8* input) -> visit::Result;
+  auto OnSectionHeader(SpanU8* input) -> visit::Result;
+  auto OnCodeCount(SpanU8* input) -> visit::Result;
+  auto OnCode(SpanU8* input) -> visit::Result;
+  auto BeginCodeSection() -> visit::Result;
+  auto EndCodeSection() -> visit::Result;
+
+  Visitor& visitor_;
+};
+
+}  // namespace wasp::binary
+
+#include "wasp/binary/streaming_module_reader-inl.h"
+
+#endif  // WASP_BINARY_STREAMING_MODULE_READER_H_
@@ -23,6 +23,7 @@
 
 #include "wasp/base/absl_hash_value_macros.h"
 #include "wasp/base/at.h"
+#include "wasp/base/module_arena.h"
 #include "wasp/base/operator_eq_ne_macros.h"
 #include "wasp/base/optional.h"
 #include "wasp/base/span.h"
@@ -115,7 +116,10 @@ struct ValueType {
   variant<At<NumericType>, At<ReferenceType>, At<Rtt>> type;
 };
 
-using ValueTypeList = std::vector<At<ValueType>>;
+// Most function signatures, and every select type list, have at most one
+// param or result. At<ValueType> is large, so more inline elements would
+// make every Instruction larger too (via SelectImmediate).
+using ValueTypeList = ArenaInlinedVector<At<ValueType>, 1>;
 
 struct VoidType {};
 struct BlockType {
@@ -159,7 +163,7 @@ enum class SectionId : u32 {
 #undef WASP_FEATURE_V
 };
 
-using IndexList = std::vector<At<Index>>;
+using IndexList = ArenaVector<At<Index>>;
 
 // Section
 
@@ -213,8 +217,11 @@ struct BrOnExnImmediate {
   At<Index> event_index;
 };
 
+// Most br_table instructions have only a few targets.
+using BrTableTargetList = ArenaInlinedVector<At<Index>, 4>;
+
 struct BrTableImmediate {
-  IndexList targets;
+  BrTableTargetList targets;
   At<Index> default_target;
 };
 
@@ -242,7 +249,7 @@ struct Locals {
   At<ValueType> type;
 };
 
-using LocalsList = std::vector<At<Locals>>;
+using LocalsList = ArenaVector<At<Locals>>;
 
 struct LetImmediate {
   At<BlockType> block_type;
@@ -432,7 +439,7 @@ struct Instruction {
       immediate;
 };
 
-using InstructionList = std::vector<At<Instruction>>;
+using InstructionList = ArenaVector<At<Instruction>>;
 
 // Section 1: Type
 
@@ -446,7 +453,7 @@ struct FieldType {
   At<Mutability> mut;
 };
 
-using FieldTypeList = std::vector<At<FieldType>>;
+using FieldTypeList = ArenaVector<At<FieldType>>;
 
 struct StructType {
   FieldTypeList fields;
@@ -596,7 +603,7 @@ struct ElementExpression {
   InstructionList instructions;
 };
 
-using ElementExpressionList = std::vector<At<ElementExpression>>;
+using ElementExpressionList = ArenaVector<At<ElementExpression>>;
 
 struct ElementListWithExpressions {
   At<ReferenceType> elemtype;
@@ -762,6 +769,7 @@ struct Module {
   WASP_V(binary::VoidType, 0)
 
 #define WASP_BINARY_CONTAINERS(WASP_V)  \
+  WASP_V(binary::BrTableTargetList)     \
   WASP_V(binary::FieldTypeList)         \
   WASP_V(binary::IndexList)             \
   WASP_V(binary::InstructionList)       \
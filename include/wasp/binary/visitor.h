@@ -26,6 +26,13 @@ namespace wasp::binary::visit {
 enum class Result { Ok, Fail, Skip };
 
 struct Visitor {
+  // Whether the visitor keeps the code passed to BeginCode after the call,
+  // rather than only using it during the call. Such a visitor releases the
+  // codes in the order they were passed; DeferredCodeCount() is how many of
+  // the most recent ones it still keeps. All are released by EndCodeSection.
+  bool DefersCode() const { return false; }
+  size_t DeferredCodeCount() const { return 0; }
+
   Result BeginModule(const LazyModule&) { return Result::Ok; }
   Result EndModule(const LazyModule&) { return Result::Ok; }
 
@@ -123,6 +130,14 @@ struct SkipVisitor : Visitor {
 template <typename Visitor>
 Result Visit(LazyModule&, Visitor&);
 
+// Visit one section, or one code entry, of a module. Visit() calls these for
+// each item in turn; they can also be used by readers that find the sections
+// some other way, e.g. StreamingModuleReader.
+template <typename Visitor>
+Result VisitSection(LazyModule&, const At<Section>&, Visitor&);
+template <typename Visitor>
+Result VisitCode(LazyModule&, const At<Code>&, Visitor&);
+
 #define WASP_CHECK(x)      \
   if (x == Result::Fail) { \
     return Result::Fail;   \
@@ -186,66 +201,80 @@ inline Result Visit(LazyModule& module, Visitor& visitor) {
   }
 
   for (auto section : module.sections) {
-    auto res = visitor.OnSection(section);
-    if (res == Result::Skip) {
-      continue;
-    } else if (res == Result::Fail) {
-      return Result::Fail;
-    }
+    WASP_CHECK(VisitSection(module, section, visitor));
+  }
+  EndModule(module.data, module.context);
+  return visitor.EndModule(module);
+}
+
+template <typename Visitor>
+inline Result VisitSection(LazyModule& module,
+                           const At<Section>& section,
+                           Visitor& visitor) {
+  auto res = visitor.OnSection(section);
+  if (res == Result::Skip) {
+    return Result::Ok;
+  } else if (res == Result::Fail) {
+    return Result::Fail;
+  }
 
-    if (section->is_known()) {
-      const auto& known = section->known();
-      switch (known->id) {
-        WASP_SECTION(Type)
-        WASP_SECTION(Import)
-        WASP_SECTION_ELSE_SKIP(Function, {
-          module.context.defined_function_count += sec.count->value();
-        })
-        WASP_SECTION(Table)
-        WASP_SECTION(Memory)
-        WASP_SECTION(Global)
-        WASP_SECTION(Event)
-        WASP_SECTION(Export)
-        WASP_OPT_SECTION(Start)
-        WASP_SECTION(Element)
-        WASP_OPT_SECTION(DataCount)
-
-        case SectionId::Code: {
-          auto sec = ReadCodeSection(known, module.context);
-          WASP_IF_OK_ELSE_SKIP(
-              visitor.BeginCodeSection(sec),
-              {
-                for (const auto& code : sec.sequence) {
-                  WASP_IF_OK(
-                      visitor.BeginCode(*code), {
-                        for (auto&& instr :
-                             ReadExpression(*code->body, module.context)) {
-                          WASP_CHECK(visitor.OnInstruction(instr));
-                        }
-                        EndCode(code->body->data.last(0), module.context);
-                        WASP_CHECK(visitor.EndCode(*code));
-                      })
-                }
-                WASP_CHECK(visitor.EndCodeSection(sec));
-              },
-              // If skipping this section, increment by the number of code
-              // items specified in this section.
-              { module.context.code_count += sec.count->value(); })
-          break;
-        }
-
-        WASP_SECTION_ELSE_SKIP(
-            Data,
-            // If skipping this section, increment by the number of data items
-            // specified in this section.
-            { module.context.data_count += sec.count->value(); })
-
-        default: break;
+  if (section->is_known()) {
+    const auto& known = section->known();
+    switch (known->id) {
+      WASP_SECTION(Type)
+      WASP_SECTION(Import)
+      WASP_SECTION_ELSE_SKIP(Function, {
+        module.context.defined_function_count += sec.count->value();
+      })
+      WASP_SECTION(Table)
+      WASP_SECTION(Memory)
+      WASP_SECTION(Global)
+      WASP_SECTION(Event)
+      WASP_SECTION(Export)
+      WASP_OPT_SECTION(Start)
+      WASP_SECTION(Element)
+      WASP_OPT_SECTION(DataCount)
+
+      case SectionId::Code: {
+        auto sec = ReadCodeSection(known, module.context);
+        WASP_IF_OK_ELSE_SKIP(
+            visitor.BeginCodeSection(sec),
+            {
+              for (const auto& code : sec.sequence) {
+                WASP_CHECK(VisitCode(module, code, visitor));
+              }
+              WASP_CHECK(visitor.EndCodeSection(sec));
+            },
+            // If skipping this section, increment by the number of code
+            // items specified in this section.
+            { module.context.code_count += sec.count->value(); })
+        break;
       }
+
+      WASP_SECTION_ELSE_SKIP(
+          Data,
+          // If skipping this section, increment by the number of data items
+          // specified in this section.
+          { module.context.data_count += sec.count->value(); })
+
+      default: break;
     }
   }
-  EndModule(module.data, module.context);
-  return visitor.EndModule(module);
+  return Result::Ok;
+}
+
+template <typename Visitor>
+inline Result VisitCode(LazyModule& module,
+                        const At<Code>& code,
+                        Visitor& visitor) {
+  WASP_IF_OK(visitor.BeginCode(code), {
+    for (auto&& instr : ReadExpression(*code->body, module.context)) {
+      WASP_CHECK(visitor.OnInstruction(instr));
+    }
+    EndCode(code->body->data.last(0), module.context);
+    WASP_CHECK(visitor.EndCode(code));
+  })
+  return Result::Ok;
 }
 
 #undef WASP_CHECK
@@ -54,6 +54,7 @@ auto ToText(TextContext&, const At<string_view>&) -> At<text::Text>;
 auto ToText(TextContext&, const At<Index>&) -> At<text::Var>;
 auto ToText(TextContext&, const OptAt<Index>&) -> OptAt<text::Var>;
 auto ToText(TextContext&, const binary::IndexList&) -> text::VarList;
+auto ToText(TextContext&, const binary::BrTableTargetList&) -> text::VarList;
 auto ToText(TextContext&, const At<binary::FunctionType>&) -> At<text::FunctionType>;
 
 // Section 1: Type
@@ -0,0 +1,70 @@
+//
+// Copyright 2020 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef WASP_LINK_LINK_H_
+#define WASP_LINK_LINK_H_
+
+#include <string>
+#include <vector>
+
+#include "wasp/base/buffer.h"
+#include "wasp/base/features.h"
+#include "wasp/base/optional.h"
+#include "wasp/base/span.h"
+#include "wasp/base/types.h"
+
+namespace wasp {
+
+class Errors;
+class ThreadPool;
+
+namespace link {
+
+struct LinkOptions {
+  // Symbols to export from the output module, by name.
+  std::vector<std::string> exports;
+
+  // Address of the first data segment.
+  u32 global_base = 1024;
+
+  // Size of the stack that is placed after the data when __stack_pointer is
+  // used but not defined by any object.
+  u32 stack_size = 64 * 1024;
+};
+
+// Links relocatable object files (e.g. from `clang -c`) into one module.
+//
+// Each object is read once. Symbols are resolved by name across objects
+// (strong definitions override weak ones), and only the first definition of
+// each comdat is kept. Undefined functions and globals become imports of the
+// output module. Data segments are laid out in order starting at
+// `global_base`, and functions whose address is taken get a slot in a
+// generated table. Relocations are then applied in place, rewriting each
+// padded LEB or i32 without moving any bytes; with a thread pool, each
+// section is relocated in parallel.
+//
+// Errors are reported with locations in the objects' data. Returns nullopt
+// if there were any.
+auto Link(span<const SpanU8> objects,
+          const Features&,
+          const LinkOptions&,
+          Errors&,
+          ThreadPool* = nullptr) -> optional<Buffer>;
+
+}  // namespace link
+}  // namespace wasp
+
+#endif  // WASP_LINK_LINK_H_
@@ -114,9 +114,9 @@ Iterator WriteRange(WriteContext& context,
   return out;
 }
 
-template <typename Iterator, typename T>
+template <typename Iterator, typename T, typename A>
 Iterator WriteVector(WriteContext& context,
-                     const std::vector<T>& values,
+                     const std::vector<T, A>& values,
                      Iterator out) {
   return WriteRange(context, values.begin(), values.end(), out);
 }
@@ -17,17 +17,17 @@
 #ifndef WASP_VALID_CONTEXT_H_
 #define WASP_VALID_CONTEXT_H_
 
-#include <map>
-#include <set>
+#include <utility>
 #include <vector>
 
 #include "wasp/base/errors.h"
 #include "wasp/base/features.h"
+#include "wasp/base/hashmap.h"
+#include "wasp/base/optional.h"
 #include "wasp/base/span.h"
 #include "wasp/base/string_view.h"
 #include "wasp/base/types.h"
 #include "wasp/binary/types.h"
-#include "wasp/valid/disjoint_set.h"
 #include "wasp/valid/local_map.h"
 #include "wasp/valid/types.h"
 
@@ -61,19 +61,46 @@ struct Label {
   bool unreachable;
 };
 
-class TypeRelationSet {
+// Assigns every defined type a canonical id, such that two type indexes have
+// the same id iff they refer to equivalent (possibly recursive) types. The ids
+// are computed lazily, once per type section, by partition refinement.
+class CanonicalTypeSet {
  public:
   void Reset(Index);
+  void Canonicalize(const std::vector<binary::DefinedType>&);
+
+  auto size() const -> Index { return static_cast<Index>(ids_.size()); }
+  auto Get(Index index) const -> Index { return ids_[index]; }
+
+ private:
+  std::vector<Index> ids_;
+};
+
+// A set of indexes, stored as a bitset that grows to fit the largest index.
+// Only insert indexes that have been validated, so they are bounded by the
+// size of their index space.
+class IndexSet {
+ public:
+  void insert(Index);
+  auto count(Index) const -> size_t;
+  auto size() const -> size_t { return size_; }
+
+ private:
+  std::vector<bool> bits_;
+  size_t size_ = 0;
+};
+
+// Memoizes a directed relation between canonical type ids, e.g. subtyping.
+class TypeRelationSet {
+ public:
+  void Reset();
 
   auto Get(Index, Index) -> optional<bool>;
   void Assume(Index, Index);
   void Resolve(Index, Index, bool);
 
  private:
-  void MaybeSwapIndexes(Index&, Index&);
-
-  DisjointSet disjoint_set_;
-  std::map<std::pair<Index, Index>, bool> assume_;
+  flat_hash_map<std::pair<Index, Index>, bool> results_;
 };
 
 struct Context {
@@ -88,6 +115,9 @@ struct Context {
   bool IsStructType(Index) const;
   bool IsArrayType(Index) const;
 
+  // Returns nullopt if the type index is out of range.
+  auto GetCanonicalTypeId(Index) -> optional<Index>;
+
   Features features;
   Errors* errors;
 
@@ -104,12 +134,12 @@ struct Context {
   optional<Index> declared_data_count;
   Index code_count = 0;
   LocalMap locals;
-  StackTypeList type_stack;
+  std::vector<StackType> type_stack;
   std::vector<Label> label_stack;
-  std::set<string_view> export_names;
-  std::set<Index> declared_functions;
+  flat_hash_set<string_view> export_names;
+  IndexSet declared_functions;
 
-  TypeRelationSet same_types;
+  CanonicalTypeSet same_types;
   TypeRelationSet match_types;
 };
 
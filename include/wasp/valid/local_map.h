@@ -17,7 +17,6 @@
 #ifndef WASP_VALID_LOCAL_MAP_H_
 #define WASP_VALID_LOCAL_MAP_H_
 
-#include <utility>
 #include <vector>
 
 #include "wasp/base/optional.h"
@@ -27,7 +26,12 @@ namespace wasp::valid {
 
 class LocalMap {
  public:
-  explicit LocalMap();
+  // Functions with at most this many locals use a dense array of run indexes,
+  // so GetType is O(1). Larger functions only use the run-length encoding,
+  // which is binary-searched.
+  static constexpr Index kDefaultDenseLimit = 1 << 20;
+
+  explicit LocalMap(Index dense_limit = kDefaultDenseLimit);
 
   void Reset();
 
@@ -49,30 +53,48 @@ class LocalMap {
   //   {f32, f32, f32, i32, i32, i64}
   //
   // Popping the binding will restore the list to {i32, i32, i64}.
+  //
+  // Both are O(1), aside from freeing the popped block's locals.
   void Push();
   void Pop();
 
  private:
-  using Pair = std::pair<binary::ValueType, Index>;
-  using Pairs = std::vector<Pair>;
-
-  bool CanAppend(Index count) const;
-  void AdjustPartialSums(Pairs::iterator first, Index count);
-
-  // Index is a partial sum, so the vector can be binary-searched, e.g.
+  // A run of locals of the same type. `end` is a partial sum within the
+  // block, so the runs of a block can be binary-searched, e.g.
   //
   //   {i32, i32, f32, f32, f32, i64}
   //
   // would be represented as:
   //
   //   {{i32, 2}, {f32, 5}, {i64, 6}}
-  Pairs pairs_;
+  struct Run {
+    binary::ValueType type;
+    Index end;
+  };
+
+  // The locals of the function, or of one let block. The blocks are stored
+  // outermost first, but their locals are numbered innermost first.
+  struct Block {
+    Index first_run;
+    Index first_dense;
+    Index count;
+  };
+
+  bool CanAppend(Index count) const;
+  auto GetRunIndex(const Block&, Index end_run, Index) const -> Index;
+
+  Index dense_limit_;
+  Index count_ = 0;
+  std::vector<Run> runs_;
+
+  // The index of the run for each local, in block order. Only valid while
+  // `use_dense_` is true.
+  bool use_dense_ = true;
+  std::vector<Index> dense_;
 
-  // The Index counts the number of `Pair`s in this let block. As variables are
-  // appended, the most recent let (i.e. `let_stack_.back()`) is updated. This
-  // vector will never be empty; there is an implicit "let" block for the
+  // This vector will never be empty; there is an implicit "let" block for the
   // function itself.
-  std::vector<Index> let_stack_;
+  std::vector<Block> blocks_;
 };
 
 }  // namespace wasp::valid
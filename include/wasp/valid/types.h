@@ -17,8 +17,7 @@
 #ifndef WASP_VALID_TYPES_H_
 #define WASP_VALID_TYPES_H_
 
-#include <vector>
-
+#include "wasp/base/inlined_vector.h"
 #include "wasp/base/macros.h"
 #include "wasp/base/span.h"
 #include "wasp/base/types.h"
@@ -28,6 +27,16 @@ namespace wasp::valid {
 
 struct Any {};
 
+// A value type on the validator's type stack, or "any". The type stack is
+// pushed and popped for every instruction, so the type is packed into 8 bytes
+// without a location, and only converted back to a binary::ValueType when
+// needed, e.g. for error messages.
+//
+//   bits 0-2:   kind (see below)
+//   bit 3:      nullable, for ref types
+//   bit 4:      heap type is an index, for ref and rtt types
+//   bits 5-31:  rtt depth
+//   bits 32-63: numeric type, reference kind, heap kind or type index
 struct StackType {
   explicit StackType();
   explicit StackType(binary::ValueType);
@@ -47,14 +56,19 @@ struct StackType {
 
   bool is_value_type() const;
   bool is_any() const;
+  bool is_numeric_type() const;
+  bool is_reference_type() const;
+  bool is_rtt() const;
+
+  auto value_type() const -> binary::ValueType;
 
-  auto value_type() -> binary::ValueType&;
-  auto value_type() const -> const binary::ValueType&;
+  static constexpr u32 kMaxRttDepth = (1u << 27) - 1;
 
-  variant<binary::ValueType, Any> type;
+  u64 bits;
 };
 
-using StackTypeList = std::vector<StackType>;
+// Label param and result types usually have at most a few elements.
+using StackTypeList = InlinedVector<StackType, 4>;
 using StackTypeSpan = span<const StackType>;
 
 auto ToValueType(binary::StorageType) -> binary::ValueType;
@@ -89,7 +103,7 @@ auto AsNonNullableType(StackType) -> StackType;
 
 #define WASP_VALID_STRUCTS_CUSTOM_FORMAT(WASP_V) \
   WASP_V(valid::Any, 0)            \
-  WASP_V(valid::StackType, 1, type)
+  WASP_V(valid::StackType, 1, bits)
 
 #define WASP_VALID_CONTAINERS(WASP_V) \
   WASP_V(valid::StackTypeList)        \
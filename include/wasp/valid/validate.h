@@ -96,6 +96,11 @@ bool Validate(Context&, const At<binary::UnpackedExpression>&);
 
 bool Validate(Context&, const binary::Module&);
 
+// Validate(Context&, const Module&) is these two, with the code section
+// validated between them.
+bool ValidateSectionsBeforeCode(Context&, const binary::Module&);
+bool ValidateSectionsAfterCode(Context&, const binary::Module&);
+
 }  // namespace wasp::valid
 
 #endif  // WASP_VALID_VALIDATE_H_
@@ -14,39 +14,23 @@
 // limitations under the License.
 //
 
-#ifndef WASP_VALID_DISJOINT_SET_H
-#define WASP_VALID_DISJOINT_SET_H
+#ifndef WASP_VALID_VALIDATE_EXPRESSION_H_
+#define WASP_VALID_VALIDATE_EXPRESSION_H_
 
-#include <vector>
-
-#include "wasp/base/types.h"
+#include "wasp/base/span.h"
+#include "wasp/binary/read/context.h"
+#include "wasp/valid/context.h"
 
 namespace wasp::valid {
 
-// See union-find algorithm described here:
-// https://en.wikipedia.org/wiki/Disjoint-set_data_structure
-class DisjointSet {
- public:
-  void Reset(Index size);
-  bool IsValid(Index) const;
-
-  auto Find(Index) -> Index;  // Find root item for this set.
-  bool IsSameSet(Index, Index);
-
-  void MergeSets(Index, Index);  // Merge disjoint sets.
-
- private:
-  struct Node {
-    Index parent;
-    int size;
-  };
-
-  auto Get(Index) const -> const Node&;
-  auto Get(Index) -> Node&;
-
-  std::vector<Node> nodes_;
-};
+// Reads and validates the instructions of an encoded expression in one pass.
+// Common instructions are validated directly from their encoding, without
+// constructing a binary::Instruction; the rest are read with binary::Read.
+//
+// Reports the same errors as validating each instruction of
+// binary::ReadExpression, and likewise stops at the first read error.
+bool ValidateExpression(Context&, binary::Context&, SpanU8 data);
 
 }  // namespace wasp::valid
 
-#endif  // WASP_VALID_DISJOINT_SET_H
+#endif  // WASP_VALID_VALIDATE_EXPRESSION_H_
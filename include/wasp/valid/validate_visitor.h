@@ -17,6 +17,8 @@
 #ifndef WASP_VALID_VALIDATE_VISITOR_H_
 #define WASP_VALID_VALIDATE_VISITOR_H_
 
+#include <vector>
+
 #include "wasp/binary/visitor.h"
 #include "wasp/valid/context.h"
 #include "wasp/valid/validate.h"
@@ -24,6 +26,7 @@
 namespace wasp {
 
 class Errors;
+class ThreadPool;
 
 namespace valid {
 
@@ -31,7 +34,14 @@ struct ValidateVisitor : binary::visit::Visitor {
   using Result = binary::visit::Result;
 
   explicit ValidateVisitor(Features features, Errors& errors);
+  // When a thread pool is given, function bodies are collected while visiting
+  // the code section, then validated in parallel once they reach
+  // code_batch_size bytes, and at the end of the section. Errors are reported
+  // in the same order, and stop at the same function, as when validating
+  // serially.
+  explicit ValidateVisitor(Features features, Errors& errors, ThreadPool*);
 
+  auto BeginModule(binary::LazyModule&) -> Result;
   auto BeginTypeSection(binary::LazyTypeSection) -> Result;
   auto OnType(const At<binary::DefinedType>&) -> Result;
   auto OnImport(const At<binary::Import>&) -> Result;
@@ -45,13 +55,22 @@ struct ValidateVisitor : binary::visit::Visitor {
   auto OnDataCount(const At<binary::DataCount>&) -> Result;
   auto BeginCode(const At<binary::Code>&) -> Result;
   auto OnInstruction(const At<binary::Instruction>&) -> Result;
+  auto EndCodeSection(binary::LazyCodeSection) -> Result;
   auto OnData(const At<binary::DataSegment>&) -> Result;
 
+  auto DefersCode() const -> bool;
+  auto DeferredCodeCount() const -> size_t;
   auto FailUnless(bool) -> Result;
+  auto ValidateCodesInParallel() -> bool;
 
   valid::Context context;
   Features features;
   Errors& errors;
+  ThreadPool* thread_pool = nullptr;
+  binary::Context* binary_context = nullptr;
+  size_t code_batch_size = 1024 * 1024;
+  std::vector<At<binary::Code>> pending_codes;
+  size_t pending_code_size = 0;
 };
 
 }  // namespace valid
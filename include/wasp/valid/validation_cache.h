@@ -0,0 +1,77 @@
+//
+// Copyright 2020 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef WASP_VALID_VALIDATION_CACHE_H_
+#define WASP_VALID_VALIDATION_CACHE_H_
+
+#include <string>
+
+#include "wasp/base/features.h"
+#include "wasp/base/optional.h"
+#include "wasp/base/span.h"
+#include "wasp/base/string_view.h"
+#include "wasp/base/types.h"
+
+namespace wasp {
+
+class Errors;
+class ThreadPool;
+
+namespace valid {
+
+// A cache of validation results on disk. Entries are keyed by a 64-bit hash
+// of the module bytes, the module size, the enabled features, and the
+// validator version, and hold whether the module was valid along with the
+// errors that were reported.
+// Locations are stored as offsets into the module, so a hit can replay the
+// errors without reading or validating the module.
+//
+// Entries are written to a temporary file and then renamed, so several
+// processes can share one directory. The directory must already exist.
+class ValidationCache {
+ public:
+  explicit ValidationCache(string_view directory);
+
+  // Returns whether `data` was valid when validated with `features`, and
+  // reports its errors to `errors`, or returns nullopt if there is no entry.
+  auto Lookup(SpanU8 data, const Features&, Errors&) const -> optional<bool>;
+
+  // Validates `data` like `wasp validate` does (ReadModule, then a
+  // ValidateVisitor) unless it has an entry, then stores the result. Returns
+  // whether the module is valid; either way the same errors are reported.
+  bool Validate(SpanU8 data,
+                const Features&,
+                Errors&,
+                ThreadPool* = nullptr);
+
+  // The file that holds the entry for `data`, whether or not it exists.
+  auto EntryPath(SpanU8 data, const Features&) const -> std::string;
+
+  static u64 Hash(SpanU8);
+
+  // Identifies the build of the reader and validator, as a hash of their
+  // sources. Entries written by a build with a different version are misses,
+  // so upgrading wasp never replays stale results.
+  static auto ValidatorVersion() -> string_view;
+
+ private:
+  std::string directory_;
+};
+
+}  // namespace valid
+}  // namespace wasp
+
+#endif  // WASP_VALID_VALIDATION_CACHE_H_
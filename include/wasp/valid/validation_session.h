@@ -0,0 +1,88 @@
+//
+// Copyright 2020 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef WASP_VALID_VALIDATION_SESSION_H_
+#define WASP_VALID_VALIDATION_SESSION_H_
+
+#include <deque>
+#include <string>
+#include <vector>
+
+#include "wasp/base/at.h"
+#include "wasp/base/features.h"
+#include "wasp/base/types.h"
+#include "wasp/binary/types.h"
+#include "wasp/valid/context.h"
+
+namespace wasp {
+
+class Errors;
+
+namespace valid {
+
+// Validates a module once, then keeps the module-level Context and the
+// verdict for each function body, so that small edits only revalidate what
+// they affect. The module may refer to the bytes it was read from (e.g. for
+// names), which must outlive the session.
+//
+// Validate must be called before any edit; edits before then fail with an
+// error.
+class ValidationSession {
+ public:
+  explicit ValidationSession(const Features&, binary::Module);
+
+  // Validates the whole module, like Validate(Context&, const Module&).
+  // Returns whether the module is valid.
+  bool Validate(Errors&);
+
+  // Replaces the body of the defined function `func_index`, and revalidates
+  // only that body. Returns whether the new body is valid.
+  bool ReplaceFunctionBody(Index func_index,
+                           const At<binary::UnpackedCode>&,
+                           Errors&);
+
+  // Adds an export, checking its index and that its name is unique. The name
+  // is copied, so it may be a temporary.
+  // Exporting a function also declares it for ref.func, so invalid bodies
+  // that refer to it are revalidated. Returns whether the export is valid; an
+  // invalid export isn't added, and leaves the session unchanged.
+  bool AddExport(const At<binary::Export>&, Errors&);
+
+  bool IsValid() const;
+  auto module() const -> const binary::Module&;
+
+ private:
+  bool CheckValidated(Location, Errors&);
+  bool ValidateCode(Index code_index, Errors&);
+
+  binary::Module module_;
+  Context context_;
+  bool validated_ = false;
+  bool module_valid_ = false;  // Everything but the function bodies.
+  std::vector<bool> code_valid_;
+
+  // The function indexes used by each body's ref.func instructions.
+  std::vector<std::vector<Index>> ref_funcs_;
+
+  // The names of added exports. The context's export_names refers to these,
+  // so a deque is used to keep them from moving.
+  std::deque<std::string> export_names_;
+};
+
+}  // namespace valid
+}  // namespace wasp
+
+#endif  // WASP_VALID_VALIDATION_SESSION_H_
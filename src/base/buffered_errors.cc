@@ -0,0 +1,54 @@
+//
+// Copyright 2020 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "wasp/base/buffered_errors.h"
+
+#include <cassert>
+
+namespace wasp {
+
+void BufferedErrors::ReplayTo(Errors& errors) const {
+  ReplayTo(errors, 0, errors_.size());
+}
+
+void BufferedErrors::ReplayTo(Errors& errors, size_t begin, size_t end) const {
+  assert(begin <= end && end <= errors_.size());
+  for (size_t i = begin; i < end; ++i) {
+    const BufferedError& error = errors_[i];
+    for (const auto& context : error.context) {
+      errors.PushContext(context.loc, context.desc);
+    }
+    errors.OnError(error.loc, error.message);
+    for (size_t j = 0; j < error.context.size(); ++j) {
+      errors.PopContext();
+    }
+  }
+}
+
+void BufferedErrors::Clear() {
+  errors_.clear();
+}
+
+void BufferedErrors::HandleOnError(Location loc, string_view message) {
+  BufferedError error{{}, loc, std::string{message}};
+  error.context.reserve(context().size());
+  for (const auto& item : context()) {
+    error.context.push_back(ErrorContext{item.loc, std::string{item.desc}});
+  }
+  errors_.push_back(std::move(error));
+}
+
+}  // namespace wasp
@@ -0,0 +1,84 @@
+//
+// Copyright 2020 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "wasp/base/compact_location.h"
+
+#include <cstdint>
+
+namespace wasp {
+
+namespace {
+
+// The newest LocationBase of this thread. It is a plain pointer, so it can be
+// used during static initialization and destruction.
+thread_local LocationBase* t_newest_base = nullptr;
+
+}  // namespace
+
+CompactLocation::CompactLocation(Location loc) {
+  SpanU8 base = LocationBase::Get();
+  auto base_begin = reinterpret_cast<uintptr_t>(base.data());
+  auto base_end = base_begin + base.size();
+  auto begin = reinterpret_cast<uintptr_t>(loc.data());
+  auto end = begin + loc.size();
+  if (loc.data() != nullptr && base.data() != nullptr && begin >= base_begin &&
+      end <= base_end && end - base_begin < kNone) {
+    offset_ = static_cast<u32>(begin - base_begin);
+    size_ = static_cast<u32>(loc.size());
+  }
+}
+
+auto CompactLocation::ToLocation() const -> Location {
+  SpanU8 base = LocationBase::Get();
+  if (!has_value() || u64{offset_} + size_ > base.size()) {
+    return Location{};
+  }
+  return base.subspan(offset_, size_);
+}
+
+bool operator==(const CompactLocation& lhs, const CompactLocation& rhs) {
+  return lhs.ToLocation() == rhs.ToLocation();
+}
+
+bool operator!=(const CompactLocation& lhs, const CompactLocation& rhs) {
+  return !(lhs == rhs);
+}
+
+LocationBase::LocationBase(SpanU8 buffer)
+    : buffer_{buffer}, older_{t_newest_base} {
+  if (older_) {
+    older_->newer_ = this;
+  }
+  t_newest_base = this;
+}
+
+LocationBase::~LocationBase() {
+  if (older_) {
+    older_->newer_ = newer_;
+  }
+  if (newer_) {
+    newer_->older_ = older_;
+  } else {
+    t_newest_base = older_;
+  }
+}
+
+// static
+auto LocationBase::Get() -> SpanU8 {
+  return t_newest_base ? t_newest_base->buffer_ : SpanU8{};
+}
+
+}  // namespace wasp
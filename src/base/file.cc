@@ -17,21 +17,54 @@
 #include "wasp/base/file.h"
 
 #include <fstream>
+#include <iostream>
+#include <iterator>
 #include <string>
+#include <utility>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define WASP_HAS_MMAP 1
+#else
+#define WASP_HAS_MMAP 0
+#endif
 
 namespace wasp {
 
+namespace {
+
+Buffer ReadStream(std::istream& stream) {
+  return Buffer(std::istreambuf_iterator<char>{stream},
+                std::istreambuf_iterator<char>{});
+}
+
+}  // namespace
+
 optional<Buffer> ReadFile(string_view filename) {
+  if (filename == "-") {
+    return ReadStream(std::cin);
+  }
+
   std::ifstream stream{std::string{filename}, std::ios::in | std::ios::binary};
   if (!stream) {
     return nullopt;
   }
 
-  Buffer buffer;
   stream.seekg(0, std::ios::end);
-  buffer.resize(stream.tellg());
+  auto size = stream.tellg();
+  if (size < 0) {
+    // Not seekable (e.g. a pipe); read until EOF instead.
+    stream.clear();
+    return ReadStream(stream);
+  }
+
+  Buffer buffer;
+  buffer.resize(size);
   stream.seekg(0, std::ios::beg);
-  stream.read(reinterpret_cast<char*>(&buffer[0]), buffer.size());
+  stream.read(reinterpret_cast<char*>(buffer.data()), buffer.size());
   if (stream.fail()) {
     return nullopt;
   }
@@ -39,4 +72,77 @@ optional<Buffer> ReadFile(string_view filename) {
   return buffer;
 }
 
+MappedFile::MappedFile(Buffer buffer)
+    : buffer_{std::move(buffer)}, span_{buffer_} {}
+
+MappedFile::~MappedFile() {
+  Reset();
+}
+
+MappedFile::MappedFile(MappedFile&& rhs) noexcept {
+  *this = std::move(rhs);
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& rhs) noexcept {
+  if (this != &rhs) {
+    Reset();
+    map_ = std::exchange(rhs.map_, nullptr);
+    map_size_ = std::exchange(rhs.map_size_, 0);
+    // Moving a vector keeps its heap storage, so span_ stays valid.
+    buffer_ = std::move(rhs.buffer_);
+    span_ = std::exchange(rhs.span_, SpanU8{});
+  }
+  return *this;
+}
+
+void MappedFile::Reset() {
+#if WASP_HAS_MMAP
+  if (map_) {
+    munmap(map_, map_size_);
+  }
+#endif
+  map_ = nullptr;
+  map_size_ = 0;
+  buffer_.clear();
+  span_ = SpanU8{};
+}
+
+optional<MappedFile> MapFile(string_view filename, FileAccess access) {
+#if WASP_HAS_MMAP
+  if (filename != "-") {
+    int fd = open(std::string{filename}.c_str(), O_RDONLY);
+    if (fd < 0) {
+      return nullopt;
+    }
+
+    struct stat st;
+    // Empty files can't be mapped; let ReadFile handle them along with pipes
+    // and devices.
+    if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+      size_t size = static_cast<size_t>(st.st_size);
+      void* map = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+      close(fd);
+      if (map != MAP_FAILED) {
+        madvise(map, size,
+                access == FileAccess::Sequential ? MADV_SEQUENTIAL
+                                                 : MADV_RANDOM);
+        MappedFile result;
+        result.map_ = map;
+        result.map_size_ = size;
+        result.span_ = SpanU8{static_cast<const u8*>(map), size};
+        return result;
+      }
+    } else {
+      close(fd);
+    }
+  }
+#endif
+
+  auto optbuf = ReadFile(filename);
+  if (!optbuf) {
+    return nullopt;
+  }
+  return MappedFile{std::move(*optbuf)};
+}
+
 }  // namespace wasp
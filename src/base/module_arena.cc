@@ -0,0 +1,71 @@
+//
+// Copyright 2020 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "wasp/base/module_arena.h"
+
+#include <cassert>
+#include <cstdint>
+
+namespace wasp {
+
+namespace {
+
+u8* Align(u8* ptr, size_t align) {
+  auto value = reinterpret_cast<uintptr_t>(ptr);
+  return reinterpret_cast<u8*>((value + align - 1) & ~uintptr_t{align - 1});
+}
+
+}  // namespace
+
+ModuleArena::ModuleArena(size_t block_size) : block_size_{block_size} {}
+
+ModuleArena::~ModuleArena() {
+  // Otherwise something allocated from this arena is still alive, and will
+  // refer to freed memory.
+  assert(live_allocations_ == 0);
+}
+
+void* ModuleArena::Allocate(size_t size, size_t align) {
+  bytes_allocated_ += size;
+  ++live_allocations_;
+
+  // Large allocations get their own block, so they don't waste the rest of
+  // the current one.
+  if (size + align > block_size_ / 4) {
+    return Align(AllocateBlock(size + align), align);
+  }
+
+  u8* result = Align(ptr_, align);
+  if (ptr_ == nullptr || result + size > end_) {
+    ptr_ = AllocateBlock(block_size_);
+    end_ = ptr_ + block_size_;
+    result = Align(ptr_, align);
+  }
+  ptr_ = result + size;
+  return result;
+}
+
+u8* ModuleArena::AllocateBlock(size_t size) {
+  blocks_.emplace_back(new u8[size]);
+  return blocks_.back().get();
+}
+
+void ModuleArena::Deallocate() {
+  assert(live_allocations_ > 0);
+  --live_allocations_;
+}
+
+}  // namespace wasp
@@ -0,0 +1,165 @@
+//
+// Copyright 2020 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "wasp/base/thread_pool.h"
+
+#include <algorithm>
+#include <cassert>
+#include <limits>
+
+#include "wasp/base/compact_location.h"
+
+namespace wasp {
+
+namespace {
+
+u64 Pack(u32 begin, u32 end) {
+  return (u64{begin} << 32) | end;
+}
+
+u32 Begin(u64 packed) {
+  return static_cast<u32>(packed >> 32);
+}
+
+u32 End(u64 packed) {
+  return static_cast<u32>(packed);
+}
+
+}  // namespace
+
+ThreadPool::ThreadPool(int thread_count)
+    : thread_count_{std::max(thread_count, 1)},
+      ranges_{new WorkRange[thread_count_]} {
+  for (int worker = 1; worker < thread_count_; ++worker) {
+    threads_.emplace_back([this, worker]() { ThreadMain(worker); });
+  }
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock{mutex_};
+    stop_ = true;
+  }
+  start_cv_.notify_all();
+  for (auto& thread : threads_) {
+    thread.join();
+  }
+}
+
+void ThreadPool::ParallelFor(size_t count, const Task& task) {
+  if (count == 0) {
+    return;
+  }
+  assert(count <= std::numeric_limits<u32>::max());
+
+  // Give each worker an equal slice to start with.
+  u32 begin = 0;
+  for (int worker = 0; worker < thread_count_; ++worker) {
+    u32 end = static_cast<u32>(count * (worker + 1) / thread_count_);
+    ranges_[worker].packed.store(Pack(begin, end), std::memory_order_relaxed);
+    begin = end;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock{mutex_};
+    task_ = &task;
+    location_base_ = LocationBase::Get();
+    running_ = static_cast<int>(threads_.size());
+    generation_++;
+  }
+  start_cv_.notify_all();
+
+  RunWorker(0);
+
+  std::unique_lock<std::mutex> lock{mutex_};
+  done_cv_.wait(lock, [this]() { return running_ == 0; });
+  task_ = nullptr;
+}
+
+void ThreadPool::ThreadMain(int worker) {
+  u64 seen_generation = 0;
+  for (;;) {
+    SpanU8 location_base;
+    {
+      std::unique_lock<std::mutex> lock{mutex_};
+      start_cv_.wait(lock, [&]() {
+        return stop_ || generation_ != seen_generation;
+      });
+      if (stop_) {
+        return;
+      }
+      seen_generation = generation_;
+      location_base = location_base_;
+    }
+
+    {
+      LocationBase base{location_base};
+      RunWorker(worker);
+    }
+
+    {
+      std::lock_guard<std::mutex> lock{mutex_};
+      --running_;
+    }
+    done_cv_.notify_one();
+  }
+}
+
+void ThreadPool::RunWorker(int worker) {
+  size_t index;
+  while (PopLocal(worker, &index) || Steal(worker, &index)) {
+    (*task_)(index, worker);
+  }
+}
+
+bool ThreadPool::PopLocal(int worker, size_t* index) {
+  auto& range = ranges_[worker].packed;
+  u64 packed = range.load(std::memory_order_acquire);
+  while (Begin(packed) < End(packed)) {
+    if (range.compare_exchange_weak(packed,
+                                    Pack(Begin(packed) + 1, End(packed)),
+                                    std::memory_order_acq_rel)) {
+      *index = Begin(packed);
+      return true;
+    }
+  }
+  return false;
+}
+
+bool ThreadPool::Steal(int worker, size_t* index) {
+  for (int i = 1; i < thread_count_; ++i) {
+    int victim = (worker + i) % thread_count_;
+    auto& range = ranges_[victim].packed;
+    u64 packed = range.load(std::memory_order_acquire);
+    while (Begin(packed) < End(packed)) {
+      u32 begin = Begin(packed), end = End(packed);
+      // Take the upper half (at least one item) of the victim's range.
+      u32 mid = begin + (end - begin) / 2;
+      if (range.compare_exchange_weak(packed, Pack(begin, mid),
+                                      std::memory_order_acq_rel)) {
+        // Only this worker pops from its own range, and it is empty now, so
+        // a plain store is safe; thieves that raced with us will retry.
+        ranges_[worker].packed.store(Pack(mid + 1, end),
+                                     std::memory_order_release);
+        *index = mid;
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+}  // namespace wasp
@@ -18,6 +18,24 @@
 
 #include "wasp/base/types.h"
 
+#if defined(__x86_64__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2) || defined(__SSE2__)
+#define WASP_UTF8_SSE2 1
+#include <emmintrin.h>
+#endif
+
+// The AVX2 version is compiled with a target attribute and only used when the
+// CPU supports it, so it needs GCC or clang.
+#if WASP_UTF8_SSE2 && defined(__GNUC__)
+#define WASP_UTF8_AVX2 1
+#include <immintrin.h>
+#endif
+
+#if defined(__aarch64__) || defined(_M_ARM64)
+#define WASP_UTF8_NEON 1
+#include <arm_neon.h>
+#endif
+
 namespace wasp {
 
 // Decoder modified from https://bjoern.hoehrmann.de/utf-8/decoder/dfa/, with
@@ -43,32 +61,132 @@ namespace wasp {
 // FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
 // IN THE SOFTWARE.
 
-bool IsValidUtf8(string_view s) {
-  static const u8 utf8d[] = {
-    0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0, // 00..1f
-    0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0, // 20..3f
-    0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0, // 40..5f
-    0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0, // 60..7f
-    1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,9,9,9,9,9,9,9,9,9,9,9,9,9,9,9,9, // 80..9f
-    7,7,7,7,7,7,7,7,7,7,7,7,7,7,7,7,7,7,7,7,7,7,7,7,7,7,7,7,7,7,7,7, // a0..bf
-    8,8,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2, // c0..df
-    0xa,0x3,0x3,0x3,0x3,0x3,0x3,0x3,0x3,0x3,0x3,0x3,0x3,0x4,0x3,0x3, // e0..ef
-    0xb,0x6,0x6,0x6,0x5,0x8,0x8,0x8,0x8,0x8,0x8,0x8,0x8,0x8,0x8,0x8, // f0..ff
-    0x0,0x1,0x2,0x3,0x5,0x8,0x7,0x1,0x1,0x1,0x4,0x6,0x1,0x1,0x1,0x1, // s0..s0
-    1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,0,1,1,1,1,1,0,1,0,1,1,1,1,1,1, // s1..s2
-    1,2,1,1,1,1,1,2,1,2,1,1,1,1,1,1,1,1,1,1,1,1,1,2,1,1,1,1,1,1,1,1, // s3..s4
-    1,2,1,1,1,1,1,1,1,2,1,1,1,1,1,1,1,1,1,1,1,1,1,3,1,3,1,1,1,1,1,1, // s5..s6
-    1,3,1,1,1,1,1,3,1,3,1,1,1,1,1,1,1,3,1,1,1,1,1,1,1,1,1,1,1,1,1,1, // s7..s8
-  };
-
-  u32 state = 0;
-  static const u32 accept = 0;
-
-  for (u8 c : s) {
-    u32 type = utf8d[c];
-    state = utf8d[256 + state * 16 + type];
+namespace {
+
+const u8 kUtf8d[] = {
+  0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0, // 00..1f
+  0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0, // 20..3f
+  0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0, // 40..5f
+  0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0, // 60..7f
+  1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,9,9,9,9,9,9,9,9,9,9,9,9,9,9,9,9, // 80..9f
+  7,7,7,7,7,7,7,7,7,7,7,7,7,7,7,7,7,7,7,7,7,7,7,7,7,7,7,7,7,7,7,7, // a0..bf
+  8,8,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2, // c0..df
+  0xa,0x3,0x3,0x3,0x3,0x3,0x3,0x3,0x3,0x3,0x3,0x3,0x3,0x4,0x3,0x3, // e0..ef
+  0xb,0x6,0x6,0x6,0x5,0x8,0x8,0x8,0x8,0x8,0x8,0x8,0x8,0x8,0x8,0x8, // f0..ff
+  0x0,0x1,0x2,0x3,0x5,0x8,0x7,0x1,0x1,0x1,0x4,0x6,0x1,0x1,0x1,0x1, // s0..s0
+  1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,0,1,1,1,1,1,0,1,0,1,1,1,1,1,1, // s1..s2
+  1,2,1,1,1,1,1,2,1,2,1,1,1,1,1,1,1,1,1,1,1,1,1,2,1,1,1,1,1,1,1,1, // s3..s4
+  1,2,1,1,1,1,1,1,1,2,1,1,1,1,1,1,1,1,1,1,1,1,1,3,1,3,1,1,1,1,1,1, // s5..s6
+  1,3,1,1,1,1,1,3,1,3,1,1,1,1,1,1,1,3,1,1,1,1,1,1,1,1,1,1,1,1,1,1, // s7..s8
+};
+
+const u32 kAccept = 0;
+const u32 kReject = 1;
+
+u32 DecodeUtf8(u32 state, const u8* begin, const u8* end) {
+  for (const u8* p = begin; p < end; ++p) {
+    u32 type = kUtf8d[*p];
+    state = kUtf8d[256 + state * 16 + type];
+  }
+  return state;
+}
+
+// The vectorized versions check a whole chunk for non-ASCII bytes at once.
+// ASCII bytes leave the DFA in the accept state, so while the DFA is there
+// those chunks can be skipped; any other chunk is run through the DFA.
+template <typename Chunk>
+bool IsValidUtf8Chunked(const u8* p, const u8* end) {
+  u32 state = kAccept;
+  while (end - p >= Chunk::kSize) {
+    if (state != kAccept || !Chunk::IsAscii(p)) {
+      state = DecodeUtf8(state, p, p + Chunk::kSize);
+      if (state == kReject) {
+        return false;
+      }
+    }
+    p += Chunk::kSize;
+  }
+  return DecodeUtf8(state, p, end) == kAccept;
+}
+
+#if WASP_UTF8_SSE2
+
+struct ChunkSSE2 {
+  static constexpr ptrdiff_t kSize = 16;
+
+  static bool IsAscii(const u8* p) {
+    __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+    return _mm_movemask_epi8(chunk) == 0;
+  }
+};
+
+#endif  // WASP_UTF8_SSE2
+
+#if WASP_UTF8_AVX2
+
+// Written out rather than using IsValidUtf8Chunked, so the whole loop is
+// compiled for AVX2.
+__attribute__((target("avx2")))
+bool IsValidUtf8AVX2(const u8* p, const u8* end) {
+  u32 state = kAccept;
+  while (end - p >= 32) {
+    __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+    if (state != kAccept || _mm256_movemask_epi8(chunk) != 0) {
+      state = DecodeUtf8(state, p, p + 32);
+      if (state == kReject) {
+        return false;
+      }
+    }
+    p += 32;
+  }
+  return DecodeUtf8(state, p, end) == kAccept;
+}
+
+#endif  // WASP_UTF8_AVX2
+
+#if WASP_UTF8_NEON
+
+struct ChunkNEON {
+  static constexpr ptrdiff_t kSize = 16;
+
+  static bool IsAscii(const u8* p) { return vmaxvq_u8(vld1q_u8(p)) < 0x80; }
+};
+
+#endif  // WASP_UTF8_NEON
+
+bool IsValidUtf8DFA(const u8* p, const u8* end) {
+  return DecodeUtf8(kAccept, p, end) == kAccept;
+}
+
+using IsValidUtf8Fn = bool (*)(const u8*, const u8*);
+
+IsValidUtf8Fn SelectIsValidUtf8() {
+#if WASP_UTF8_AVX2
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2")) {
+    return IsValidUtf8AVX2;
   }
-  return state == accept;
+#endif
+#if WASP_UTF8_SSE2
+  return IsValidUtf8Chunked<ChunkSSE2>;
+#elif WASP_UTF8_NEON
+  return IsValidUtf8Chunked<ChunkNEON>;
+#else
+  return IsValidUtf8DFA;
+#endif
+}
+
+}  // namespace
+
+bool IsValidUtf8Scalar(string_view s) {
+  auto* begin = reinterpret_cast<const u8*>(s.data());
+  return IsValidUtf8DFA(begin, begin + s.size());
+}
+
+bool IsValidUtf8(string_view s) {
+  static const IsValidUtf8Fn s_is_valid_utf8 = SelectIsValidUtf8();
+  auto* begin = reinterpret_cast<const u8*>(s.data());
+  return s_is_valid_utf8(begin, begin + s.size());
 }
 
 }  // namespace wasp
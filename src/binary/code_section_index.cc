@@ -0,0 +1,82 @@
+//
+// Copyright 2020 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "wasp/binary/code_section_index.h"
+
+#include <utility>
+
+#include "wasp/base/errors_context_guard.h"
+#include "wasp/binary/read.h"
+#include "wasp/binary/read/context.h"
+
+namespace wasp::binary {
+
+CodeSectionIndex::CodeSectionIndex(SpanU8 section_data,
+                                   std::vector<Entry> entries)
+    : section_data_{section_data}, entries_{std::move(entries)} {}
+
+auto CodeSectionIndex::GetEntryData(Index index) const -> optional<SpanU8> {
+  if (index >= entries_.size()) {
+    return nullopt;
+  }
+  const Entry& entry = entries_[index];
+  return section_data_.subspan(entry.offset, entry.size);
+}
+
+auto CodeSectionIndex::GetCode(Index index, Context& context) const
+    -> OptAt<Code> {
+  auto data = GetEntryData(index);
+  if (!data) {
+    return nullopt;
+  }
+  // Random-access reads shouldn't count toward the module's code count, which
+  // is only meaningful when reading the section in order.
+  Index code_count = context.code_count;
+  auto code = Read<Code>(&*data, context);
+  context.code_count = code_count;
+  return code;
+}
+
+auto ReadCodeSectionIndex(SpanU8 data, Context& context) -> CodeSectionIndex {
+  ErrorsContextGuard error_guard{context.errors, data, "code section"};
+  const SpanU8 section_data = data;
+  std::vector<CodeSectionIndex::Entry> entries;
+  auto count = ReadCount(&data, context);
+  if (!count) {
+    return CodeSectionIndex{};
+  }
+
+  entries.reserve(*count);
+  for (Index i = 0; i < *count; ++i) {
+    const u8* entry_begin = data.begin();
+    auto body_size = ReadLength(&data, context);
+    if (!body_size) {
+      break;
+    }
+    data.remove_prefix(*body_size);
+    entries.push_back(CodeSectionIndex::Entry{
+        static_cast<u32>(entry_begin - section_data.begin()),
+        static_cast<u32>(data.begin() - entry_begin)});
+  }
+  return CodeSectionIndex{section_data, std::move(entries)};
+}
+
+auto ReadCodeSectionIndex(KnownSection sec, Context& context)
+    -> CodeSectionIndex {
+  return ReadCodeSectionIndex(sec.data, context);
+}
+
+}  // namespace wasp::binary
@@ -0,0 +1,285 @@
+//
+// Copyright 2020 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "wasp/binary/eager_module.h"
+
+#include <algorithm>
+#include <memory>
+#include <numeric>
+#include <vector>
+
+#include "wasp/base/buffered_errors.h"
+#include "wasp/base/thread_pool.h"
+#include "wasp/binary/lazy_expression.h"
+#include "wasp/binary/lazy_module.h"
+#include "wasp/binary/read.h"
+#include "wasp/binary/read/context.h"
+#include "wasp/binary/visitor.h"
+
+namespace wasp::binary {
+
+namespace {
+
+using Arenas = std::vector<std::unique_ptr<ModuleArena>>;
+
+// State for one thread of reading function bodies.
+struct CodeWorker {
+  explicit CodeWorker(const Context& module_context, bool use_arena)
+      : arena{use_arena ? std::make_unique<ModuleArena>() : nullptr},
+        context{module_context.features, errors} {
+    context.declared_data_count = module_context.declared_data_count;
+    context.arena = arena.get();
+  }
+
+  // The errors of one function body, as a range of `errors`.
+  struct ErrorRange {
+    Index code_index;
+    size_t begin;
+    size_t end;
+  };
+
+  std::unique_ptr<ModuleArena> arena;
+  BufferedErrors errors;
+  Context context;
+  std::vector<ErrorRange> error_ranges;
+};
+
+// Reads the instructions of one function body, the same way that visiting
+// the code does, into the context's arena (if any).
+At<UnpackedCode> UnpackCode(const At<Code>& code, Context& context) {
+  context.open_blocks.clear();
+  LocalsList locals{code->locals.begin(), code->locals.end(),
+                    LocalsList::allocator_type{context.arena}};
+  UnpackedExpression body{
+      InstructionList{InstructionList::allocator_type{context.arena}}};
+  // Like ReadExpression, but the instructions are moved rather than copied
+  // out, so their immediates stay in the arena.
+  SpanU8 data = code->body->data;
+  context.seen_final_end = false;
+  while (!data.empty()) {
+    auto instr = Read<Instruction>(&data, context);
+    if (!instr) {
+      break;
+    }
+    body.instructions.push_back(std::move(*instr));
+  }
+  EndCode(code->body->data.last(0), context);
+  return At{code.loc(), UnpackedCode{std::move(locals), std::move(body)}};
+}
+
+struct EagerVisitor : visit::Visitor {
+  explicit EagerVisitor(Module& module,
+                        ThreadPool* thread_pool,
+                        Arenas* arenas)
+      : module{module}, thread_pool{thread_pool}, arenas{arenas} {}
+
+  visit::Result BeginModule(LazyModule& lazy_module) {
+    context = &lazy_module.context;
+    return visit::Result::Ok;
+  }
+
+  visit::Result OnType(const At<DefinedType>& value) {
+    module.types.push_back(value);
+    return visit::Result::Ok;
+  }
+
+  visit::Result OnImport(const At<Import>& value) {
+    module.imports.push_back(value);
+    return visit::Result::Ok;
+  }
+
+  visit::Result OnFunction(const At<Function>& value) {
+    module.functions.push_back(value);
+    return visit::Result::Ok;
+  }
+
+  visit::Result OnTable(const At<Table>& value) {
+    module.tables.push_back(value);
+    return visit::Result::Ok;
+  }
+
+  visit::Result OnMemory(const At<Memory>& value) {
+    module.memories.push_back(value);
+    return visit::Result::Ok;
+  }
+
+  visit::Result OnGlobal(const At<Global>& value) {
+    module.globals.push_back(value);
+    return visit::Result::Ok;
+  }
+
+  visit::Result OnEvent(const At<Event>& value) {
+    module.events.push_back(value);
+    return visit::Result::Ok;
+  }
+
+  visit::Result OnExport(const At<Export>& value) {
+    module.exports.push_back(value);
+    return visit::Result::Ok;
+  }
+
+  visit::Result OnStart(const At<Start>& value) {
+    module.start = value;
+    return visit::Result::Ok;
+  }
+
+  visit::Result OnElement(const At<ElementSegment>& value) {
+    module.element_segments.push_back(value);
+    return visit::Result::Ok;
+  }
+
+  visit::Result OnDataCount(const At<DataCount>& value) {
+    module.data_count = value;
+    return visit::Result::Ok;
+  }
+
+  // The bodies are read all at once, at the end of the code section.
+  visit::Result BeginCode(const At<Code>& code) {
+    pending_codes.push_back(code);
+    return visit::Result::Skip;
+  }
+
+  visit::Result EndCodeSection(LazyCodeSection) {
+    ReadPendingCodes();
+    return visit::Result::Ok;
+  }
+
+  visit::Result OnData(const At<DataSegment>& value) {
+    module.data_segments.push_back(value);
+    return visit::Result::Ok;
+  }
+
+  void ReadPendingCodes();
+
+  Module& module;
+  ThreadPool* thread_pool;
+  Arenas* arenas;  // If non-null, each worker's arena is added here.
+  Context* context = nullptr;
+  std::vector<At<Code>> pending_codes;
+};
+
+void EagerVisitor::ReadPendingCodes() {
+  const size_t first_code = module.codes.size();
+  const size_t count = pending_codes.size();
+  module.codes.resize(first_code + count);
+
+  // Start with the largest bodies, so a large body read last doesn't leave
+  // the other workers idle.
+  std::vector<Index> order(count);
+  std::iota(order.begin(), order.end(), 0);
+  if (thread_pool) {
+    std::stable_sort(order.begin(), order.end(), [&](Index lhs, Index rhs) {
+      return pending_codes[lhs]->body->data.size() >
+             pending_codes[rhs]->body->data.size();
+    });
+  }
+
+  std::vector<std::unique_ptr<CodeWorker>> workers(
+      thread_pool ? thread_pool->thread_count() : 1);
+  auto read_code = [&](size_t i, int worker_index) {
+    auto& worker = workers[worker_index];
+    if (!worker) {
+      worker = std::make_unique<CodeWorker>(*context, arenas != nullptr);
+    }
+    const Index code_index = order[i];
+    size_t begin = worker->errors.size();
+    module.codes[first_code + code_index] =
+        UnpackCode(pending_codes[code_index], worker->context);
+    if (worker->errors.size() != begin) {
+      worker->error_ranges.push_back(
+          CodeWorker::ErrorRange{code_index, begin, worker->errors.size()});
+    }
+  };
+  if (thread_pool) {
+    thread_pool->ParallelFor(count, read_code);
+  } else {
+    for (size_t i = 0; i < count; ++i) {
+      read_code(i, 0);
+    }
+  }
+
+  // Report the errors in function (and therefore source offset) order.
+  struct Pending {
+    const CodeWorker* worker;
+    CodeWorker::ErrorRange range;
+  };
+  std::vector<Pending> pending;
+  for (const auto& worker : workers) {
+    if (worker) {
+      for (const auto& range : worker->error_ranges) {
+        pending.push_back(Pending{worker.get(), range});
+      }
+    }
+  }
+  std::sort(pending.begin(), pending.end(),
+            [](const Pending& lhs, const Pending& rhs) {
+              return lhs.range.code_index < rhs.range.code_index;
+            });
+  for (const auto& item : pending) {
+    item.worker->errors.ReplayTo(context->errors, item.range.begin,
+                                 item.range.end);
+  }
+  pending_codes.clear();
+
+  if (arenas) {
+    for (auto& worker : workers) {
+      if (worker) {
+        arenas->push_back(std::move(worker->arena));
+      }
+    }
+  }
+}
+
+}  // namespace
+
+Module ReadModuleEager(SpanU8 data,
+                       const Features& features,
+                       Errors& errors,
+                       ThreadPool* thread_pool) {
+  Module module;
+  auto lazy_module = ReadModule(data, features, errors);
+  EagerVisitor visitor{module, thread_pool, nullptr};
+  visit::Visit(lazy_module, visitor);
+  return module;
+}
+
+ArenaModule& ArenaModule::operator=(ArenaModule&& rhs) {
+  // Drop the old module before the arenas it was allocated from.
+  module = std::move(rhs.module);
+  arenas_ = std::move(rhs.arenas_);
+  return *this;
+}
+
+size_t ArenaModule::bytes_allocated() const {
+  size_t bytes = 0;
+  for (const auto& arena : arenas_) {
+    bytes += arena->bytes_allocated();
+  }
+  return bytes;
+}
+
+ArenaModule ReadArenaModuleEager(SpanU8 data,
+                                 const Features& features,
+                                 Errors& errors,
+                                 ThreadPool* thread_pool) {
+  ArenaModule result;
+  auto lazy_module = ReadModule(data, features, errors);
+  EagerVisitor visitor{result.module, thread_pool, &result.arenas_};
+  visit::Visit(lazy_module, visitor);
+  return result;
+}
+
+}  // namespace wasp::binary
@@ -256,24 +256,7 @@ optional<::wasp::Null> Null::Decode(u8 val) {
 
 // static
 bool Opcode::IsPrefixByte(u8 code, const Features& features) {
-  switch (code) {
-    case GcPrefix:
-      return features.gc_enabled();
-
-    case MiscPrefix:
-      return features.saturating_float_to_int_enabled() ||
-             features.bulk_memory_enabled() ||
-             features.reference_types_enabled();
-
-    case SimdPrefix:
-      return features.simd_enabled();
-
-    case ThreadsPrefix:
-      return features.threads_enabled();
-
-    default:
-      return false;
-  }
+  return IsPrefixByte<Features>(code, features);
 }
 
 // static
@@ -298,52 +281,14 @@ EncodedOpcode Opcode::Encode(::wasp::Opcode decoded) {
 
 // static
 optional<::wasp::Opcode> Opcode::Decode(u8 code, const Features& features) {
-  switch (code) {
-#define WASP_V(prefix, code, Name, str) \
-  case code:                            \
-    return ::wasp::Opcode::Name;
-#define WASP_FEATURE_V(prefix, code, Name, str, feature) \
-  case code:                                             \
-    if (features.feature##_enabled()) {                  \
-      return ::wasp::Opcode::Name;                       \
-    }                                                    \
-    break;
-#define WASP_PREFIX_V(...) /* Invalid. */
-#include "wasp/base/inc/opcode.inc"
-#undef WASP_V
-#undef WASP_FEATURE_V
-#undef WASP_PREFIX_V
-    default:
-      break;
-  }
-  return nullopt;
-}
-
-constexpr u64 MakePrefixCode(u8 prefix, u32 code) {
-  return (u64{prefix} << 32) | code;
+  return Decode<Features>(code, features);
 }
 
 // static
 optional<::wasp::Opcode> Opcode::Decode(u8 prefix,
                                         u32 code,
                                         const Features& features) {
-  switch (MakePrefixCode(prefix, code)) {
-#define WASP_V(...) /* Invalid. */
-#define WASP_FEATURE_V(...) /* Invalid. */
-#define WASP_PREFIX_V(prefix, code, Name, str, feature) \
-  case MakePrefixCode(prefix, code):                    \
-    if (features.feature##_enabled()) {                 \
-      return ::wasp::Opcode::Name;                      \
-    }                                                   \
-    break;
-#include "wasp/base/inc/opcode.inc"
-#undef WASP_V
-#undef WASP_FEATURE_V
-#undef WASP_PREFIX_V
-    default:
-      break;
-  }
-  return nullopt;
+  return Decode<Features>(prefix, code, features);
 }
 
 // static
@@ -0,0 +1,348 @@
+//
+// Copyright 2020 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "wasp/binary/flat_expression.h"
+
+#include <cassert>
+#include <cstring>
+
+#include "wasp/base/features.h"
+#include "wasp/binary/encoding.h"
+#include "wasp/binary/read.h"
+#include "wasp/binary/read/context.h"
+#include "wasp/binary/read/read_var_int.h"
+
+namespace wasp::binary {
+
+namespace {
+
+u64 Pack(u32 low, u32 high) {
+  return u64{low} | (u64{high} << 32);
+}
+
+template <typename T>
+bool DecodeVarInt(SpanU8* data, T* out) {
+  int length = DecodeVarIntFast(*data, out);
+  data->remove_prefix(length);
+  return length != 0;
+}
+
+template <typename T>
+bool DecodeFixed(SpanU8* data, T* out) {
+  if (data->size() < sizeof(T)) {
+    return false;
+  }
+  memcpy(out, data->data(), sizeof(T));
+  data->remove_prefix(sizeof(T));
+  return true;
+}
+
+// Decodes the most common instructions without constructing an Instruction.
+// Returns false if the instruction must be read with Read<Instruction>
+// instead, either because it isn't handled here or because it is malformed
+// (so Read<Instruction> can report the error.)
+template <typename FeaturesT>
+bool DecodeCommonInstruction(SpanU8* data,
+                             const FeaturesT& features,
+                             FlatInstruction* out) {
+  const u8 byte = data->front();
+  if (encoding::Opcode::IsPrefixByte(byte, features)) {
+    return false;
+  }
+  auto opcode = encoding::Opcode::Decode(byte, features);
+  if (!opcode) {
+    return false;
+  }
+
+  SpanU8 rest = data->subspan(1);
+  u64 immediate = 0;
+  switch (*opcode) {
+    case Opcode::Unreachable:
+    case Opcode::Nop:
+    case Opcode::Return:
+    case Opcode::Drop:
+    case Opcode::Select:
+      break;
+
+    case Opcode::Br:
+    case Opcode::BrIf:
+    case Opcode::Call:
+    case Opcode::LocalGet:
+    case Opcode::LocalSet:
+    case Opcode::LocalTee:
+    case Opcode::GlobalGet:
+    case Opcode::GlobalSet: {
+      Index index;
+      if (!DecodeVarInt(&rest, &index)) {
+        return false;
+      }
+      immediate = index;
+      break;
+    }
+
+    case Opcode::I32Const: {
+      s32 value;
+      if (!DecodeVarInt(&rest, &value)) {
+        return false;
+      }
+      immediate = static_cast<u32>(value);
+      break;
+    }
+
+    case Opcode::I64Const: {
+      s64 value;
+      if (!DecodeVarInt(&rest, &value)) {
+        return false;
+      }
+      immediate = static_cast<u64>(value);
+      break;
+    }
+
+    case Opcode::F32Const: {
+      u32 bits;
+      if (!DecodeFixed(&rest, &bits)) {
+        return false;
+      }
+      immediate = bits;
+      break;
+    }
+
+    case Opcode::F64Const:
+      if (!DecodeFixed(&rest, &immediate)) {
+        return false;
+      }
+      break;
+
+    case Opcode::I32Load:
+    case Opcode::I64Load:
+    case Opcode::F32Load:
+    case Opcode::F64Load:
+    case Opcode::I32Load8S:
+    case Opcode::I32Load8U:
+    case Opcode::I32Load16S:
+    case Opcode::I32Load16U:
+    case Opcode::I64Load8S:
+    case Opcode::I64Load8U:
+    case Opcode::I64Load16S:
+    case Opcode::I64Load16U:
+    case Opcode::I64Load32S:
+    case Opcode::I64Load32U:
+    case Opcode::I32Store:
+    case Opcode::I64Store:
+    case Opcode::F32Store:
+    case Opcode::F64Store:
+    case Opcode::I32Store8:
+    case Opcode::I32Store16:
+    case Opcode::I64Store8:
+    case Opcode::I64Store16:
+    case Opcode::I64Store32: {
+      u32 align_log2, offset;
+      if (!(DecodeVarInt(&rest, &align_log2) &&
+            DecodeVarInt(&rest, &offset))) {
+        return false;
+      }
+      immediate = Pack(align_log2, offset);
+      break;
+    }
+
+    default:
+      // The single-byte numeric instructions (from i32.eqz to
+      // i64.extend32_s) have no immediates.
+      if (byte >= 0x45 && byte <= 0xc4) {
+        break;
+      }
+      return false;
+  }
+
+  out->opcode = *opcode;
+  out->immediate = immediate;
+  *data = rest;
+  return true;
+}
+
+u64 GetImmediate(const Instruction& instr,
+                 std::vector<Index>* br_table_targets) {
+  switch (instr.kind()) {
+    case InstructionKind::S32:
+      return static_cast<u32>(*instr.s32_immediate());
+
+    case InstructionKind::S64:
+      return static_cast<u64>(*instr.s64_immediate());
+
+    case InstructionKind::F32: {
+      u32 bits;
+      memcpy(&bits, &*instr.f32_immediate(), sizeof(bits));
+      return bits;
+    }
+
+    case InstructionKind::F64: {
+      u64 bits;
+      memcpy(&bits, &*instr.f64_immediate(), sizeof(bits));
+      return bits;
+    }
+
+    case InstructionKind::Index:
+      return *instr.index_immediate();
+
+    case InstructionKind::FuncBind:
+      return *instr.func_bind_immediate()->index;
+
+    case InstructionKind::SimdLane:
+      return *instr.simd_lane_immediate();
+
+    case InstructionKind::MemArg: {
+      const auto& immediate = *instr.mem_arg_immediate();
+      return Pack(immediate.align_log2, immediate.offset);
+    }
+
+    case InstructionKind::CallIndirect: {
+      const auto& immediate = *instr.call_indirect_immediate();
+      return Pack(immediate.index, immediate.table_index);
+    }
+
+    case InstructionKind::Copy: {
+      const auto& immediate = *instr.copy_immediate();
+      return Pack(immediate.dst_index, immediate.src_index);
+    }
+
+    case InstructionKind::Init: {
+      const auto& immediate = *instr.init_immediate();
+      return Pack(immediate.segment_index, immediate.dst_index);
+    }
+
+    case InstructionKind::BrOnExn: {
+      const auto& immediate = *instr.br_on_exn_immediate();
+      return Pack(immediate.target, immediate.event_index);
+    }
+
+    case InstructionKind::StructField: {
+      const auto& immediate = *instr.struct_field_immediate();
+      return Pack(immediate.struct_, immediate.field);
+    }
+
+    case InstructionKind::BrTable: {
+      const auto& immediate = *instr.br_table_immediate();
+      auto begin = static_cast<u32>(br_table_targets->size());
+      for (auto target : immediate.targets) {
+        br_table_targets->push_back(target);
+      }
+      br_table_targets->push_back(immediate.default_target);
+      return Pack(begin, static_cast<u32>(immediate.targets.size() + 1));
+    }
+
+    default:
+      return 0;
+  }
+}
+
+template <typename FeaturesT>
+FlatExpression ReadFlatExpressionImpl(SpanU8 data,
+                                      Context& context,
+                                      const FeaturesT& features) {
+  // Same as ReadExpression.
+  context.seen_final_end = false;
+
+  FlatExpression result;
+  SpanU8 rest = data;
+  span_extent_t end = 0;
+  while (!rest.empty()) {
+    FlatInstruction flat;
+    flat.offset = static_cast<u32>(rest.begin() - data.begin());
+    if (context.seen_final_end ||
+        !DecodeCommonInstruction(&rest, features, &flat)) {
+      auto instr = Read<Instruction>(&rest, context);
+      if (!instr) {
+        break;
+      }
+      flat.opcode = (*instr)->opcode;
+      flat.immediate = GetImmediate(**instr, &result.br_table_targets);
+    }
+    result.instructions.push_back(flat);
+    end = rest.begin() - data.begin();
+  }
+  // Only keep the decoded bytes, so the last instruction ends at the end of
+  // `data`.
+  result.data = data.first(end);
+  return result;
+}
+
+template <Features::Bits kBits>
+FlatExpression ReadFlatExpressionStatic(SpanU8 data, Context& context) {
+  assert(context.features.bits() == kBits);
+  return ReadFlatExpressionImpl(data, context, StaticFeatures<kBits>{});
+}
+
+}  // namespace
+
+SpanU8 FlatExpression::GetInstructionData(Index index) const {
+  assert(index < size());
+  u32 begin = instructions[index].offset;
+  u32 end = index + 1 < size() ? instructions[index + 1].offset
+                               : static_cast<u32>(data.size());
+  return data.subspan(begin, end - begin);
+}
+
+span<const Index> FlatExpression::GetBrTableTargets(
+    const FlatInstruction& instr) const {
+  assert(instr.opcode == Opcode::BrTable);
+  return span<const Index>{br_table_targets.data() + instr.low_immediate(),
+                           instr.high_immediate()};
+}
+
+OptAt<Instruction> FlatExpression::ToInstruction(Index index,
+                                                 Context& context) const {
+  SpanU8 instr_data = GetInstructionData(index);
+  const Opcode opcode = instructions[index].opcode;
+  switch (opcode) {
+    // These have no immediates, and can't be read on their own since
+    // Read<Instruction> checks them against the enclosing blocks.
+    case Opcode::Else:
+    case Opcode::End:
+    case Opcode::Catch:
+      return At{instr_data, Instruction{At{instr_data.first(1), opcode}}};
+
+    default: {
+      // Read with a separate context, so the block state of `context` isn't
+      // changed.
+      Context read_context{context.features, context.errors};
+      read_context.declared_data_count = context.declared_data_count;
+      return Read<Instruction>(&instr_data, read_context);
+    }
+  }
+}
+
+FlatExpression ReadFlatExpression(SpanU8 data, Context& context) {
+  return ReadFlatExpressionImpl(data, context, context.features);
+}
+
+FlatExpression ReadFlatExpression(Expression expr, Context& context) {
+  return ReadFlatExpression(expr.data, context);
+}
+
+ReadFlatExpressionFunction GetReadFlatExpression(const Features& features) {
+  switch (features.bits()) {
+    case Features::kDefaultBits:
+      return ReadFlatExpressionStatic<Features::kDefaultBits>;
+
+    case Features::kAllBits:
+      return ReadFlatExpressionStatic<Features::kAllBits>;
+
+    default:
+      return static_cast<ReadFlatExpressionFunction>(ReadFlatExpression);
+  }
+}
+
+}  // namespace wasp::binary
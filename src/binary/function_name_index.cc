@@ -0,0 +1,68 @@
+//
+// Copyright 2020 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "wasp/binary/function_name_index.h"
+
+#include "wasp/binary/lazy_module.h"
+#include "wasp/binary/lazy_module_utils.h"
+
+namespace wasp::binary {
+
+FunctionNameIndex::FunctionNameIndex(Index function_count)
+    : names_(function_count) {}
+
+auto FunctionNameIndex::GetName(Index index) const -> optional<string_view> {
+  if (index < names_.size()) {
+    return names_[index];
+  }
+  auto iter = sparse_names_.find(index);
+  if (iter == sparse_names_.end()) {
+    return nullopt;
+  }
+  return iter->second;
+}
+
+auto FunctionNameIndex::GetIndex(string_view name) const -> optional<Index> {
+  auto iter = indexes_.find(name);
+  if (iter == indexes_.end()) {
+    return nullopt;
+  }
+  return iter->second;
+}
+
+void FunctionNameIndex::Insert(Index index, string_view name) {
+  if (index < names_.size()) {
+    if (!names_[index]) {
+      names_[index] = name;
+    }
+  } else {
+    sparse_names_.emplace(index, name);
+  }
+  indexes_.emplace(name, index);
+}
+
+auto ReadFunctionNameIndex(LazyModule& module) -> FunctionNameIndex {
+  Index function_count =
+      GetImportCount(module, ExternalKind::Function) +
+      module.section_directory().GetCount(SectionId::Function).value_or(0);
+  FunctionNameIndex index{function_count};
+  ForEachFunctionName(module, [&](const IndexNamePair& pair) {
+    index.Insert(pair.first, pair.second);
+  });
+  return index;
+}
+
+}  // namespace wasp::binary
@@ -16,6 +16,7 @@
 
 #include "wasp/binary/lazy_module.h"
 
+#include "wasp/base/errors_nop.h"
 #include "wasp/base/formatters.h"
 #include "wasp/binary/encoding.h"  // XXX
 #include "wasp/binary/read.h"
@@ -30,12 +31,85 @@ constexpr SpanU8 kVersionSpan{encoding::Version};
 }  // namespace
 
 LazyModule::LazyModule(SpanU8 data, const Features& features, Errors& errors)
-    : data{data},
+    : location_base_{data},
+      data{data},
       context{features, errors},
       magic{ReadBytesExpected(&data, kMagicSpan, context, "magic")},
       version{ReadBytesExpected(&data, kVersionSpan, context, "version")},
       sections{data, context} {}
 
+auto LazyModule::section_directory() -> const SectionDirectory& {
+  if (!section_directory_) {
+    section_directory_ = SectionDirectory{};
+    if (!(magic && version)) {
+      return *section_directory_;
+    }
+
+    // Scan with a separate context, so section errors (e.g. ordering) aren't
+    // reported twice, and so `context` is left untouched for iterating
+    // `sections`.
+    ErrorsNop errors_nop;
+    Context find_context{context.features, errors_nop};
+    section_directory_ = ReadSectionDirectory(
+        data.subspan(magic->size() + version->size()), find_context);
+  }
+  return *section_directory_;
+}
+
+auto LazyModule::code_section_index() -> const CodeSectionIndex& {
+  if (!code_section_index_) {
+    code_section_index_ = CodeSectionIndex{};
+    if (auto known = section_directory().GetKnownSection(SectionId::Code)) {
+      code_section_index_ = ReadCodeSectionIndex(*known, context);
+    }
+  }
+  return *code_section_index_;
+}
+
+auto LazyModule::function_name_index() -> const FunctionNameIndex& {
+  if (!function_name_index_) {
+    function_name_index_ = ReadFunctionNameIndex(*this);
+  }
+  return *function_name_index_;
+}
+
+#define WASP_SECTION_ACCESSOR(name, Name)                             \
+  auto LazyModule::name() -> optional<Lazy##Name##Section> {         \
+    if (auto known =                                                 \
+            section_directory().GetKnownSection(SectionId::Name)) {  \
+      return Read##Name##Section(*known, context);                   \
+    }                                                                \
+    return nullopt;                                                  \
+  }
+
+WASP_SECTION_ACCESSOR(type_section, Type)
+WASP_SECTION_ACCESSOR(import_section, Import)
+WASP_SECTION_ACCESSOR(function_section, Function)
+WASP_SECTION_ACCESSOR(table_section, Table)
+WASP_SECTION_ACCESSOR(memory_section, Memory)
+WASP_SECTION_ACCESSOR(global_section, Global)
+WASP_SECTION_ACCESSOR(event_section, Event)
+WASP_SECTION_ACCESSOR(export_section, Export)
+WASP_SECTION_ACCESSOR(element_section, Element)
+WASP_SECTION_ACCESSOR(code_section, Code)
+WASP_SECTION_ACCESSOR(data_section, Data)
+
+#undef WASP_SECTION_ACCESSOR
+
+auto LazyModule::start_section() -> StartSection {
+  if (auto known = section_directory().GetKnownSection(SectionId::Start)) {
+    return ReadStartSection(*known, context);
+  }
+  return nullopt;
+}
+
+auto LazyModule::data_count_section() -> DataCountSection {
+  if (auto known = section_directory().GetKnownSection(SectionId::DataCount)) {
+    return ReadDataCountSection(*known, context);
+  }
+  return nullopt;
+}
+
 LazyModule ReadModule(SpanU8 data, const Features& features, Errors& errors) {
   return LazyModule{data, features, errors};
 }
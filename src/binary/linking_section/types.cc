@@ -88,7 +88,11 @@ const SymbolInfo::Section& SymbolInfo::section() const {
 
 optional<string_view> SymbolInfo::name() const {
   if (is_base()) {
-    return base().name.value();
+    // Undefined symbols without an explicit name take the import's name.
+    if (!base().name) {
+      return nullopt;
+    }
+    return base().name->value();
   } else if (is_data()) {
     return data().name.value();
   } else {
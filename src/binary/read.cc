@@ -91,7 +91,8 @@ OptAt<BrTableImmediate> Read(SpanU8* data,
                              Tag<BrTableImmediate>) {
   ErrorsContextGuard error_guard{context.errors, *data, "br_table"};
   LocationGuard guard{data};
-  WASP_TRY_READ(targets, ReadVector<Index>(data, context, "targets"));
+  WASP_TRY_READ(targets, (ReadVector<Index, BrTableTargetList>(
+                             data, context, "targets")));
   WASP_TRY_READ(default_target, ReadIndex(data, context, "default target"));
   return At{guard.range(data),
             BrTableImmediate{std::move(targets), default_target}};
@@ -477,10 +478,10 @@ OptAt<Function> Read(SpanU8* data, Context& context, Tag<Function>) {
 OptAt<FunctionType> Read(SpanU8* data, Context& context, Tag<FunctionType>) {
   ErrorsContextGuard error_guard{context.errors, *data, "function type"};
   LocationGuard guard{data};
-  WASP_TRY_READ(param_types,
-                ReadVector<ValueType>(data, context, "param types"));
-  WASP_TRY_READ(result_types,
-                ReadVector<ValueType>(data, context, "result types"));
+  WASP_TRY_READ(param_types, (ReadVector<ValueType, ValueTypeList>(
+                                 data, context, "param types")));
+  WASP_TRY_READ(result_types, (ReadVector<ValueType, ValueTypeList>(
+                                  data, context, "result types")));
   return At{guard.range(data),
             FunctionType{std::move(param_types), std::move(result_types)}};
 }
@@ -1209,10 +1210,12 @@ OptAt<Instruction> Read(SpanU8* data, Context& context, Tag<Instruction>) {
     // Select immediate.
     case Opcode::SelectT: {
       LocationGuard immediate_guard{data};
-      WASP_TRY_READ(immediate, ReadVector<ValueType>(data, context, "types"));
+      WASP_TRY_READ(immediate, (ReadVector<ValueType, SelectImmediate>(
+                                   data, context, "types")));
       return At{
           guard.range(data),
-          Instruction{opcode, At{immediate_guard.range(data), immediate}}};
+          Instruction{opcode,
+                      At{immediate_guard.range(data), std::move(immediate)}}};
     }
 
     // u8 immediate.
@@ -1237,7 +1240,7 @@ OptAt<Instruction> Read(SpanU8* data, Context& context, Tag<Instruction>) {
     // Let immediate.
     case Opcode::Let: {
       WASP_TRY_READ(immediate, Read<LetImmediate>(data, context));
-      return At{guard.range(data), Instruction{opcode, immediate}};
+      return At{guard.range(data), Instruction{opcode, std::move(immediate)}};
     }
 
     // StructField immediate.
@@ -1354,7 +1357,7 @@ OptAt<LetImmediate> Read(SpanU8* data, Context& context, Tag<LetImmediate>) {
   WASP_TRY_READ_CONTEXT(block_type, Read<BlockType>(data, context),
                         "block_type");
   WASP_TRY_READ(locals, ReadVector<Locals>(data, context, "locals vector"));
-  return At{guard.range(data), LetImmediate{block_type, locals}};
+  return At{guard.range(data), LetImmediate{block_type, std::move(locals)}};
 }
 
 OptAt<MemArgImmediate> Read(SpanU8* data,
@@ -1620,8 +1623,8 @@ OptAt<ValueType> Read(SpanU8* data, Context& context, Tag<ValueType>) {
 
 bool EndCode(SpanU8 data, Context& context) {
   if (!context.open_blocks.empty()) {
-    for (auto& [loc, op] : context.open_blocks) {
-      context.errors.OnError(loc, concat("Unclosed ", op, " instruction"));
+    for (const auto& op : context.open_blocks) {
+      context.errors.OnError(op.loc(), concat("Unclosed ", op, " instruction"));
     }
     return false;
   }
@@ -0,0 +1,120 @@
+//
+// Copyright 2020 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "wasp/binary/section_directory.h"
+
+#include <utility>
+
+#include "wasp/binary/lazy_sequence.h"
+#include "wasp/binary/read.h"
+#include "wasp/binary/read/context.h"
+
+namespace wasp::binary {
+
+namespace {
+
+bool IsVectorSection(SectionId id) {
+  switch (id) {
+    case SectionId::Custom:
+    case SectionId::Start:
+    case SectionId::DataCount:
+      return false;
+
+    default:
+      return true;
+  }
+}
+
+}  // namespace
+
+auto SectionDirectory::Find(SectionId id) const -> optional<Entry> {
+  auto index = static_cast<size_t>(id);
+  if (index >= known_sections_.size()) {
+    return nullopt;
+  }
+  return known_sections_[index];
+}
+
+auto SectionDirectory::GetKnownSection(SectionId id) const
+    -> optional<KnownSection> {
+  auto entry = Find(id);
+  if (!entry) {
+    return nullopt;
+  }
+  return KnownSection{id, entry->data};
+}
+
+auto SectionDirectory::GetCount(SectionId id) const -> optional<Index> {
+  auto entry = Find(id);
+  if (!entry) {
+    return nullopt;
+  }
+  return entry->count;
+}
+
+auto SectionDirectory::FindCustom(string_view name) const
+    -> optional<CustomEntry> {
+  for (const auto& entry : custom_sections_) {
+    if (entry.name == name) {
+      return entry;
+    }
+  }
+  return nullopt;
+}
+
+auto SectionDirectory::GetCustomSection(string_view name) const
+    -> optional<CustomSection> {
+  auto entry = FindCustom(name);
+  if (!entry) {
+    return nullopt;
+  }
+  return CustomSection{entry->name, entry->data};
+}
+
+void SectionDirectory::Add(SectionId id, Entry entry) {
+  auto index = static_cast<size_t>(id);
+  if (index < known_sections_.size() && !known_sections_[index]) {
+    known_sections_[index] = entry;
+  }
+}
+
+void SectionDirectory::AddCustom(CustomEntry entry) {
+  custom_sections_.push_back(entry);
+}
+
+auto ReadSectionDirectory(SpanU8 data, Context& context) -> SectionDirectory {
+  SectionDirectory directory;
+  for (auto section : LazySequence<Section>{data, context}) {
+    if (section->is_known()) {
+      auto known = section->known();
+      optional<Index> count;
+      if (IsVectorSection(known->id)) {
+        SpanU8 copy = known->data;
+        if (auto count_opt = ReadCount(&copy, context)) {
+          count = count_opt->value();
+        }
+      }
+      directory.Add(known->id, SectionDirectory::Entry{known->data, count});
+    } else if (section->is_custom()) {
+      auto custom = section->custom();
+      directory.AddCustom(
+          SectionDirectory::CustomEntry{custom->name, custom->data});
+    }
+  }
+  return directory;
+}
+
+}  // namespace wasp::binary
@@ -0,0 +1,228 @@
+//
+// Copyright 2020 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "wasp/binary/streaming_module_reader.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+
+#include "wasp/base/concat.h"
+#include "wasp/base/errors.h"
+#include "wasp/binary/encoding.h"
+#include "wasp/binary/read.h"
+
+namespace wasp::binary {
+
+namespace {
+
+const u8 kEmptyCodeSection[] = {
+    static_cast<u8>(encoding::SectionId::Encode(SectionId::Code)), 0};
+
+// The offset of `loc` in the module, if it is within `data`, which starts at
+// `module_offset`.
+auto OffsetIn(Location loc, SpanU8 data, u64 module_offset) -> optional<u64> {
+  auto begin = reinterpret_cast<uintptr_t>(loc.data());
+  auto data_begin = reinterpret_cast<uintptr_t>(data.data());
+  if (data.data() == nullptr || begin < data_begin ||
+      loc.size() > data.size() ||
+      begin - data_begin > data.size() - loc.size()) {
+    return nullopt;
+  }
+  return module_offset + (begin - data_begin);
+}
+
+}  // namespace
+
+StreamingErrors::StreamingErrors(Errors& errors) : errors_{errors} {}
+
+auto StreamingErrors::module_offset(Location loc) const -> optional<size_t> {
+  for (const auto& [key, copy] : copies_) {
+    auto [offset, size] = key;
+    if (auto loc_offset = OffsetIn(loc, SpanU8{copy.data(), size}, offset)) {
+      return static_cast<size_t>(*loc_offset);
+    }
+  }
+  return nullopt;
+}
+
+void StreamingErrors::HandleOnError(Location loc, string_view message) {
+  for (const auto& item : context()) {
+    errors_.PushContext(Rebase(item.loc), item.desc);
+  }
+  errors_.OnError(Rebase(loc), message);
+  for (size_t i = 0; i < context().size(); ++i) {
+    errors_.PopContext();
+  }
+}
+
+auto StreamingErrors::Rebase(Location loc) -> Location {
+  optional<u64> offset;
+  if (reader_ && loc.data() != nullptr) {
+    offset = reader_->ModuleOffset(loc);
+  }
+  if (!offset) {
+    // Not one of the reader's locations.
+    return loc;
+  }
+  auto [iter, inserted] = copies_.try_emplace(
+      std::make_pair(static_cast<size_t>(*offset), loc.size()));
+  Buffer& copy = iter->second;
+  if (inserted) {
+    // Reserve at least one byte, so an empty location has a distinct address.
+    copy.reserve(std::max<size_t>(loc.size(), 1));
+    copy.assign(loc.begin(), loc.end());
+  }
+  return Location{copy.data(), loc.size()};
+}
+
+StreamingModuleReaderBase::StreamingModuleReaderBase(const Features& features,
+                                                     StreamingErrors& errors)
+    : features_{features}, errors_{errors} {
+  assert(errors_.reader_ == nullptr);
+  errors_.reader_ = this;
+}
+
+StreamingModuleReaderBase::~StreamingModuleReaderBase() {
+  errors_.reader_ = nullptr;
+}
+
+u8 StreamingModuleReaderBase::PeekByte(SpanU8 input, size_t offset) const {
+  if (offset < buffer_.size()) {
+    return buffer_[offset];
+  }
+  return input[offset - buffer_.size()];
+}
+
+auto StreamingModuleReaderBase::PeekVarU32(SpanU8 input,
+                                           size_t offset,
+                                           size_t max_length) const
+    -> optional<VarU32> {
+  u64 value = 0;
+  for (size_t i = 0; i < max_length; ++i) {
+    size_t pos = offset + i;
+    if (pos >= buffer_.size() + input.size()) {
+      return nullopt;
+    }
+    u8 byte = PeekByte(input, pos);
+    value |= u64{byte & 0x7fu} << (7 * i);
+    if ((byte & 0x80) == 0) {
+      return VarU32{i + 1, value, value <= 0xffffffffu};
+    }
+  }
+  return VarU32{max_length, value, false};
+}
+
+auto StreamingModuleReaderBase::TakeItem(SpanU8* input, size_t size)
+    -> optional<SpanU8> {
+  if (buffer_.empty() && input->size() >= size) {
+    item_ = input->first(size);
+    item_offset_ = consumed_;
+    input->remove_prefix(size);
+    consumed_ += size;
+    return item_;
+  }
+
+  size_t count = std::min(size - buffer_.size(), input->size());
+  buffer_.insert(buffer_.end(), input->begin(), input->begin() + count);
+  input->remove_prefix(count);
+  consumed_ += count;
+  if (buffer_.size() < size) {
+    return nullopt;
+  }
+  item_ = SpanU8{buffer_};
+  item_offset_ = consumed_ - size;
+  return item_;
+}
+
+void StreamingModuleReaderBase::BufferInput(SpanU8* input) {
+  buffer_.insert(buffer_.end(), input->begin(), input->end());
+  consumed_ += input->size();
+  input->remove_prefix(input->size());
+}
+
+void StreamingModuleReaderBase::ClearItem() {
+  buffer_.clear();
+  item_ = {};
+}
+
+auto StreamingModuleReaderBase::KeepCode(SpanU8 item) -> SpanU8 {
+  kept_code_.push_back(KeptCode{ToBuffer(item), item_offset_});
+  return kept_code_.back().data;
+}
+
+void StreamingModuleReaderBase::ReleaseKeptCode(size_t count) {
+  while (kept_code_.size() > count) {
+    kept_code_.pop_front();
+  }
+}
+
+void StreamingModuleReaderBase::StartModule(SpanU8 header) {
+  auto size = std::min(header.size(), header_.size());
+  std::copy(header.begin(), header.begin() + size, header_.begin());
+  module_.emplace(SpanU8{header_.data(), size}, features_, errors_);
+}
+
+auto StreamingModuleReaderBase::ReadEmptyCodeSection() -> OptAt<Section> {
+  SpanU8 data = kEmptyCodeSection;
+  return Read<Section>(&data, module_->context);
+}
+
+void StreamingModuleReaderBase::SkipRestOfSection() {
+  state_ = section_remaining_ == 0 ? State::SectionHeader : State::SkipSection;
+}
+
+void StreamingModuleReaderBase::DropInput(SpanU8* input) {
+  auto count =
+      static_cast<size_t>(std::min<u64>(section_remaining_, input->size()));
+  input->remove_prefix(count);
+  consumed_ += count;
+  section_remaining_ -= count;
+  if (section_remaining_ == 0) {
+    state_ = State::SectionHeader;
+  }
+}
+
+void StreamingModuleReaderBase::CheckCodeCount(SpanU8 section_end) {
+  if (code_count_ && codes_read_ != code_count_->value()) {
+    errors_.OnError(section_end,
+                    concat("Expected code section to have count ",
+                           *code_count_, ", got ", codes_read_));
+  }
+}
+
+auto StreamingModuleReaderBase::ModuleOffset(Location loc) const
+    -> optional<u64> {
+  if (auto offset = OffsetIn(loc, item_, item_offset_)) {
+    return offset;
+  } else if (auto offset =
+                 OffsetIn(loc, buffer_, consumed_ - buffer_.size())) {
+    return offset;
+  } else if (auto offset = OffsetIn(loc, header_, 0)) {
+    return offset;
+  } else if (auto offset =
+                 OffsetIn(loc, kEmptyCodeSection, code_section_offset_)) {
+    return offset;
+  }
+  for (const auto& kept : kept_code_) {
+    if (auto offset = OffsetIn(loc, kept.data, kept.module_offset)) {
+      return offset;
+    }
+  }
+  return nullopt;
+}
+
+}  // namespace wasp::binary
@@ -16,6 +16,8 @@
 
 #include "wasp/binary/types.h"
 
+#include <utility>
+
 #include "wasp/base/hash.h"
 #include "wasp/base/macros.h"
 #include "wasp/base/operator_eq_ne_macros.h"
@@ -302,7 +304,7 @@ Instruction::Instruction(At<Opcode> opcode, At<BrOnExnImmediate> immediate)
     : opcode(opcode), immediate(immediate) {}
 
 Instruction::Instruction(At<Opcode> opcode, At<BrTableImmediate> immediate)
-    : opcode(opcode), immediate(immediate) {}
+    : opcode(opcode), immediate(std::move(immediate)) {}
 
 Instruction::Instruction(At<Opcode> opcode, At<CallIndirectImmediate> immediate)
     : opcode(opcode), immediate(immediate) {}
@@ -323,7 +325,7 @@ Instruction::Instruction(At<Opcode> opcode, At<InitImmediate> immediate)
     : opcode(opcode), immediate(immediate) {}
 
 Instruction::Instruction(At<Opcode> opcode, At<LetImmediate> immediate)
-    : opcode(opcode), immediate(immediate) {}
+    : opcode(opcode), immediate(std::move(immediate)) {}
 
 Instruction::Instruction(At<Opcode> opcode, At<MemArgImmediate> immediate)
     : opcode(opcode), immediate(immediate) {}
@@ -332,7 +334,7 @@ Instruction::Instruction(At<Opcode> opcode, At<RttSubImmediate> immediate)
     : opcode(opcode), immediate(immediate) {}
 
 Instruction::Instruction(At<Opcode> opcode, At<SelectImmediate> immediate)
-    : opcode(opcode), immediate(immediate) {}
+    : opcode(opcode), immediate(std::move(immediate)) {}
 
 Instruction::Instruction(At<Opcode> opcode, At<SimdLaneImmediate> immediate)
     : opcode(opcode), immediate(immediate) {}
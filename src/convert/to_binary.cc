@@ -385,8 +385,12 @@ auto ToBinary(Context& context, const At<text::BrOnExnImmediate>& value)
 
 auto ToBinary(Context& context, const At<text::BrTableImmediate>& value)
     -> At<binary::BrTableImmediate> {
+  binary::BrTableTargetList targets;
+  for (auto var : value->targets) {
+    targets.push_back(ToBinary(context, var));
+  }
   return At{value.loc(),
-            binary::BrTableImmediate{ToBinary(context, value->targets),
+            binary::BrTableImmediate{std::move(targets),
                                      ToBinary(context, value->default_target)}};
 }
 
@@ -155,6 +155,15 @@ auto ToText(TextContext& context, const binary::IndexList& values)
   return result;
 }
 
+auto ToText(TextContext& context, const binary::BrTableTargetList& values)
+    -> text::VarList {
+  text::VarList result;
+  for (auto value : values) {
+    result.push_back(ToText(context, value));
+  }
+  return result;
+}
+
 auto ToText(TextContext& context, const At<binary::FunctionType>& value)
     -> At<text::FunctionType> {
   return At{value.loc(),
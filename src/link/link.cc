@@ -0,0 +1,1127 @@
+//
+// Copyright 2020 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "wasp/link/link.h"
+
+#include <algorithm>
+#include <cassert>
+#include <iterator>
+#include <memory>
+#include <utility>
+
+#include "wasp/base/compact_location.h"
+#include "wasp/base/concat.h"
+#include "wasp/base/enumerate.h"
+#include "wasp/base/errors.h"
+#include "wasp/base/hashmap.h"
+#include "wasp/base/string_view.h"
+#include "wasp/base/thread_pool.h"
+#include "wasp/binary/formatters.h"
+#include "wasp/binary/lazy_module.h"
+#include "wasp/binary/linking_section/formatters.h"
+#include "wasp/binary/linking_section/sections.h"
+#include "wasp/binary/write.h"
+
+namespace wasp::link {
+
+namespace {
+
+using namespace ::wasp::binary;
+
+constexpr Index kInvalidIndex = ~Index{0};
+constexpr u32 kPageSize = 65536;
+constexpr u32 kStackAlign = 16;
+constexpr string_view kStackPointerName = "__stack_pointer";
+constexpr string_view kCallCtorsName = "__wasm_call_ctors";
+
+// Forwards errors to another Errors object, and remembers whether there were
+// any.
+class TrackingErrors : public Errors {
+ public:
+  explicit TrackingErrors(Errors& errors) : errors_{errors} {}
+
+  bool has_error() const { return error_count_ != 0; }
+  size_t error_count() const { return error_count_; }
+
+ protected:
+  void HandleOnError(Location loc, string_view message) override {
+    ++error_count_;
+    for (const auto& item : context()) {
+      errors_.PushContext(item.loc, item.desc);
+    }
+    errors_.OnError(loc, message);
+    for (size_t i = 0; i < context().size(); ++i) {
+      errors_.PopContext();
+    }
+  }
+
+ private:
+  Errors& errors_;
+  size_t error_count_ = 0;
+};
+
+bool IsLocal(const SymbolInfo& symbol) {
+  return symbol.flags->binding == SymbolInfo::Flags::Binding::Local;
+}
+
+bool IsWeak(const SymbolInfo& symbol) {
+  return symbol.flags->binding == SymbolInfo::Flags::Binding::Weak;
+}
+
+bool IsUndefined(const SymbolInfo& symbol) {
+  return symbol.flags->undefined == SymbolInfo::Flags::Undefined::Yes;
+}
+
+// The number of bytes a relocation rewrites, or 0 if the relocation type is
+// not supported.
+u32 RelocationWidth(RelocationType type) {
+  switch (type) {
+    case RelocationType::FunctionIndexLEB:
+    case RelocationType::TableIndexSLEB:
+    case RelocationType::MemoryAddressLEB:
+    case RelocationType::MemoryAddressSLEB:
+    case RelocationType::TypeIndexLEB:
+    case RelocationType::GlobalIndexLEB:
+      return 5;
+
+    case RelocationType::TableIndexI32:
+    case RelocationType::MemoryAddressI32:
+      return 4;
+
+    default:
+      return 0;
+  }
+}
+
+// Rewrites a 5-byte padded LEB128 (or a 4-byte little-endian i32) in place.
+void Patch(RelocationType type, u8* out, u32 value) {
+  switch (type) {
+    case RelocationType::TableIndexSLEB:
+    case RelocationType::MemoryAddressSLEB: {
+      s32 svalue = static_cast<s32>(value);
+      for (int i = 0; i < 4; ++i) {
+        out[i] = ((svalue >> (i * 7)) & 0x7f) | 0x80;
+      }
+      out[4] = (svalue >> 28) & 0x7f;
+      break;
+    }
+
+    case RelocationType::TableIndexI32:
+    case RelocationType::MemoryAddressI32:
+      for (int i = 0; i < 4; ++i) {
+        out[i] = (value >> (i * 8)) & 0xff;
+      }
+      break;
+
+    default:
+      for (int i = 0; i < 4; ++i) {
+        out[i] = ((value >> (i * 7)) & 0x7f) | 0x80;
+      }
+      out[4] = (value >> 28) & 0x7f;
+      break;
+  }
+}
+
+u32 AlignUp(u32 value, u32 align) {
+  return (value + align - 1) & ~(align - 1);
+}
+
+struct InputSegment {
+  SpanU8 init;
+  u32 section_offset;  // Offset of `init` in the data section.
+  u32 align_log2 = 0;
+  bool live = true;
+  u32 address = 0;
+};
+
+// A relocation section that applies to the object's code or data section.
+struct InputRelocations {
+  Index section_index;
+  std::vector<At<RelocationEntry>> entries;
+};
+
+struct Object {
+  explicit Object(SpanU8 data, const Features& features, Errors& errors)
+      : data{data}, module{ReadModule(data, features, errors)} {}
+
+  Index imported_function_count() const {
+    return static_cast<Index>(function_imports.size());
+  }
+  Index imported_global_count() const {
+    return static_cast<Index>(global_imports.size());
+  }
+
+  // The location of a value read from this object. Compact locations are
+  // relative to the newest LocationBase, which may be another object's.
+  template <typename T>
+  Location Loc(const At<T>& value) const {
+    LocationBase base{data};
+    return value.loc();
+  }
+
+  SpanU8 data;
+  LazyModule module;
+
+  std::vector<At<DefinedType>> types;
+  std::vector<At<Import>> function_imports;
+  std::vector<At<Import>> global_imports;
+  std::vector<At<Function>> functions;
+  std::vector<At<Global>> globals;
+  std::vector<InputSegment> segments;
+  std::vector<At<Code>> codes;
+  SpanU8 code_section;
+  SpanU8 data_section;
+  Index code_section_index = kInvalidIndex;
+  Index data_section_index = kInvalidIndex;
+  bool has_linking_section = false;
+  bool imports_memory = false;
+  bool imports_table = false;
+
+  std::vector<At<SymbolInfo>> symbols;
+  std::vector<At<SegmentInfo>> segment_infos;
+  std::vector<At<InitFunction>> init_functions;
+  std::vector<At<Comdat>> comdats;
+  std::vector<InputRelocations> relocations;
+
+  // Output indexes, indexed by this object's function, global and type
+  // indexes.
+  std::vector<Index> function_map;
+  std::vector<Index> global_map;
+  std::vector<Index> type_map;
+  std::vector<bool> function_live;  // Defined functions only.
+
+  // The resolved value of each symbol: a function or global index, or a
+  // data address.
+  std::vector<u32> symbol_values;
+
+  Buffer relocated_code;
+  Buffer relocated_data;
+};
+
+struct Definition {
+  Index object;
+  Index symbol;
+  SymbolInfoKind kind;
+  bool weak;
+};
+
+// A section to relocate: the code or data section of an object.
+struct RelocationTask {
+  Object* object;
+  const InputRelocations* relocations;
+  SpanU8 section;
+  Buffer* out;
+};
+
+class Linker {
+ public:
+  explicit Linker(const Features&, const LinkOptions&, Errors&, ThreadPool*);
+
+  auto Link(span<const SpanU8> objects) -> optional<Buffer>;
+
+ private:
+  void ReadObject(Object&);
+  void ReadLinkingSection(Object&, CustomSection);
+  void DiscardComdats();
+  void DefineSymbols();
+  void MapTypes();
+  void LayoutFunctions();
+  void LayoutGlobals();
+  void LayoutData();
+  void ResolveSymbols();
+  void CheckRelocations();
+  void AssignTableSlots();
+  void ApplyRelocations();
+  auto RelocationValue(const Object&, const RelocationEntry&) const -> u32;
+  auto Write() -> Buffer;
+
+  bool IsDefinedHere(const Object&, const SymbolInfo&) const;
+  auto FindDefinition(string_view name) const -> const Definition*;
+  auto SymbolName(const Object&, const SymbolInfo&) const -> string_view;
+  auto AddType(const DefinedType&) -> Index;
+
+  Features features_;
+  const LinkOptions& options_;
+  TrackingErrors errors_;
+  ThreadPool* thread_pool_;
+
+  std::vector<std::unique_ptr<Object>> objects_;
+  flat_hash_map<string_view, Definition> definitions_;
+  flat_hash_map<string_view, Index> comdat_owners_;
+
+  flat_hash_map<Buffer, Index> type_indexes_;
+  std::vector<DefinedType> types_;
+
+  flat_hash_map<string_view, Index> function_import_indexes_;
+  std::vector<Import> imports_;
+  Index imported_function_count_ = 0;
+  std::vector<Function> functions_;
+  Index call_ctors_index_ = kInvalidIndex;
+  Buffer call_ctors_body_;
+
+  flat_hash_map<string_view, Index> global_import_indexes_;
+  std::vector<Import> global_imports_;
+  std::vector<Global> globals_;
+  Index stack_pointer_index_ = kInvalidIndex;
+
+  bool has_memory_ = false;
+  u32 memory_end_ = 0;
+
+  bool has_table_ = false;
+  flat_hash_map<Index, u32> table_slots_;
+  IndexList table_functions_;
+};
+
+Linker::Linker(const Features& features,
+               const LinkOptions& options,
+               Errors& errors,
+               ThreadPool* thread_pool)
+    : features_{features},
+      options_{options},
+      errors_{errors},
+      thread_pool_{thread_pool} {}
+
+auto Linker::Link(span<const SpanU8> objects) -> optional<Buffer> {
+  for (SpanU8 data : objects) {
+    objects_.push_back(std::make_unique<Object>(data, features_, errors_));
+    ReadObject(*objects_.back());
+  }
+  if (errors_.has_error()) {
+    return nullopt;
+  }
+
+  DiscardComdats();
+  DefineSymbols();
+  MapTypes();
+  LayoutFunctions();
+  LayoutGlobals();
+  LayoutData();
+  ResolveSymbols();
+  CheckRelocations();
+  if (errors_.has_error()) {
+    return nullopt;
+  }
+
+  AssignTableSlots();
+  ApplyRelocations();
+  auto result = Write();
+  if (errors_.has_error()) {
+    return nullopt;
+  }
+  return result;
+}
+
+void Linker::ReadObject(Object& object) {
+  auto& module = object.module;
+  size_t error_count = errors_.error_count();
+  if (!(module.magic && module.version)) {
+    return;
+  }
+
+  Index section_index = 0;
+  for (auto section : module.sections) {
+    if (section->is_known()) {
+      auto known = section->known();
+      switch (known->id) {
+        case SectionId::Type:
+          for (auto type : ReadTypeSection(known, module.context).sequence) {
+            object.types.push_back(type);
+          }
+          break;
+
+        case SectionId::Import:
+          for (auto import :
+               ReadImportSection(known, module.context).sequence) {
+            switch (import->kind()) {
+              case ExternalKind::Function:
+                object.function_imports.push_back(import);
+                break;
+              case ExternalKind::Global:
+                object.global_imports.push_back(import);
+                break;
+              case ExternalKind::Memory:
+                object.imports_memory = true;
+                break;
+              case ExternalKind::Table:
+                object.imports_table = true;
+                break;
+              default:
+                errors_.OnError(import.loc(),
+                                concat("Unsupported import kind ",
+                                       import->kind()));
+                break;
+            }
+          }
+          break;
+
+        case SectionId::Function:
+          for (auto function :
+               ReadFunctionSection(known, module.context).sequence) {
+            object.functions.push_back(function);
+          }
+          break;
+
+        case SectionId::Global:
+          for (auto global :
+               ReadGlobalSection(known, module.context).sequence) {
+            object.globals.push_back(global);
+          }
+          break;
+
+        case SectionId::Code:
+          object.code_section = known->data;
+          object.code_section_index = section_index;
+          for (auto code : ReadCodeSection(known, module.context).sequence) {
+            object.codes.push_back(code);
+          }
+          break;
+
+        case SectionId::Data:
+          object.data_section = known->data;
+          object.data_section_index = section_index;
+          for (auto segment :
+               ReadDataSection(known, module.context).sequence) {
+            if (segment->type != SegmentType::Active) {
+              errors_.OnError(segment.loc(),
+                              "Passive data segments are not supported");
+              continue;
+            }
+            object.segments.push_back(InputSegment{
+                segment->init, static_cast<u32>(segment->init.data() -
+                                                known->data.data())});
+          }
+          break;
+
+        case SectionId::Table:
+        case SectionId::Memory:
+        case SectionId::Event:
+        case SectionId::Start:
+          errors_.OnError(known.loc(),
+                          concat("Unexpected ", known->id,
+                                 " section in a relocatable object"));
+          break;
+
+        default:
+          // The export and element sections are rebuilt from the symbols and
+          // relocations; the data count section is not needed.
+          break;
+      }
+    } else {
+      auto custom = section->custom();
+      if (*custom->name == "linking") {
+        ReadLinkingSection(object, custom);
+      } else if (starts_with(*custom->name, "reloc.")) {
+        auto reloc = ReadRelocationSection(custom, module.context);
+        if (reloc.section_index) {
+          object.relocations.push_back(
+              InputRelocations{*reloc.section_index,
+                               {reloc.entries.begin(), reloc.entries.end()}});
+        }
+      }
+    }
+    ++section_index;
+  }
+
+  // Don't pile on if the object couldn't be read.
+  if (!object.has_linking_section && errors_.error_count() == error_count) {
+    errors_.OnError(object.data.first(0),
+                    "Missing linking section, not a relocatable object");
+  }
+
+  for (auto&& info : enumerate(object.segment_infos)) {
+    if (info.index < object.segments.size()) {
+      object.segments[info.index].align_log2 = info.value->align_log2;
+    }
+  }
+  object.function_live.assign(object.functions.size(), true);
+}
+
+void Linker::ReadLinkingSection(Object& object, CustomSection custom) {
+  auto& context = object.module.context;
+  auto linking = binary::ReadLinkingSection(custom, context);
+  object.has_linking_section = true;
+  for (auto subsection : linking.subsections) {
+    switch (subsection->id) {
+      case LinkingSubsectionId::SegmentInfo:
+        for (auto info :
+             ReadSegmentInfoSubsection(subsection, context).sequence) {
+          object.segment_infos.push_back(info);
+        }
+        break;
+
+      case LinkingSubsectionId::InitFunctions:
+        for (auto init :
+             ReadInitFunctionsSubsection(subsection, context).sequence) {
+          object.init_functions.push_back(init);
+        }
+        break;
+
+      case LinkingSubsectionId::ComdatInfo:
+        for (auto comdat : ReadComdatSubsection(subsection, context).sequence) {
+          object.comdats.push_back(comdat);
+        }
+        break;
+
+      case LinkingSubsectionId::SymbolTable:
+        for (auto symbol :
+             ReadSymbolTableSubsection(subsection, context).sequence) {
+          if (symbol->kind() == SymbolInfoKind::Event) {
+            errors_.OnError(symbol.loc(), "Event symbols are not supported");
+          }
+          object.symbols.push_back(symbol);
+        }
+        break;
+
+      default:
+        break;
+    }
+  }
+}
+
+void Linker::DiscardComdats() {
+  for (auto&& pair : enumerate(objects_)) {
+    auto& object = *pair.value;
+    for (const auto& comdat : object.comdats) {
+      auto result = comdat_owners_.try_emplace(
+          *comdat->name, static_cast<Index>(pair.index));
+      if (result.first->second == pair.index) {
+        continue;
+      }
+      for (const auto& symbol : comdat->symbols) {
+        Index index = symbol->index;
+        if (symbol->kind == ComdatSymbolKind::Function &&
+            index >= object.imported_function_count() &&
+            index - object.imported_function_count() <
+                object.function_live.size()) {
+          object.function_live[index - object.imported_function_count()] =
+              false;
+        } else if (symbol->kind == ComdatSymbolKind::Data &&
+                   index < object.segments.size()) {
+          object.segments[index].live = false;
+        }
+      }
+    }
+  }
+}
+
+bool Linker::IsDefinedHere(const Object& object,
+                           const SymbolInfo& symbol) const {
+  if (IsUndefined(symbol)) {
+    return false;
+  }
+  switch (symbol.kind()) {
+    case SymbolInfoKind::Function: {
+      Index index = symbol.base().index;
+      return index >= object.imported_function_count() &&
+             index - object.imported_function_count() <
+                 object.function_live.size() &&
+             object.function_live[index - object.imported_function_count()];
+    }
+
+    case SymbolInfoKind::Global:
+      return symbol.base().index >= object.imported_global_count();
+
+    case SymbolInfoKind::Data: {
+      const auto& defined = symbol.data().defined;
+      return defined && defined->index < object.segments.size() &&
+             object.segments[defined->index].live;
+    }
+
+    default:
+      return false;
+  }
+}
+
+auto Linker::SymbolName(const Object& object, const SymbolInfo& symbol) const
+    -> string_view {
+  if (auto name = symbol.name()) {
+    return *name;
+  }
+  // Undefined function and global symbols without an explicit name use the
+  // name of their import.
+  Index index = symbol.base().index;
+  if (symbol.kind() == SymbolInfoKind::Function &&
+      index < object.function_imports.size()) {
+    return object.function_imports[index]->name;
+  } else if (symbol.kind() == SymbolInfoKind::Global &&
+             index < object.global_imports.size()) {
+    return object.global_imports[index]->name;
+  }
+  return {};
+}
+
+auto Linker::FindDefinition(string_view name) const -> const Definition* {
+  auto iter = definitions_.find(name);
+  return iter != definitions_.end() ? &iter->second : nullptr;
+}
+
+void Linker::DefineSymbols() {
+  for (auto&& pair : enumerate(objects_)) {
+    auto& object = *pair.value;
+    for (auto&& symbol_pair : enumerate(object.symbols)) {
+      const auto& symbol = symbol_pair.value;
+      if (symbol->is_section() || IsLocal(*symbol) ||
+          !IsDefinedHere(object, *symbol)) {
+        continue;
+      }
+
+      Definition definition{static_cast<Index>(pair.index),
+                            static_cast<Index>(symbol_pair.index),
+                            symbol->kind(), IsWeak(*symbol)};
+      string_view name = SymbolName(object, *symbol);
+      auto result = definitions_.try_emplace(name, definition);
+      if (result.second) {
+        continue;
+      }
+
+      auto& existing = result.first->second;
+      if (existing.kind != definition.kind) {
+        errors_.OnError(object.Loc(symbol),
+                        concat("Symbol ", name, " is defined as a ",
+                               definition.kind, ", previously defined as a ",
+                               existing.kind));
+      } else if (!existing.weak && !definition.weak) {
+        errors_.OnError(object.Loc(symbol), concat("Duplicate symbol ", name));
+      } else if (existing.weak && !definition.weak) {
+        existing = definition;
+      }
+    }
+  }
+}
+
+auto Linker::AddType(const DefinedType& type) -> Index {
+  Buffer key;
+  binary::Write(type, std::back_inserter(key));
+  auto result = type_indexes_.try_emplace(std::move(key), types_.size());
+  if (result.second) {
+    types_.push_back(type);
+  }
+  return result.first->second;
+}
+
+void Linker::MapTypes() {
+  for (auto& object : objects_) {
+    for (const auto& type : object->types) {
+      object->type_map.push_back(AddType(type));
+    }
+  }
+}
+
+void Linker::LayoutFunctions() {
+  auto map_type = [](const Object& object, Index type_index) {
+    return type_index < object.type_map.size() ? object.type_map[type_index]
+                                               : type_index;
+  };
+
+  // Imports come first, one for each name that is used but never defined.
+  for (auto& object : objects_) {
+    object->function_map.assign(
+        object->imported_function_count() + object->functions.size(),
+        kInvalidIndex);
+    for (const auto& symbol : object->symbols) {
+      if (symbol->kind() != SymbolInfoKind::Function ||
+          !IsUndefined(*symbol) ||
+          symbol->base().index >= object->imported_function_count()) {
+        continue;
+      }
+      string_view name = SymbolName(*object, *symbol);
+      if (FindDefinition(name) ||
+          (name == kCallCtorsName && !object->init_functions.empty())) {
+        continue;
+      }
+      const auto& import = object->function_imports[symbol->base().index];
+      auto result =
+          function_import_indexes_.try_emplace(name, imports_.size());
+      if (result.second) {
+        imports_.push_back(
+            Import{import->module, import->name,
+                   At<Index>{map_type(*object, import->index())}});
+      }
+      object->function_map[symbol->base().index] = result.first->second;
+    }
+  }
+  imported_function_count_ = static_cast<Index>(imports_.size());
+
+  Index index = imported_function_count_;
+  for (auto& object : objects_) {
+    for (auto&& function : enumerate(object->functions)) {
+      if (object->function_live[function.index]) {
+        object->function_map[object->imported_function_count() +
+                             function.index] = index++;
+        functions_.push_back(
+            Function{map_type(*object, function.value->type_index)});
+      }
+    }
+  }
+
+  // Synthesize __wasm_call_ctors, which calls each init function in priority
+  // order, unless an object defines it.
+  bool has_init_functions = false;
+  for (auto& object : objects_) {
+    has_init_functions |= !object->init_functions.empty();
+  }
+  if (has_init_functions && !FindDefinition(kCallCtorsName)) {
+    call_ctors_index_ = index++;
+    functions_.push_back(Function{AddType(DefinedType{FunctionType{}})});
+  }
+}
+
+void Linker::LayoutGlobals() {
+  bool needs_stack_pointer = false;
+  for (auto& object : objects_) {
+    object->global_map.assign(
+        object->imported_global_count() + object->globals.size(),
+        kInvalidIndex);
+    for (const auto& symbol : object->symbols) {
+      if (symbol->kind() != SymbolInfoKind::Global || !IsUndefined(*symbol) ||
+          symbol->base().index >= object->imported_global_count()) {
+        continue;
+      }
+      string_view name = SymbolName(*object, *symbol);
+      if (FindDefinition(name)) {
+        continue;
+      }
+      if (name == kStackPointerName) {
+        needs_stack_pointer = true;
+        continue;
+      }
+      const auto& import = object->global_imports[symbol->base().index];
+      auto result =
+          global_import_indexes_.try_emplace(name, global_imports_.size());
+      if (result.second) {
+        global_imports_.push_back(
+            Import{import->module, import->name, import->global_type()});
+      }
+      object->global_map[symbol->base().index] = result.first->second;
+    }
+  }
+
+  Index index = static_cast<Index>(global_imports_.size());
+  if (needs_stack_pointer) {
+    // The initial value is set once the data is laid out.
+    stack_pointer_index_ = index++;
+    globals_.push_back(Global{
+        GlobalType{ValueType::I32_NoLocation(), Mutability::Var},
+        ConstantExpression{Instruction{Opcode::I32Const, s32{0}}}});
+  }
+
+  for (auto& object : objects_) {
+    for (auto&& global : enumerate(object->globals)) {
+      for (const auto& instr : global.value->init->instructions) {
+        if (instr->opcode == Opcode::GlobalGet) {
+          errors_.OnError(object->Loc(instr),
+                          "global.get in a global initializer is not "
+                          "supported");
+        }
+      }
+      object->global_map[object->imported_global_count() + global.index] =
+          index++;
+      globals_.push_back(global.value);
+    }
+  }
+}
+
+void Linker::LayoutData() {
+  u32 address = options_.global_base;
+  bool imports_memory = false;
+  for (auto& object : objects_) {
+    imports_memory |= object->imports_memory;
+    for (auto& segment : object->segments) {
+      if (!segment.live) {
+        continue;
+      }
+      address = AlignUp(address, 1u << std::min(segment.align_log2, 16u));
+      segment.address = address;
+      address += static_cast<u32>(segment.init.size());
+    }
+  }
+
+  memory_end_ = address;
+  if (stack_pointer_index_ != kInvalidIndex) {
+    memory_end_ = AlignUp(memory_end_, kStackAlign) + options_.stack_size;
+    globals_[stack_pointer_index_ - global_imports_.size()].init =
+        ConstantExpression{
+            Instruction{Opcode::I32Const, static_cast<s32>(memory_end_)}};
+  }
+  has_memory_ = imports_memory || stack_pointer_index_ != kInvalidIndex;
+}
+
+void Linker::ResolveSymbols() {
+  for (auto& object : objects_) {
+    object->symbol_values.assign(object->symbols.size(), 0);
+    for (auto&& pair : enumerate(object->symbols)) {
+      const auto& symbol = *pair.value;
+      if (symbol.is_section()) {
+        continue;
+      }
+
+      // Global symbols resolve to their definition, which may be in another
+      // object (or this one, if it wasn't overridden or discarded).
+      const Object* target = object.get();
+      const SymbolInfo* target_symbol = &symbol;
+      string_view name = SymbolName(*object, symbol);
+      if (!IsLocal(symbol)) {
+        if (auto* definition = FindDefinition(name)) {
+          target = objects_[definition->object].get();
+          target_symbol = &*target->symbols[definition->symbol];
+        }
+      }
+
+      u32& value = object->symbol_values[pair.index];
+      switch (symbol.kind()) {
+        case SymbolInfoKind::Function: {
+          Index index = target_symbol->base().index;
+          if (target == object.get() && IsUndefined(symbol) &&
+              name == kCallCtorsName && call_ctors_index_ != kInvalidIndex) {
+            value = call_ctors_index_;
+          } else if (index < target->function_map.size() &&
+                     target->function_map[index] != kInvalidIndex) {
+            value = target->function_map[index];
+          } else {
+            errors_.OnError(object->Loc(pair.value),
+                            concat("Undefined function symbol ", name));
+          }
+          break;
+        }
+
+        case SymbolInfoKind::Global: {
+          Index index = target_symbol->base().index;
+          if (target == object.get() && IsUndefined(symbol) &&
+              name == kStackPointerName &&
+              stack_pointer_index_ != kInvalidIndex) {
+            value = stack_pointer_index_;
+          } else if (index < target->global_map.size() &&
+                     target->global_map[index] != kInvalidIndex) {
+            value = target->global_map[index];
+          } else {
+            errors_.OnError(object->Loc(pair.value),
+                            concat("Undefined global symbol ", name));
+          }
+          break;
+        }
+
+        case SymbolInfoKind::Data: {
+          const auto& defined = target_symbol->data().defined;
+          if (IsDefinedHere(*target, *target_symbol)) {
+            value =
+                target->segments[defined->index].address + defined->offset;
+          } else if (!IsWeak(symbol)) {
+            // Undefined weak data symbols are null.
+            errors_.OnError(object->Loc(pair.value),
+                            concat("Undefined data symbol ", name));
+          }
+          break;
+        }
+
+        default:
+          break;
+      }
+    }
+  }
+}
+
+void Linker::CheckRelocations() {
+  for (auto& object : objects_) {
+    for (const auto& relocations : object->relocations) {
+      SpanU8 section;
+      if (relocations.section_index == object->code_section_index) {
+        section = object->code_section;
+      } else if (relocations.section_index == object->data_section_index) {
+        section = object->data_section;
+      } else {
+        // Relocations for custom sections (e.g. debug info) are dropped
+        // along with those sections.
+        continue;
+      }
+
+      for (const auto& reloc : relocations.entries) {
+        u32 width = RelocationWidth(reloc->type);
+        if (width == 0) {
+          errors_.OnError(object->Loc(reloc->type),
+                          concat("Unsupported relocation type ",
+                                 reloc->type));
+          continue;
+        }
+        if (reloc->offset > section.size() ||
+            width > section.size() - reloc->offset) {
+          errors_.OnError(object->Loc(reloc->offset),
+                          concat("Relocation offset ", reloc->offset,
+                                 " is out of bounds"));
+          continue;
+        }
+
+        SymbolInfoKind kind;
+        switch (*reloc->type) {
+          case RelocationType::TypeIndexLEB:
+            if (reloc->index >= object->type_map.size()) {
+              errors_.OnError(object->Loc(reloc->index),
+                              concat("Invalid type index ", reloc->index));
+            }
+            continue;
+
+          case RelocationType::FunctionIndexLEB:
+          case RelocationType::TableIndexSLEB:
+          case RelocationType::TableIndexI32:
+            kind = SymbolInfoKind::Function;
+            break;
+
+          case RelocationType::GlobalIndexLEB:
+            kind = SymbolInfoKind::Global;
+            break;
+
+          default:
+            kind = SymbolInfoKind::Data;
+            break;
+        }
+
+        if (reloc->index >= object->symbols.size()) {
+          errors_.OnError(object->Loc(reloc->index),
+                          concat("Invalid symbol index ", reloc->index));
+        } else if (object->symbols[reloc->index]->kind() != kind) {
+          errors_.OnError(object->Loc(reloc->index),
+                          concat("Expected ", kind, " symbol for ",
+                                 reloc->type, " relocation, got ",
+                                 object->symbols[reloc->index]->kind()));
+        }
+      }
+    }
+  }
+}
+
+void Linker::AssignTableSlots() {
+  // Slots are assigned in order of first use, before relocating in parallel,
+  // so the table doesn't depend on scheduling. Slot 0 stays null.
+  for (auto& object : objects_) {
+    has_table_ |= object->imports_table;
+    for (const auto& relocations : object->relocations) {
+      if (relocations.section_index != object->code_section_index &&
+          relocations.section_index != object->data_section_index) {
+        continue;
+      }
+      for (const auto& reloc : relocations.entries) {
+        if (reloc->type == RelocationType::TableIndexSLEB ||
+            reloc->type == RelocationType::TableIndexI32) {
+          Index function = object->symbol_values[reloc->index];
+          auto result = table_slots_.try_emplace(
+              function, static_cast<u32>(table_functions_.size() + 1));
+          if (result.second) {
+            table_functions_.push_back(function);
+          }
+        }
+      }
+    }
+  }
+  has_table_ |= !table_functions_.empty();
+}
+
+auto Linker::RelocationValue(const Object& object,
+                             const RelocationEntry& reloc) const -> u32 {
+  switch (*reloc.type) {
+    case RelocationType::TypeIndexLEB:
+      return object.type_map[reloc.index];
+
+    case RelocationType::TableIndexSLEB:
+    case RelocationType::TableIndexI32:
+      return table_slots_.at(object.symbol_values[reloc.index]);
+
+    case RelocationType::MemoryAddressLEB:
+    case RelocationType::MemoryAddressSLEB:
+    case RelocationType::MemoryAddressI32:
+      return object.symbol_values[reloc.index] +
+             static_cast<u32>(reloc.addend ? **reloc.addend : 0);
+
+    default:
+      return object.symbol_values[reloc.index];
+  }
+}
+
+void Linker::ApplyRelocations() {
+  std::vector<RelocationTask> tasks;
+  for (auto& object : objects_) {
+    object->relocated_code = ToBuffer(object->code_section);
+    object->relocated_data = ToBuffer(object->data_section);
+    for (const auto& relocations : object->relocations) {
+      if (relocations.section_index == object->code_section_index) {
+        tasks.push_back(RelocationTask{object.get(), &relocations,
+                                       object->code_section,
+                                       &object->relocated_code});
+      } else if (relocations.section_index == object->data_section_index) {
+        tasks.push_back(RelocationTask{object.get(), &relocations,
+                                       object->data_section,
+                                       &object->relocated_data});
+      }
+    }
+  }
+
+  // Each task writes only to its own section's buffer, and only reads the
+  // (already resolved) symbol values and table slots.
+  auto apply = [&](size_t index, int) {
+    const auto& task = tasks[index];
+    for (const auto& reloc : task.relocations->entries) {
+      Patch(reloc->type, task.out->data() + reloc->offset,
+            RelocationValue(*task.object, reloc));
+    }
+  };
+
+  if (thread_pool_ && tasks.size() > 1) {
+    thread_pool_->ParallelFor(tasks.size(), apply);
+  } else {
+    for (size_t i = 0; i < tasks.size(); ++i) {
+      apply(i, 0);
+    }
+  }
+}
+
+auto Linker::Write() -> Buffer {
+  // Rebase the code bodies and data segments onto the relocated sections.
+  std::vector<Code> codes;
+  std::vector<DataSegment> data_segments;
+  for (auto& object : objects_) {
+    for (auto&& code : enumerate(object->codes)) {
+      if (code.index >= object->function_live.size() ||
+          !object->function_live[code.index]) {
+        continue;
+      }
+      SpanU8 body = code.value->body->data;
+      size_t offset = body.data() - object->code_section.data();
+      codes.push_back(Code{
+          code.value->locals,
+          Expression{SpanU8{object->relocated_code.data() + offset,
+                            body.size()}}});
+    }
+
+    for (const auto& segment : object->segments) {
+      if (!segment.live) {
+        continue;
+      }
+      data_segments.push_back(DataSegment{
+          nullopt,
+          ConstantExpression{Instruction{
+              Opcode::I32Const, static_cast<s32>(segment.address)}},
+          SpanU8{object->relocated_data.data() + segment.section_offset,
+                 segment.init.size()}});
+    }
+  }
+
+  if (call_ctors_index_ != kInvalidIndex) {
+    std::vector<std::pair<u32, Index>> calls;
+    for (auto& object : objects_) {
+      for (const auto& init : object->init_functions) {
+        if (init->index < object->symbol_values.size()) {
+          calls.emplace_back(init->priority,
+                             object->symbol_values[init->index]);
+        } else {
+          errors_.OnError(object->Loc(init->index),
+                          concat("Invalid symbol index ", init->index));
+        }
+      }
+    }
+    std::stable_sort(
+        calls.begin(), calls.end(),
+        [](const auto& lhs, const auto& rhs) { return lhs.first < rhs.first; });
+    auto out = std::back_inserter(call_ctors_body_);
+    for (const auto& call : calls) {
+      out = binary::Write(Opcode::Call, out);
+      out = WriteIndex(call.second, out);
+    }
+    out = binary::Write(Opcode::End, out);
+    codes.push_back(Code{{}, Expression{call_ctors_body_}});
+  }
+
+  std::vector<Table> tables;
+  std::vector<ElementSegment> element_segments;
+  if (has_table_) {
+    u32 size = static_cast<u32>(table_functions_.size() + 1);
+    tables.push_back(Table{TableType{
+        Limits{size, size}, ReferenceType::Funcref_NoLocation()}});
+    if (!table_functions_.empty()) {
+      element_segments.push_back(ElementSegment{
+          Index{0}, ConstantExpression{Instruction{Opcode::I32Const, s32{1}}},
+          ElementListWithIndexes{ExternalKind::Function, table_functions_}});
+    }
+  }
+
+  std::vector<Memory> memories;
+  std::vector<Export> exports;
+  if (has_memory_) {
+    u32 pages = std::max(1u, (memory_end_ + kPageSize - 1) / kPageSize);
+    memories.push_back(Memory{MemoryType{Limits{pages}}});
+    exports.push_back(Export{ExternalKind::Memory, "memory", 0});
+  }
+
+  for (const auto& name : options_.exports) {
+    if (name == kCallCtorsName && call_ctors_index_ != kInvalidIndex) {
+      exports.push_back(
+          Export{ExternalKind::Function, name, call_ctors_index_});
+      continue;
+    } else if (name == kStackPointerName &&
+               stack_pointer_index_ != kInvalidIndex) {
+      exports.push_back(
+          Export{ExternalKind::Global, name, stack_pointer_index_});
+      continue;
+    }
+
+    auto* definition = FindDefinition(name);
+    if (!definition) {
+      errors_.OnError(Location{}, concat("Undefined exported symbol ", name));
+      continue;
+    }
+    const auto& object = *objects_[definition->object];
+    u32 value = object.symbol_values[definition->symbol];
+    if (definition->kind == SymbolInfoKind::Function) {
+      exports.push_back(Export{ExternalKind::Function, name, value});
+    } else if (definition->kind == SymbolInfoKind::Global) {
+      exports.push_back(Export{ExternalKind::Global, name, value});
+    } else {
+      errors_.OnError(Location{},
+                      concat("Cannot export ", definition->kind,
+                             " symbol ", name));
+    }
+  }
+
+  std::vector<Import> imports = imports_;
+  imports.insert(imports.end(), global_imports_.begin(),
+                 global_imports_.end());
+
+  Buffer buffer;
+  auto out = std::back_inserter(buffer);
+  out = WriteBytes(encoding::Magic, out);
+  out = WriteBytes(encoding::Version, out);
+  out = WriteNonEmptyKnownSection(SectionId::Type, types_, out);
+  out = WriteNonEmptyKnownSection(SectionId::Import, imports, out);
+  out = WriteNonEmptyKnownSection(SectionId::Function, functions_, out);
+  out = WriteNonEmptyKnownSection(SectionId::Table, tables, out);
+  out = WriteNonEmptyKnownSection(SectionId::Memory, memories, out);
+  out = WriteNonEmptyKnownSection(SectionId::Global, globals_, out);
+  out = WriteNonEmptyKnownSection(SectionId::Export, exports, out);
+  out = WriteNonEmptyKnownSection(SectionId::Element, element_segments, out);
+  out = WriteNonEmptyKnownSection(SectionId::Code, codes, out);
+  out = WriteNonEmptyKnownSection(SectionId::Data, data_segments, out);
+  return buffer;
+}
+
+}  // namespace
+
+auto Link(span<const SpanU8> objects,
+          const Features& features,
+          const LinkOptions& options,
+          Errors& errors,
+          ThreadPool* thread_pool) -> optional<Buffer> {
+  Linker linker{features, options, errors, thread_pool};
+  return linker.Link(objects);
+}
+
+}  // namespace wasp::link
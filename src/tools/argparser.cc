@@ -109,7 +109,7 @@ void ArgParser::Parse(span<const string_view> args) {
       } else {
         Format(&std::cerr, "Unknown long argument `%s`.\n", arg);
       }
-    } else if (arg[0] == '-') {
+    } else if (arg.size() > 1 && arg[0] == '-') {
       optional<char> prev_arg_with_param;
       for (auto c : arg.substr(1)) {
         if (prev_arg_with_param) {
@@ -26,7 +26,7 @@ namespace wasp::tools {
 BinaryErrors::BinaryErrors(SpanU8 data) : BinaryErrors{"<unknown>", data} {}
 
 BinaryErrors::BinaryErrors(string_view filename, SpanU8 data)
-    : filename{filename}, data{data} {}
+    : filename{filename}, data{data}, location_base{data} {}
 
 void BinaryErrors::PrintTo(std::ostream& os) {
   for (const auto& error : errors) {
@@ -34,10 +34,6 @@ void BinaryErrors::PrintTo(std::ostream& os) {
   }
 }
 
-void BinaryErrors::HandlePushContext(Location loc, string_view desc) {}
-
-void BinaryErrors::HandlePopContext() {}
-
 void BinaryErrors::HandleOnError(Location loc, string_view message) {
   errors.push_back(Error{loc, std::string(message)});
 }
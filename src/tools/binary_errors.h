@@ -21,6 +21,7 @@
 #include <string>
 #include <vector>
 
+#include "wasp/base/compact_location.h"
 #include "wasp/base/error.h"
 #include "wasp/base/errors.h"
 #include "wasp/base/span.h"
@@ -38,14 +39,14 @@ class BinaryErrors : public Errors {
   void PrintTo(std::ostream&);
 
  protected:
-  void HandlePushContext(Location loc, string_view desc) override;
-  void HandlePopContext() override;
   void HandleOnError(Location loc, string_view message) override;
 
   auto ErrorToString(const Error&) const -> std::string;
 
   std::string filename;
   SpanU8 data;
+  // Locations are relative to `data` when built with WASP_COMPACT_LOCATIONS.
+  LocationBase location_base;
   std::vector<Error> errors;
 };
 
@@ -14,10 +14,8 @@
 // limitations under the License.
 //
 
-#include <cassert>
 #include <fstream>
 #include <iostream>
-#include <iterator>
 #include <map>
 #include <set>
 #include <string>
@@ -34,7 +32,7 @@
 #include "wasp/base/optional.h"
 #include "wasp/base/str_to_u32.h"
 #include "wasp/base/string_view.h"
-#include "wasp/binary/lazy_expression.h"
+#include "wasp/binary/flat_expression.h"
 #include "wasp/binary/lazy_module.h"
 #include "wasp/binary/lazy_module_utils.h"
 #include "wasp/binary/name_section/sections.h"
@@ -69,13 +67,11 @@ struct Tool {
   void CalculateCallGraph();
   void WriteDotFile();
 
-  optional<string_view> GetFunctionName(Index) const;
+  optional<string_view> GetFunctionName(Index);
 
   BinaryErrors errors;
   Options options;
   LazyModule module;
-  std::map<Index, string_view> function_names;
-  std::map<string_view, Index> name_to_function;
   Index imported_function_count = 0;
   std::set<std::pair<Index, Index>> call_graph;
 };
@@ -115,13 +111,13 @@ int Main(span<const string_view> args) {
     parser.PrintHelpAndExit(1);
   }
 
-  auto optbuf = ReadFile(filename);
-  if (!optbuf) {
+  auto optfile = MapFile(filename);
+  if (!optfile) {
     Format(&std::cerr, "Error reading file %s.\n", filename);
     return 1;
   }
 
-  SpanU8 data{*optbuf};
+  SpanU8 data = optfile->span();
   Tool tool{data, options};
   int result = tool.Run();
   tool.errors.PrintTo(std::cerr);
@@ -146,12 +142,6 @@ int Tool::Run() {
 }
 
 void Tool::DoPrepass() {
-  ForEachFunctionName(module, [this](const IndexNamePair& pair) {
-    name_to_function.insert(std::make_pair(pair.second, pair.first));
-  });
-
-  CopyFunctionNames(module,
-                    std::inserter(function_names, function_names.end()));
   imported_function_count = GetImportCount(module, ExternalKind::Function);
 }
 
@@ -161,9 +151,9 @@ void Tool::GetFunctionIndex() {
     return;
   }
   // Search by name.
-  auto iter = name_to_function.find(*options.function);
-  if (iter != name_to_function.end()) {
-    options.function_index = iter->second;
+  auto index = module.function_name_index().GetIndex(*options.function);
+  if (index) {
+    options.function_index = index;
     return;
   }
 
@@ -174,23 +164,17 @@ void Tool::GetFunctionIndex() {
 void Tool::CalculateCallGraph() {
   std::multimap<Index, Index> full_graph;
 
-  for (auto section : module.sections) {
-    if (section->is_known()) {
-      auto known = section->known();
-      if (known->id == SectionId::Code) {
-        auto section = ReadCodeSection(known, module.context);
-        for (auto code : enumerate(section.sequence, imported_function_count)) {
-          for (const auto& instr :
-               ReadExpression(code.value->body, module.context)) {
-            if (instr->opcode == Opcode::Call) {
-              assert(instr->has_index_immediate());
-              auto callee_index = instr->index_immediate();
-              if (options.mode == Mode::Callers) {
-                full_graph.emplace(callee_index, code.index);
-              } else {
-                full_graph.emplace(code.index, callee_index);
-              }
-            }
+  if (auto section = module.code_section()) {
+    auto read_flat_expression = GetReadFlatExpression(module.context.features);
+    for (auto code : enumerate(section->sequence, imported_function_count)) {
+      auto expr = read_flat_expression(code.value->body->data, module.context);
+      for (const auto& instr : expr.instructions) {
+        if (instr.opcode == Opcode::Call) {
+          auto callee_index = instr.index_immediate();
+          if (options.mode == Mode::Callers) {
+            full_graph.emplace(callee_index, code.index);
+          } else {
+            full_graph.emplace(code.index, callee_index);
           }
         }
       }
@@ -278,13 +262,8 @@ void Tool::WriteDotFile() {
   stream->flush();
 }
 
-optional<string_view> Tool::GetFunctionName(Index index) const {
-  auto it = function_names.find(index);
-  if (it != function_names.end()) {
-    return it->second;
-  } else {
-    return nullopt;
-  }
+optional<string_view> Tool::GetFunctionName(Index index) {
+  return module.function_name_index().GetName(index);
 }
 
 }  // namespace wasp::tools::callgraph
@@ -34,6 +34,7 @@
 #include "wasp/base/optional.h"
 #include "wasp/base/str_to_u32.h"
 #include "wasp/base/string_view.h"
+#include "wasp/binary/flat_expression.h"
 #include "wasp/binary/formatters.h"
 #include "wasp/binary/lazy_expression.h"
 #include "wasp/binary/lazy_module.h"
@@ -101,7 +102,6 @@ struct Tool {
   BinaryErrors errors;
   Options options;
   LazyModule module;
-  std::map<string_view, Index> name_to_function;
   Index imported_function_count = 0;
   std::vector<Label> labels;
   std::vector<BasicBlock> cfg;
@@ -141,13 +141,13 @@ int Main(span<const string_view> args) {
     parser.PrintHelpAndExit(1);
   }
 
-  auto optbuf = ReadFile(filename);
-  if (!optbuf) {
+  auto optfile = MapFile(filename, FileAccess::Random);
+  if (!optfile) {
     Format(&std::cerr, "Error reading file %s.\n", filename);
     return 1;
   }
 
-  SpanU8 data{*optbuf};
+  SpanU8 data = optfile->span();
   Tool tool{data, options};
   int result = tool.Run();
   tool.errors.PrintTo(std::cerr);
@@ -178,17 +178,13 @@ int Tool::Run() {
 }
 
 void Tool::DoPrepass() {
-  ForEachFunctionName(module, [this](const IndexNamePair& pair) {
-    name_to_function.insert(std::make_pair(pair.second, pair.first));
-  });
   imported_function_count = GetImportCount(module, ExternalKind::Function);
 }
 
 optional<Index> Tool::GetFunctionIndex() {
   // Search by name.
-  auto iter = name_to_function.find(options.function);
-  if (iter != name_to_function.end()) {
-    return iter->second;
+  if (auto index = module.function_name_index().GetIndex(options.function)) {
+    return index;
   }
 
   // Try to convert the string to an integer and search by index.
@@ -196,20 +192,15 @@ optional<Index> Tool::GetFunctionIndex() {
 }
 
 optional<Code> Tool::GetCode(Index find_index) {
-  for (auto section : module.sections) {
-    if (section->is_known()) {
-      auto known = section->known();
-      if (known->id == SectionId::Code) {
-        auto section = ReadCodeSection(known, module.context);
-        for (auto code : enumerate(section.sequence, imported_function_count)) {
-          if (code.index == find_index) {
-            return code.value;
-          }
-        }
-      }
-    }
+  if (find_index < imported_function_count) {
+    return nullopt;
+  }
+  auto code = module.code_section_index().GetCode(
+      find_index - imported_function_count, module.context);
+  if (!code) {
+    return nullopt;
   }
-  return nullopt;
+  return code->value();
 }
 
 void Tool::CalculateCFG(Code code) {
@@ -219,19 +210,18 @@ void Tool::CalculateCFG(Code code) {
   StartBasicBlock(start_bbid, ptr);
 
   const u8* prev_ptr = ptr;
-  auto instrs = ReadExpression(code.body, module.context);
-  for (auto it = instrs.begin(), end = instrs.end(); it != end;
-       ++it, prev_ptr = ptr) {
-    const auto& instr = *it;
-    ptr = it.data().data();
-    switch (instr->opcode) {
+  auto expr = ReadFlatExpression(code.body, module.context);
+  for (Index i = 0; i < expr.size(); ++i, prev_ptr = ptr) {
+    const auto& instr = expr.instructions[i];
+    ptr = expr.GetInstructionData(i).end();
+    switch (instr.opcode) {
       case Opcode::Unreachable:
         MarkUnreachable(ptr);
         break;
 
       case Opcode::Block: {
         auto next = NewBasicBlock();
-        PushLabel(instr->opcode, next, next);
+        PushLabel(instr.opcode, next, next);
         break;
       }
 
@@ -239,7 +229,7 @@ void Tool::CalculateCFG(Code code) {
         auto loop = NewBasicBlock();
         auto next = NewBasicBlock();
         AddSuccessor(loop);
-        PushLabel(instr->opcode, loop, next);
+        PushLabel(instr.opcode, loop, next);
         StartBasicBlock(loop, prev_ptr);
         break;
       }
@@ -248,7 +238,7 @@ void Tool::CalculateCFG(Code code) {
         auto true_ = NewBasicBlock();
         auto next = NewBasicBlock();
         AddSuccessor(true_, "T");
-        PushLabel(instr->opcode, next, next);
+        PushLabel(instr.opcode, next, next);
         StartBasicBlock(true_, ptr);
         break;
       }
@@ -258,7 +248,7 @@ void Tool::CalculateCFG(Code code) {
         AddSuccessor(top.next);
         auto false_ = NewBasicBlock();
         AddSuccessor(top.parent, false_, "F");
-        PushLabel(instr->opcode, top.next, top.next);
+        PushLabel(instr.opcode, top.next, top.next);
         StartBasicBlock(false_, ptr);
         break;
       }
@@ -274,12 +264,12 @@ void Tool::CalculateCFG(Code code) {
       }
 
       case Opcode::Br:
-        Br(instr->index_immediate());
+        Br(instr.index_immediate());
         MarkUnreachable(ptr);
         break;
 
       case Opcode::BrIf: {
-        Br(instr->index_immediate(), "T");
+        Br(instr.index_immediate(), "T");
         auto next = NewBasicBlock();
         AddSuccessor(next, "F");
         StartBasicBlock(next, ptr);
@@ -287,12 +277,12 @@ void Tool::CalculateCFG(Code code) {
       }
 
       case Opcode::BrTable: {
-        const auto& immediate = instr->br_table_immediate();
-        u32 value = 0;
-        for (const auto& target : immediate->targets) {
-          Br(target, StrFormat("%d", value++));
+        // The targets, followed by the default target.
+        auto targets = expr.GetBrTableTargets(instr);
+        for (u32 value = 0; value + 1 < targets.size(); ++value) {
+          Br(targets[value], StrFormat("%d", value));
         }
-        Br(immediate->default_target, "default");
+        Br(targets.back(), "default");
         MarkUnreachable(ptr);
         break;
       }
@@ -26,7 +26,6 @@
 #include "src/tools/argparser.h"
 #include "src/tools/binary_errors.h"
 #include "wasp/base/concat.h"
-#include "wasp/base/enumerate.h"
 #include "wasp/base/errors_nop.h"
 #include "wasp/base/features.h"
 #include "wasp/base/file.h"
@@ -37,7 +36,6 @@
 #include "wasp/binary/formatters.h"
 #include "wasp/binary/lazy_expression.h"
 #include "wasp/binary/lazy_module.h"
-#include "wasp/binary/lazy_module_utils.h"
 #include "wasp/binary/name_section/sections.h"
 #include "wasp/binary/sections.h"
 
@@ -145,7 +143,6 @@ struct Tool {
   LazyModule module;
   std::vector<DefinedType> defined_types;
   std::vector<Function> functions;
-  std::map<string_view, Index> name_to_function;
   Index imported_function_count = 0;
   std::vector<Label> labels;
   std::vector<Block> bbs;
@@ -189,13 +186,13 @@ int Main(span<const string_view> args) {
     parser.PrintHelpAndExit(1);
   }
 
-  auto optbuf = ReadFile(filename);
-  if (!optbuf) {
+  auto optfile = MapFile(filename, FileAccess::Random);
+  if (!optfile) {
     Format(&std::cerr, "Error reading file %s.\n", filename);
     return 1;
   }
 
-  SpanU8 data{*optbuf};
+  SpanU8 data = optfile->span();
   Tool tool{data, options};
   int result = tool.Run();
   tool.errors.PrintTo(std::cerr);
@@ -227,49 +224,31 @@ int Tool::Run() {
 }
 
 void Tool::DoPrepass() {
-  ForEachFunctionName(module, [this](const IndexNamePair& pair) {
-    name_to_function.insert(std::make_pair(pair.second, pair.first));
-  });
-
-  for (auto section : module.sections) {
-    if (section->is_known()) {
-      auto known = section->known();
-      switch (known->id) {
-        case SectionId::Type: {
-          auto seq = ReadTypeSection(known, module.context).sequence;
-          std::copy(seq.begin(), seq.end(), std::back_inserter(defined_types));
-          break;
-        }
-
-        case SectionId::Import:
-          for (auto import :
-               ReadImportSection(known, module.context).sequence) {
-            if (import->kind() == ExternalKind::Function) {
-              functions.push_back(Function{import->index()});
-            }
-          }
-          imported_function_count = static_cast<Index>(functions.size());
-          break;
-
-        case SectionId::Function: {
-          auto seq = ReadFunctionSection(known, module.context).sequence;
-          std::copy(seq.begin(), seq.end(), std::back_inserter(functions));
-          break;
-        }
+  if (auto section = module.type_section()) {
+    auto& seq = section->sequence;
+    std::copy(seq.begin(), seq.end(), std::back_inserter(defined_types));
+  }
 
-        default:
-          break;
+  if (auto section = module.import_section()) {
+    for (auto import : section->sequence) {
+      if (import->kind() == ExternalKind::Function) {
+        functions.push_back(Function{import->index()});
       }
     }
+    imported_function_count = static_cast<Index>(functions.size());
+  }
+
+  if (auto section = module.function_section()) {
+    auto& seq = section->sequence;
+    std::copy(seq.begin(), seq.end(), std::back_inserter(functions));
   }
 }
 
 // TODO(binji): share code with cfg.cc
 optional<Index> Tool::GetFunctionIndex() {
   // Search by name.
-  auto iter = name_to_function.find(options.function);
-  if (iter != name_to_function.end()) {
-    return iter->second;
+  if (auto index = module.function_name_index().GetIndex(options.function)) {
+    return index;
   }
 
   // Try to convert the string to an integer and search by index.
@@ -291,20 +270,15 @@ optional<FunctionType> Tool::GetFunctionType(Index func_index) {
 }
 
 optional<Code> Tool::GetCode(Index find_index) {
-  for (auto section : module.sections) {
-    if (section->is_known()) {
-      auto known = section->known();
-      if (known->id == SectionId::Code) {
-        auto section = ReadCodeSection(known, module.context);
-        for (auto code : enumerate(section.sequence, imported_function_count)) {
-          if (code.index == find_index) {
-            return code.value;
-          }
-        }
-      }
-    }
+  if (find_index < imported_function_count) {
+    return nullopt;
   }
-  return nullopt;
+  auto code = module.code_section_index().GetCode(
+      find_index - imported_function_count, module.context);
+  if (!code) {
+    return nullopt;
+  }
+  return code->value();
 }
 
 void Tool::CalculateDFG(const FunctionType& type, Code code) {
@@ -244,13 +244,13 @@ int Main(span<const string_view> args) {
   }
 
   for (auto filename : filenames) {
-    auto optbuf = ReadFile(filename);
-    if (!optbuf) {
+    auto optfile = MapFile(filename);
+    if (!optfile) {
       Format(&std::cerr, "Error reading file %s.\n", filename);
       continue;
     }
 
-    SpanU8 data{*optbuf};
+    SpanU8 data = optfile->span();
     Tool tool{filename, data, options};
     tool.Run();
     tool.errors.PrintTo(std::cerr);
@@ -754,7 +754,25 @@ visit::Result Tool::Visitor::BeginDataCountSection(DataCountSection section) {
 visit::Result Tool::Visitor::BeginCodeSection(LazyCodeSection section) {
   index = tool.imported_function_count;
   tool.DoCount(pass, section.count);
-  return SkipUnless(tool.ShouldPrintDetails(pass) || pass == Pass::Disassemble);
+  if (!(tool.ShouldPrintDetails(pass) || pass == Pass::Disassemble)) {
+    return visit::Result::Skip;
+  }
+
+  if (tool.options.func_index) {
+    // Jump straight to the requested function instead of reading every
+    // function before it.
+    Index func_index = *tool.options.func_index;
+    if (func_index >= tool.imported_function_count) {
+      auto code = tool.module.code_section_index().GetCode(
+          func_index - tool.imported_function_count, tool.module.context);
+      if (code) {
+        index = func_index;
+        BeginCode(*code);
+      }
+    }
+    return visit::Result::Skip;
+  }
+  return visit::Result::Ok;
 }
 
 visit::Result Tool::Visitor::BeginCode(const At<Code>& code) {
@@ -0,0 +1,216 @@
+//
+// Copyright 2020 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "wasp/link/link.h"
+
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/strings/str_format.h"
+
+#include "src/tools/argparser.h"
+#include "src/tools/binary_errors.h"
+#include "wasp/base/buffer.h"
+#include "wasp/base/errors.h"
+#include "wasp/base/features.h"
+#include "wasp/base/file.h"
+#include "wasp/base/optional.h"
+#include "wasp/base/str_to_u32.h"
+#include "wasp/base/string_view.h"
+#include "wasp/base/thread_pool.h"
+#include "wasp/binary/lazy_module.h"
+#include "wasp/binary/visitor.h"
+#include "wasp/valid/validate_visitor.h"
+
+namespace wasp {
+namespace tools {
+namespace link {
+
+using absl::Format;
+
+struct Options {
+  Features features;
+  wasp::link::LinkOptions link_options;
+  bool validate = true;
+  u32 jobs = 1;
+  std::string output_filename = "a.out.wasm";
+};
+
+// Sends each error to the BinaryErrors of the object that contains it, so it
+// is printed with that object's filename.
+class LinkErrors : public Errors {
+ public:
+  void AddFile(string_view filename, SpanU8 data);
+  bool has_error() const;
+  void PrintTo(std::ostream&);
+
+ protected:
+  void HandleOnError(Location loc, string_view message) override;
+
+ private:
+  std::vector<SpanU8> datas_;
+  std::vector<std::unique_ptr<BinaryErrors>> files_;
+  std::vector<std::string> other_errors_;
+};
+
+int Main(span<const string_view> args) {
+  std::vector<string_view> filenames;
+  Options options;
+
+  ArgParser parser{"wasp link"};
+  parser
+      .Add('h', "--help", "print help and exit",
+           [&]() { parser.PrintHelpAndExit(0); })
+      .Add('o', "--output", "<filename>", "write the output to <filename>",
+           [&](string_view arg) { options.output_filename = arg; })
+      .Add("--export", "<symbol>", "export <symbol> from the linked module",
+           [&](string_view arg) {
+             options.link_options.exports.push_back(std::string{arg});
+           })
+      .Add("--global-base", "<n>", "place the data at address <n>",
+           [&](string_view arg) {
+             auto value = StrToU32(arg);
+             if (!value) {
+               Format(&std::cerr, "Invalid global base `%s`.\n", arg);
+               parser.PrintHelpAndExit(1);
+             }
+             options.link_options.global_base = *value;
+           })
+      .Add("--stack-size", "<n>", "reserve <n> bytes for the stack",
+           [&](string_view arg) {
+             auto value = StrToU32(arg);
+             if (!value) {
+               Format(&std::cerr, "Invalid stack size `%s`.\n", arg);
+               parser.PrintHelpAndExit(1);
+             }
+             options.link_options.stack_size = *value;
+           })
+      .Add('j', "--jobs", "<n>", "apply relocations using <n> threads",
+           [&](string_view arg) {
+             auto jobs = StrToU32(arg);
+             if (!jobs || *jobs == 0) {
+               Format(&std::cerr, "Invalid job count `%s`.\n", arg);
+               parser.PrintHelpAndExit(1);
+             }
+             options.jobs = *jobs;
+           })
+      .Add("--no-validate", "Don't validate before writing",
+           [&]() { options.validate = false; })
+      .AddFeatureFlags(options.features)
+      .Add("<filenames...>", "input object files",
+           [&](string_view arg) { filenames.push_back(arg); });
+  parser.Parse(args);
+
+  if (filenames.empty()) {
+    Format(&std::cerr, "No filenames given.\n");
+    parser.PrintHelpAndExit(1);
+  }
+
+  std::vector<MappedFile> files;
+  std::vector<SpanU8> objects;
+  LinkErrors errors;
+  for (auto filename : filenames) {
+    auto optfile = MapFile(filename);
+    if (!optfile) {
+      Format(&std::cerr, "Error reading file %s.\n", filename);
+      return 1;
+    }
+    files.push_back(std::move(*optfile));
+    objects.push_back(files.back().span());
+    errors.AddFile(filename, objects.back());
+  }
+
+  std::unique_ptr<ThreadPool> thread_pool;
+  if (options.jobs > 1) {
+    thread_pool = std::make_unique<ThreadPool>(options.jobs);
+  }
+
+  auto buffer = wasp::link::Link(objects, options.features,
+                                 options.link_options, errors,
+                                 thread_pool.get());
+  if (!buffer) {
+    errors.PrintTo(std::cerr);
+    return 1;
+  }
+
+  if (options.validate) {
+    BinaryErrors validate_errors{options.output_filename, *buffer};
+    auto module =
+        binary::ReadModule(*buffer, options.features, validate_errors);
+    valid::ValidateVisitor visitor{options.features, validate_errors,
+                                   thread_pool.get()};
+    binary::visit::Visit(module, visitor);
+    if (validate_errors.has_error()) {
+      validate_errors.PrintTo(std::cerr);
+      return 1;
+    }
+  }
+
+  std::ofstream fstream(options.output_filename,
+                        std::ios_base::out | std::ios_base::binary);
+  if (!fstream) {
+    Format(&std::cerr, "Unable to open file %s.\n", options.output_filename);
+    return 1;
+  }
+
+  auto span = ToStringView(*buffer);
+  fstream.write(span.data(), span.size());
+  return 0;
+}
+
+void LinkErrors::AddFile(string_view filename, SpanU8 data) {
+  datas_.push_back(data);
+  files_.push_back(std::make_unique<BinaryErrors>(filename, data));
+}
+
+bool LinkErrors::has_error() const {
+  if (!other_errors_.empty()) {
+    return true;
+  }
+  for (const auto& file : files_) {
+    if (file->has_error()) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void LinkErrors::PrintTo(std::ostream& os) {
+  for (const auto& file : files_) {
+    file->PrintTo(os);
+  }
+  for (const auto& message : other_errors_) {
+    Format(&os, "error: %s\n", message);
+  }
+}
+
+void LinkErrors::HandleOnError(Location loc, string_view message) {
+  for (size_t i = 0; i < datas_.size(); ++i) {
+    if (loc.data() && loc.begin() >= datas_[i].begin() &&
+        loc.end() <= datas_[i].end()) {
+      files_[i]->OnError(loc, message);
+      return;
+    }
+  }
+  other_errors_.push_back(std::string{message});
+}
+
+}  // namespace link
+}  // namespace tools
+}  // namespace wasp
@@ -27,7 +27,7 @@
 namespace wasp::tools {
 
 TextErrors::TextErrors(string_view filename, SpanU8 data)
-    : filename{filename}, data{data} {}
+    : filename{filename}, data{data}, location_base{data} {}
 
 void TextErrors::PrintTo(std::ostream& os) const {
   if (has_error()) {
@@ -42,10 +42,6 @@ bool TextErrors::has_error() const {
   return !errors.empty();
 }
 
-void TextErrors::HandlePushContext(SpanU8 pos, string_view desc) {}
-
-void TextErrors::HandlePopContext() {}
-
 void TextErrors::HandleOnError(Location loc, string_view message) {
   errors.push_back(Error{loc, std::string{message}});
 }
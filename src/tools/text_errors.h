@@ -20,6 +20,7 @@
 
 #include <vector>
 
+#include "wasp/base/compact_location.h"
 #include "wasp/base/error.h"
 #include "wasp/base/errors.h"
 #include "wasp/base/span.h"
@@ -39,8 +40,6 @@ class TextErrors : public Errors {
   bool has_error() const;
 
  protected:
-  void HandlePushContext(SpanU8 pos, string_view desc) override;
-  void HandlePopContext() override;
   void HandleOnError(Location, string_view message) override;
 
   void CalculateLineNumbers() const;
@@ -50,6 +49,8 @@ class TextErrors : public Errors {
 
   std::string filename;
   SpanU8 data;
+  // Locations are relative to `data` when built with WASP_COMPACT_LOCATIONS.
+  LocationBase location_base;
   std::vector<Error> errors;
   mutable std::vector<Offset> line_offsets;
 };
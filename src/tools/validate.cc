@@ -18,9 +18,11 @@
 
 #include <algorithm>
 #include <array>
+#include <filesystem>
 #include <fstream>
 #include <iostream>
 #include <map>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -33,10 +35,13 @@
 #include "wasp/base/file.h"
 #include "wasp/base/formatters.h"
 #include "wasp/base/optional.h"
+#include "wasp/base/str_to_u32.h"
 #include "wasp/base/string_view.h"
+#include "wasp/base/thread_pool.h"
 #include "wasp/binary/formatters.h"
 #include "wasp/valid/context.h"
 #include "wasp/valid/validate_visitor.h"
+#include "wasp/valid/validation_cache.h"
 
 namespace wasp {
 namespace tools {
@@ -47,13 +52,21 @@ using absl::PrintF;
 
 using namespace ::wasp::binary;
 
+namespace fs = std::filesystem;
+
 struct Options {
   Features features;
   bool verbose = false;
+  u32 jobs = 1;
+  string_view cache_dir;
 };
 
 struct Tool {
-  explicit Tool(string_view filename, SpanU8 data, Options);
+  explicit Tool(string_view filename,
+                SpanU8 data,
+                Options,
+                ThreadPool*,
+                valid::ValidationCache*);
 
   bool Run();
 
@@ -61,8 +74,8 @@ struct Tool {
   Options options;
   SpanU8 data;
   BinaryErrors errors;
-  LazyModule module;
-  valid::ValidateVisitor visitor;
+  ThreadPool* thread_pool;
+  valid::ValidationCache* cache;
 };
 
 int Main(span<const string_view> args) {
@@ -75,6 +88,18 @@ int Main(span<const string_view> args) {
            [&]() { parser.PrintHelpAndExit(0); })
       .Add('v', "--verbose", "print filename and whether it was valid",
            [&]() { options.verbose = true; })
+      .Add('j', "--jobs", "<n>", "validate function bodies using <n> threads",
+           [&](string_view arg) {
+             auto jobs = StrToU32(arg);
+             if (!jobs || *jobs == 0) {
+               Format(&std::cerr, "Invalid job count `%s`.\n", arg);
+               parser.PrintHelpAndExit(1);
+             }
+             options.jobs = *jobs;
+           })
+      .Add("--cache-dir", "<dir>",
+           "reuse validation results for unchanged modules, stored in <dir>",
+           [&](string_view arg) { options.cache_dir = arg; })
       .AddFeatureFlags(options.features)
       .Add("<filenames...>", "input wasm files",
            [&](string_view arg) { filenames.push_back(arg); });
@@ -85,17 +110,34 @@ int Main(span<const string_view> args) {
     parser.PrintHelpAndExit(1);
   }
 
+  std::unique_ptr<ThreadPool> thread_pool;
+  if (options.jobs > 1) {
+    thread_pool = std::make_unique<ThreadPool>(options.jobs);
+  }
+
+  std::unique_ptr<valid::ValidationCache> cache;
+  if (!options.cache_dir.empty()) {
+    std::error_code error;
+    fs::create_directories(fs::path{options.cache_dir}, error);
+    if (error) {
+      Format(&std::cerr, "Unable to create cache directory %s: %s\n",
+             options.cache_dir, error.message());
+      return 1;
+    }
+    cache = std::make_unique<valid::ValidationCache>(options.cache_dir);
+  }
+
   bool ok = true;
   for (auto filename : filenames) {
-    auto optbuf = ReadFile(filename);
-    if (!optbuf) {
+    auto optfile = MapFile(filename);
+    if (!optfile) {
       Format(&std::cerr, "Error reading file %s.\n", filename);
       ok = false;
       continue;
     }
 
-    SpanU8 data{*optbuf};
-    Tool tool{filename, data, options};
+    SpanU8 data = optfile->span();
+    Tool tool{filename, data, options, thread_pool.get(), cache.get()};
     bool valid = tool.Run();
     if (!valid || options.verbose) {
       PrintF("[%4s] %s\n", valid ? " OK " : "FAIL", filename);
@@ -107,16 +149,26 @@ int Main(span<const string_view> args) {
   return ok ? 0 : 1;
 }
 
-Tool::Tool(string_view filename, SpanU8 data, Options options)
+Tool::Tool(string_view filename,
+           SpanU8 data,
+           Options options,
+           ThreadPool* thread_pool,
+           valid::ValidationCache* cache)
     : filename(filename),
       options{options},
       data{data},
       errors{data},
-      module{ReadModule(data, options.features, errors)},
-      visitor{options.features, errors} {}
+      thread_pool{thread_pool},
+      cache{cache} {}
 
 bool Tool::Run() {
+  if (cache) {
+    return cache->Validate(data, options.features, errors, thread_pool);
+  }
+
+  auto module = ReadModule(data, options.features, errors);
   if (module.magic && module.version) {
+    valid::ValidateVisitor visitor{options.features, errors, thread_pool};
     visit::Visit(module, visitor);
   }
   return !errors.has_error();
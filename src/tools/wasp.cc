@@ -25,6 +25,7 @@
 #include "src/tools/cfg.h"
 #include "src/tools/dfg.h"
 #include "src/tools/dump.h"
+#include "src/tools/link.h"
 #include "src/tools/pattern.h"
 #include "src/tools/validate.h"
 #include "src/tools/wat2wasm.h"
@@ -50,6 +51,7 @@ int main(int argc, char** argv) {
       {"callgraph", wasp::tools::callgraph::Main},
       {"cfg", wasp::tools::cfg::Main},
       {"dfg", wasp::tools::dfg::Main},
+      {"link", wasp::tools::link::Main},
       {"validate", wasp::tools::validate::Main},
       {"pattern", wasp::tools::pattern::Main},
       {"wat2wasm", wasp::tools::wat2wasm::Main},
@@ -78,6 +80,7 @@ void PrintHelp(int errcode) {
   Format(&std::cerr, "  callgraph   Generate DOT file for the function call graph.\n");
   Format(&std::cerr, "  cfg         Generate DOT file of a function's control flow graph.\n");
   Format(&std::cerr, "  dfg         Generate DOT file of a function's data flow graph.\n");
+  Format(&std::cerr, "  link        Link relocatable object files into a module.\n");
   Format(&std::cerr, "  validate    Validate a WebAssembly file.\n");
   Format(&std::cerr, "  pattern     Find common instruction sequences.\n");
   Format(&std::cerr, "  wat2wasm    Convert a WebAssembly text file to binary.\n");
@@ -101,19 +101,22 @@ int Main(span<const string_view> args) {
     parser.PrintHelpAndExit(1);
   }
 
-  auto optbuf = ReadFile(filename);
-  if (!optbuf) {
+  auto optfile = MapFile(filename);
+  if (!optfile) {
     Format(&std::cerr, "Error reading file %s.\n", filename);
     return 1;
   }
 
   if (options.output_filename.empty()) {
-    // Create an output filename from the input filename.
+    // Create an output filename from the input filename. Input from stdin
+    // has no name, so use the same default as `wasp link`.
     options.output_filename =
-        fs::path(filename).replace_extension(".wasm").string();
+        filename == "-"
+            ? "a.out.wasm"
+            : fs::path(filename).replace_extension(".wasm").string();
   }
 
-  SpanU8 data{*optbuf};
+  SpanU8 data = optfile->span();
   Tool tool{filename, data, options};
   return tool.Run();
 }
@@ -16,7 +16,11 @@
 
 #include "wasp/valid/context.h"
 
+#include <algorithm>
 #include <cassert>
+#include <utility>
+
+#include "wasp/valid/types.h"
 
 namespace wasp::valid {
 
@@ -30,10 +34,23 @@ Label::Label(LabelType label_type,
       type_stack_limit{type_stack_limit},
       unreachable{false} {}
 
-Context::Context(Errors& errors) : errors{&errors} {}
+namespace {
+
+// The type stack is pushed and popped for every instruction; reserve enough up
+// front that it is rarely reallocated. Unlike an inlined vector, its capacity
+// is kept when it is cleared between functions.
+constexpr size_t kInitialTypeStackCapacity = 256;
+
+}  // namespace
+
+Context::Context(Errors& errors) : errors{&errors} {
+  type_stack.reserve(kInitialTypeStackCapacity);
+}
 
 Context::Context(const Features& features, Errors& errors)
-    : features{features}, errors{&errors} {}
+    : features{features}, errors{&errors} {
+  type_stack.reserve(kInitialTypeStackCapacity);
+}
 
 Context::Context(const Context& other, Errors& errors) {
   *this = other;
@@ -61,52 +78,360 @@ bool Context::IsArrayType(Index index) const {
   return index < types.size() && types[index].is_array_type();
 }
 
-void TypeRelationSet::Reset(Index size) {
-  disjoint_set_.Reset(size);
-  assume_.clear();
+auto Context::GetCanonicalTypeId(Index index) -> optional<Index> {
+  if (index >= types.size()) {
+    return nullopt;
+  }
+  if (same_types.size() != types.size()) {
+    // The ids are reassigned, so the memoized matches are stale too.
+    same_types.Canonicalize(types);
+    match_types.Reset();
+  }
+  return same_types.Get(index);
 }
 
-auto TypeRelationSet::Get(Index expected, Index actual) -> optional<bool> {
-  MaybeSwapIndexes(expected, actual);
-  if (!(disjoint_set_.IsValid(expected) && disjoint_set_.IsValid(actual))) {
-    // If the indexes are invalid, then there's no point in checking whether
-    // they're equal.
-    return false;
+namespace {
+
+// Tokens used to flatten a defined type; see TypeEncoder below.
+enum : u64 {
+  kFunctionToken,
+  kStructToken,
+  kArrayToken,
+  kNumericToken,
+  kRefToken,
+  kRttToken,
+  kHeapKindToken,
+  kIndexToken,
+  kUnknownIndexToken,
+  kPackedToken,
+};
+
+// Flattens a defined type into a list of tokens, leaving a hole for each
+// type index that is in range and appending the index to `edges`. Two types
+// are equivalent iff they have the same tokens, and their edges refer to
+// equivalent types, in order.
+class TypeEncoder {
+ public:
+  TypeEncoder(Index type_count,
+              std::vector<u64>& tokens,
+              std::vector<Index>& edges)
+      : type_count_{type_count}, tokens_{tokens}, edges_{edges} {}
+
+  void Encode(const binary::DefinedType& value) {
+    if (value.is_function_type()) {
+      const auto& function_type = *value.function_type();
+      tokens_.push_back(kFunctionToken);
+      Encode(function_type.param_types);
+      Encode(function_type.result_types);
+    } else if (value.is_struct_type()) {
+      const auto& fields = value.struct_type()->fields;
+      tokens_.push_back(kStructToken);
+      tokens_.push_back(fields.size());
+      for (const auto& field : fields) {
+        Encode(*field);
+      }
+    } else {
+      assert(value.is_array_type());
+      tokens_.push_back(kArrayToken);
+      Encode(*value.array_type()->field);
+    }
   }
 
-  if (disjoint_set_.IsSameSet(expected, actual)) {
-    return true;
+ private:
+  void Encode(const binary::ValueTypeList& value_types) {
+    tokens_.push_back(value_types.size());
+    for (const auto& value_type : value_types) {
+      Encode(*value_type);
+    }
   }
 
-  auto iter = assume_.find({expected, actual});
-  if (iter == assume_.end()) {
-    return nullopt;
+  void Encode(const binary::ValueType& value) {
+    if (value.is_numeric_type()) {
+      tokens_.push_back(kNumericToken);
+      tokens_.push_back(static_cast<u64>(value.numeric_type().value()));
+    } else if (value.is_reference_type()) {
+      // Canonicalize so "funcref" and "ref null func" are encoded the same.
+      auto canon = valid::Canonicalize(value.reference_type());
+      assert(canon.is_ref());
+      tokens_.push_back(kRefToken);
+      tokens_.push_back(static_cast<u64>(canon.ref()->null));
+      Encode(*canon.ref()->heap_type);
+    } else {
+      assert(value.is_rtt());
+      tokens_.push_back(kRttToken);
+      tokens_.push_back(value.rtt()->depth.value());
+      Encode(*value.rtt()->type);
+    }
   }
 
-  return iter->second;
+  void Encode(const binary::HeapType& value) {
+    if (value.is_heap_kind()) {
+      tokens_.push_back(kHeapKindToken);
+      tokens_.push_back(static_cast<u64>(value.heap_kind().value()));
+    } else {
+      Index index = value.index().value();
+      if (index < type_count_) {
+        tokens_.push_back(kIndexToken);
+        edges_.push_back(index);
+      } else {
+        // Out-of-range indexes are only equivalent to themselves.
+        tokens_.push_back(kUnknownIndexToken);
+        tokens_.push_back(index);
+      }
+    }
+  }
+
+  void Encode(const binary::FieldType& value) {
+    tokens_.push_back(static_cast<u64>(value.mut.value()));
+    if (value.type->is_value_type()) {
+      Encode(*value.type->value_type());
+    } else {
+      tokens_.push_back(kPackedToken);
+      tokens_.push_back(static_cast<u64>(value.type->packed_type().value()));
+    }
+  }
+
+  Index type_count_;
+  std::vector<u64>& tokens_;
+  std::vector<Index>& edges_;
+};
+
+// A partition of [0, size) into blocks, which can be split by marking some of
+// the elements of a block. Each block is a contiguous range of `elements_`,
+// with its marked elements first.
+class RefinablePartition {
+ public:
+  // Creates one block per distinct value of `initial`, which must be in
+  // [0, block_count).
+  RefinablePartition(const std::vector<Index>& initial, Index block_count)
+      : elements_(initial.size()),
+        location_(initial.size()),
+        block_of_{initial},
+        blocks_(block_count) {
+    for (Index block : initial) {
+      ++blocks_[block].end;
+    }
+    Index begin = 0;
+    for (auto& block : blocks_) {
+      Index size = block.end;
+      block.begin = block.marked_end = block.end = begin;
+      begin += size;
+    }
+    for (Index i = 0; i < initial.size(); ++i) {
+      auto& block = blocks_[initial[i]];
+      location_[i] = block.end;
+      elements_[block.end++] = i;
+    }
+  }
+
+  auto block_count() const -> Index { return blocks_.size(); }
+  auto block_of(Index element) const -> Index { return block_of_[element]; }
+  auto block_size(Index block) const -> Index {
+    return blocks_[block].end - blocks_[block].begin;
+  }
+  auto block_elements(Index block) const -> span<const Index> {
+    const auto& b = blocks_[block];
+    return span<const Index>{elements_.data() + b.begin, b.end - b.begin};
+  }
+  auto block_ids() const -> const std::vector<Index>& { return block_of_; }
+
+  void Mark(Index element) {
+    Index block = block_of_[element];
+    auto& b = blocks_[block];
+    Index location = location_[element];
+    if (location < b.marked_end) {
+      return;
+    }
+    if (b.marked_end == b.begin) {
+      touched_.push_back(block);
+    }
+    Index other = elements_[b.marked_end];
+    std::swap(elements_[location], elements_[b.marked_end]);
+    location_[other] = location;
+    location_[element] = b.marked_end++;
+  }
+
+  // Splits the marked elements of each block into a new block, unless the
+  // whole block is marked, and calls `on_split(block, new_block)`.
+  template <typename F>
+  void SplitMarked(F&& on_split) {
+    for (Index block : touched_) {
+      auto& b = blocks_[block];
+      if (b.marked_end == b.end) {
+        b.marked_end = b.begin;
+        continue;
+      }
+      Index new_block = blocks_.size();
+      Block marked{b.begin, b.marked_end, b.begin};
+      b.begin = b.marked_end;
+      for (Index i = marked.begin; i < marked.end; ++i) {
+        block_of_[elements_[i]] = new_block;
+      }
+      blocks_.push_back(marked);
+      on_split(block, new_block);
+    }
+    touched_.clear();
+  }
+
+ private:
+  struct Block {
+    Index begin = 0;
+    Index end = 0;
+    Index marked_end = 0;
+  };
+
+  std::vector<Index> elements_;
+  std::vector<Index> location_;
+  std::vector<Index> block_of_;
+  std::vector<Block> blocks_;
+  std::vector<Index> touched_;
+};
+
+}  // namespace
+
+void CanonicalTypeSet::Reset(Index size) {
+  ids_.clear();
+  ids_.reserve(size);
 }
 
-void TypeRelationSet::Assume(Index expected, Index actual) {
-  MaybeSwapIndexes(expected, actual);
-  assume_.insert({{expected, actual}, true});
+void CanonicalTypeSet::Canonicalize(
+    const std::vector<binary::DefinedType>& types) {
+  // Find the coarsest partition in which every type in a class has the same
+  // structure, and the same classes of referenced types, i.e. the most types
+  // that can be considered equivalent, even when recursive. This is
+  // Hopcroft's algorithm: start by grouping types with the same structure,
+  // then split the classes by the predecessors of a splitter class, once for
+  // each edge position. After a split, only the smaller half needs to be a
+  // splitter, so each type is in O(log n) splitters, and the whole refinement
+  // is O(m log n) for m edges.
+  const Index count = types.size();
+
+  // Encode every type, and group types with the same tokens. The edges of
+  // type `i` are edges[edge_begin[i] .. edge_begin[i + 1]).
+  std::vector<Index> initial(count);
+  std::vector<Index> edges;
+  std::vector<Index> edge_begin(count + 1);
+  Index class_count;
+  {
+    flat_hash_map<std::vector<u64>, Index> classes;
+    std::vector<u64> tokens;
+    for (Index i = 0; i < count; ++i) {
+      tokens.clear();
+      edge_begin[i] = edges.size();
+      TypeEncoder{count, tokens, edges}.Encode(types[i]);
+      auto pair = classes.try_emplace(tokens, classes.size());
+      initial[i] = pair.first->second;
+    }
+    edge_begin[count] = edges.size();
+    class_count = classes.size();
+  }
+  RefinablePartition partition{initial, class_count};
+
+  // The reverse edges: the edges into type `i`, as (source, position) pairs,
+  // are reverse[reverse_begin[i] .. reverse_begin[i + 1]).
+  std::vector<std::pair<Index, Index>> reverse(edges.size());
+  std::vector<Index> reverse_begin(count + 1);
+  Index max_edges = 0;
+  for (Index target : edges) {
+    ++reverse_begin[target + 1];
+  }
+  for (Index i = 0; i < count; ++i) {
+    reverse_begin[i + 1] += reverse_begin[i];
+    max_edges = std::max(max_edges, edge_begin[i + 1] - edge_begin[i]);
+  }
+  {
+    std::vector<Index> next{reverse_begin.begin(), reverse_begin.end() - 1};
+    for (Index source = 0; source < count; ++source) {
+      for (Index e = edge_begin[source]; e < edge_begin[source + 1]; ++e) {
+        reverse[next[edges[e]]++] = {source, e - edge_begin[source]};
+      }
+    }
+  }
+
+  std::vector<Index> splitters;
+  std::vector<bool> is_splitter(partition.block_count(), true);
+  for (Index block = 0; block < partition.block_count(); ++block) {
+    splitters.push_back(block);
+  }
+  auto on_split = [&](Index block, Index new_block) {
+    if (is_splitter[block] ||
+        partition.block_size(new_block) <= partition.block_size(block)) {
+      is_splitter.push_back(true);
+      splitters.push_back(new_block);
+    } else {
+      is_splitter.push_back(false);
+      is_splitter[block] = true;
+      splitters.push_back(block);
+    }
+  };
+
+  // The predecessors of the splitter, grouped by edge position.
+  std::vector<std::vector<Index>> sources(max_edges);
+  std::vector<Index> positions;
+  while (!splitters.empty()) {
+    Index splitter = splitters.back();
+    splitters.pop_back();
+    is_splitter[splitter] = false;
+
+    for (Index target : partition.block_elements(splitter)) {
+      for (Index r = reverse_begin[target]; r < reverse_begin[target + 1];
+           ++r) {
+        auto [source, position] = reverse[r];
+        if (sources[position].empty()) {
+          positions.push_back(position);
+        }
+        sources[position].push_back(source);
+      }
+    }
+    // A type has only one edge at each position, so marking the sources of
+    // one position at a time splits the classes correctly.
+    for (Index position : positions) {
+      for (Index source : sources[position]) {
+        partition.Mark(source);
+      }
+      partition.SplitMarked(on_split);
+      sources[position].clear();
+    }
+    positions.clear();
+  }
+
+  ids_ = partition.block_ids();
 }
 
-void TypeRelationSet::Resolve(Index expected, Index actual, bool is_same) {
-  MaybeSwapIndexes(expected, actual);
-  auto iter = assume_.find({expected, actual});
-  assert(iter != assume_.end());
-  if (is_same) {
-    disjoint_set_.MergeSets(expected, actual);
-    assume_.erase(iter);
-  } else {
-    iter->second = false;
+void IndexSet::insert(Index index) {
+  if (index >= bits_.size()) {
+    bits_.resize(index + 1);
+  }
+  if (!bits_[index]) {
+    bits_[index] = true;
+    ++size_;
   }
 }
 
-void TypeRelationSet::MaybeSwapIndexes(Index& lhs, Index& rhs) {
-  if (lhs > rhs) {
-    std::swap(lhs, rhs);
+auto IndexSet::count(Index index) const -> size_t {
+  return index < bits_.size() && bits_[index] ? 1 : 0;
+}
+
+void TypeRelationSet::Reset() {
+  results_.clear();
+}
+
+auto TypeRelationSet::Get(Index expected, Index actual) -> optional<bool> {
+  auto iter = results_.find({expected, actual});
+  if (iter == results_.end()) {
+    return nullopt;
   }
+  return iter->second;
+}
+
+void TypeRelationSet::Assume(Index expected, Index actual) {
+  results_.insert({{expected, actual}, true});
+}
+
+void TypeRelationSet::Resolve(Index expected, Index actual, bool result) {
+  auto iter = results_.find({expected, actual});
+  assert(iter != results_.end());
+  iter->second = result;
 }
 
 }  // namespace wasp::valid
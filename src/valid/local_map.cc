@@ -22,32 +22,52 @@
 
 namespace wasp::valid {
 
-LocalMap::LocalMap() {
+LocalMap::LocalMap(Index dense_limit) : dense_limit_{dense_limit} {
   Reset();
 }
 
 void LocalMap::Reset() {
-  pairs_.clear();
-  let_stack_.clear();
-  let_stack_.push_back(0);
+  count_ = 0;
+  runs_.clear();
+  use_dense_ = true;
+  dense_.clear();
+  blocks_.clear();
+  blocks_.push_back(Block{0, 0, 0});
 }
 
 auto LocalMap::GetCount() const -> Index {
-  return pairs_.empty() ? 0 : pairs_.back().second;
+  return count_;
 }
 
-auto LocalMap::GetType(Index index) const -> optional<binary::ValueType>{
+auto LocalMap::GetType(Index index) const -> optional<binary::ValueType> {
+  // The innermost let block has the lowest local indexes, so search the
+  // blocks in reverse. There is usually only the function's block.
+  Index end_run = static_cast<Index>(runs_.size());
+  for (auto iter = blocks_.rbegin(); iter != blocks_.rend(); ++iter) {
+    const Block& block = *iter;
+    if (index < block.count) {
+      Index run = use_dense_ ? dense_[block.first_dense + index]
+                             : GetRunIndex(block, end_run, index);
+      return runs_[run].type;
+    }
+    index -= block.count;
+    end_run = block.first_run;
+  }
+  return nullopt;
+}
+
+auto LocalMap::GetRunIndex(const Block& block, Index end_run, Index index) const
+    -> Index {
   struct Compare {
-    bool operator()(const Pair& lhs, Index rhs) { return lhs.second < rhs; }
-    bool operator()(Index lhs, const Pair& rhs) { return lhs < rhs.second; }
+    bool operator()(const Run& lhs, Index rhs) { return lhs.end < rhs; }
+    bool operator()(Index lhs, const Run& rhs) { return lhs < rhs.end; }
   };
 
-  const auto iter =
-      std::upper_bound(pairs_.begin(), pairs_.end(), index, Compare{});
-  if (iter == pairs_.end()) {
-    return nullopt;
-  }
-  return iter->first;
+  auto first = runs_.begin() + block.first_run;
+  auto last = runs_.begin() + end_run;
+  auto iter = std::upper_bound(first, last, index, Compare{});
+  assert(iter != last);
+  return static_cast<Index>(iter - runs_.begin());
 }
 
 bool LocalMap::Append(Index count, binary::ValueType value_type) {
@@ -74,27 +94,32 @@ bool LocalMap::Append(Index count, binary::ValueType value_type) {
   // the function variables. So appending an f64 yields:
   //
   //   {i64, f64,  i32, f32, f32}
+  //
+  // Since the innermost block is always stored last, this only ever appends
+  // to the end of `runs_` and `dense_`.
 
-  assert(!let_stack_.empty());
-  Index insert_at = let_stack_.back();
+  assert(!blocks_.empty());
+  Block& block = blocks_.back();
+  block.count += count;
+  count_ += count;
 
-  if (insert_at > 0) {
-    // There's a previous value, see if we can combine this value type.
-    auto& prev_pair = pairs_[insert_at - 1];
-    if (prev_pair.first == value_type) {
-      prev_pair.second += count;
-    } else {
-      pairs_.emplace(pairs_.begin() + insert_at,
-                     Pair{value_type, prev_pair.second + count});
-      let_stack_.back()++;
-    }
+  if (runs_.size() > block.first_run && runs_.back().type == value_type) {
+    // Combine with the previous run in this block.
+    runs_.back().end += count;
   } else {
-    // Inserting at the beginning, so we know that the previous count is 0.
-    pairs_.emplace(pairs_.begin(), Pair{value_type, count});
-    let_stack_.back()++;
+    runs_.push_back(Run{value_type, block.count});
   }
 
-  AdjustPartialSums(pairs_.begin() + let_stack_.back(), count);
+  if (use_dense_) {
+    if (count_ <= dense_limit_) {
+      dense_.insert(dense_.end(), count,
+                    static_cast<Index>(runs_.size() - 1));
+    } else {
+      // Too many locals; fall back to searching the runs.
+      use_dense_ = false;
+      dense_ = {};
+    }
+  }
   return true;
 }
 
@@ -117,33 +142,20 @@ bool LocalMap::CanAppend(Index count) const {
   return GetCount() <= std::numeric_limits<Index>::max() - count;
 }
 
-void LocalMap::AdjustPartialSums(Pairs::iterator first, Index count) {
-  for (auto iter = first; iter != pairs_.end(); ++iter) {
-    // Wrap-around is OK here, since the adjustment may be positive or negative.
-    iter->second += count;
-  }
-}
-
 void LocalMap::Push() {
-  let_stack_.push_back(0);
+  blocks_.push_back(Block{static_cast<Index>(runs_.size()),
+                          static_cast<Index>(dense_.size()), 0});
 }
 
 void LocalMap::Pop() {
-  assert(!let_stack_.empty());
-  Index pair_count = let_stack_.back();
-  let_stack_.pop_back();
-
-  if (pair_count > 0) {
-    assert(pair_count - 1 < pairs_.size());
-    Index var_count = pairs_[pair_count - 1].second;
-
-    // Erase all pairs corresponding to this let block.
-    pairs_.erase(pairs_.begin(), pairs_.begin() + pair_count);
-
-    // Adjust the partial sums to remove the number of variables from this let
-    // block.
-    AdjustPartialSums(pairs_.begin(), -var_count);
+  assert(!blocks_.empty());
+  const Block& block = blocks_.back();
+  count_ -= block.count;
+  runs_.erase(runs_.begin() + block.first_run, runs_.end());
+  if (use_dense_) {
+    dense_.resize(block.first_dense);
   }
+  blocks_.pop_back();
 }
 
 }  // namespace wasp::valid
@@ -42,18 +42,9 @@ bool IsSame(Context& context,
     if (expected_index == actual_index) {
       return true;
     }
-
-    auto is_same_opt = context.same_types.Get(expected_index, actual_index);
-    if (is_same_opt) {
-      return *is_same_opt;
-    }
-
-    // Assume that they are the same and check that everything still is valid.
-    context.same_types.Assume(expected_index, actual_index);
-    bool is_same = IsSame(context, context.types[expected_index],
-                          context.types[actual_index]);
-    context.same_types.Resolve(expected_index, actual_index, is_same);
-    return is_same;
+    auto expected_id = context.GetCanonicalTypeId(expected_index);
+    auto actual_id = context.GetCanonicalTypeId(actual_index);
+    return expected_id && actual_id && *expected_id == *actual_id;
   }
   return false;
 }
@@ -122,9 +113,14 @@ bool IsSame(Context& context,
             const StackType& expected,
             const StackType& actual) {
   // One of the types is "any" (i.e. universal supertype or subtype), or the
-  // value types are the same.
-  return expected.is_any() || actual.is_any() ||
-         IsSame(context, expected.value_type(), actual.value_type());
+  // value types are the same. Numeric types are only the same as themselves, so
+  // only reference and rtt types need to be decoded.
+  if (expected.is_any() || actual.is_any() || expected == actual) {
+    return true;
+  } else if (expected.is_numeric_type() || actual.is_numeric_type()) {
+    return false;
+  }
+  return IsSame(context, expected.value_type(), actual.value_type());
 }
 
 bool IsSame(Context& context, StackTypeSpan expected, StackTypeSpan actual) {
@@ -235,19 +231,27 @@ bool IsMatch(Context& context,
       return true;
     }
 
-    // Check whether heap types match, but make sure to handle recursive
-    // structures. This is the same logic used in IsSame(HeapType, HeapType).
+    // Equivalent types always match; otherwise check whether the heap types
+    // match, but make sure to handle recursive structures. The results are
+    // memoized by canonical id, so they are shared by equivalent types.
+    auto expected_id = context.GetCanonicalTypeId(expected_index);
+    auto actual_id = context.GetCanonicalTypeId(actual_index);
+    if (!(expected_id && actual_id)) {
+      return false;
+    } else if (*expected_id == *actual_id) {
+      return true;
+    }
 
-    auto is_match_opt = context.match_types.Get(expected_index, actual_index);
+    auto is_match_opt = context.match_types.Get(*expected_id, *actual_id);
     if (is_match_opt) {
       return *is_match_opt;
     }
 
     // Assume that they match and check that everything still is valid.
-    context.match_types.Assume(expected_index, actual_index);
+    context.match_types.Assume(*expected_id, *actual_id);
     bool is_match = IsMatch(context, context.types[expected_index],
                             context.types[actual_index]);
-    context.match_types.Resolve(expected_index, actual_index, is_match);
+    context.match_types.Resolve(*expected_id, *actual_id, is_match);
     return is_match;
   }
 
@@ -317,9 +321,14 @@ bool IsMatch(Context& context,
              const StackType& expected,
              const StackType& actual) {
   // One of the types is "any" (i.e. universal supertype or subtype), or the
-  // value types match.
-  return expected.is_any() || actual.is_any() ||
-         IsMatch(context, expected.value_type(), actual.value_type());
+  // value types match. Numeric types only match themselves, so only reference
+  // and rtt types need to be decoded.
+  if (expected.is_any() || actual.is_any() || expected == actual) {
+    return true;
+  } else if (expected.is_numeric_type() || actual.is_numeric_type()) {
+    return false;
+  }
+  return IsMatch(context, expected.value_type(), actual.value_type());
 }
 
 bool IsMatch(Context& context, StackTypeSpan expected, StackTypeSpan actual) {
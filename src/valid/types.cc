@@ -16,6 +16,7 @@
 
 #include "wasp/valid/types.h"
 
+#include <algorithm>
 #include <cassert>
 
 #include "wasp/base/hash.h"
@@ -24,11 +25,60 @@
 
 namespace wasp::valid {
 
-StackType::StackType() : type{Any{}} {}
+namespace {
+
+enum : u64 {
+  kAnyKind,
+  kNumericKind,
+  kReferenceKindKind,
+  kRefKind,
+  kRttKind,
+};
+
+constexpr u64 kKindMask = 0x7;
+constexpr u64 kNullBit = 1 << 3;
+constexpr u64 kIndexBit = 1 << 4;
+constexpr int kDepthShift = 5;
+constexpr int kPayloadShift = 32;
+
+u64 EncodeHeapType(const binary::HeapType& type) {
+  if (type.is_index()) {
+    return kIndexBit | (u64{type.index().value()} << kPayloadShift);
+  }
+  return u64(type.heap_kind().value()) << kPayloadShift;
+}
+
+u64 Encode(const binary::ValueType& type) {
+  if (type.is_numeric_type()) {
+    return kNumericKind |
+           (u64(type.numeric_type().value()) << kPayloadShift);
+  } else if (type.is_reference_type()) {
+    const auto& reference_type = type.reference_type().value();
+    if (reference_type.is_reference_kind()) {
+      return kReferenceKindKind |
+             (u64(reference_type.reference_kind().value()) << kPayloadShift);
+    }
+    const auto& ref_type = reference_type.ref().value();
+    return kRefKind | (ref_type.null == Null::Yes ? kNullBit : 0) |
+           EncodeHeapType(ref_type.heap_type);
+  } else {
+    assert(type.is_rtt());
+    const auto& rtt = type.rtt().value();
+    // Deeper rtts are a validation error, so clamp rather than overflow into
+    // the payload.
+    u64 depth = std::min(rtt.depth.value(), StackType::kMaxRttDepth);
+    return kRttKind | (depth << kDepthShift) |
+           EncodeHeapType(rtt.type);
+  }
+}
 
-StackType::StackType(binary::ValueType type) : type{type} {}
+}  // namespace
 
-StackType::StackType(Any type) : type{type} {}
+StackType::StackType() : bits{kAnyKind} {}
+
+StackType::StackType(binary::ValueType type) : bits{Encode(type)} {}
+
+StackType::StackType(Any type) : bits{kAnyKind} {}
 
 // static
 StackType StackType::I32() {
@@ -86,19 +136,55 @@ StackType StackType::Exnref() {
 }
 
 bool StackType::is_value_type() const {
-  return holds_alternative<binary::ValueType>(type);
+  return !is_any();
 }
 
 bool StackType::is_any() const {
-  return holds_alternative<Any>(type);
+  return (bits & kKindMask) == kAnyKind;
+}
+
+bool StackType::is_numeric_type() const {
+  return (bits & kKindMask) == kNumericKind;
 }
 
-auto StackType::value_type() -> binary::ValueType& {
-  return get<binary::ValueType>(type);
+bool StackType::is_reference_type() const {
+  u64 kind = bits & kKindMask;
+  return kind == kReferenceKindKind || kind == kRefKind;
 }
 
-auto StackType::value_type() const -> const binary::ValueType& {
-  return get<binary::ValueType>(type);
+bool StackType::is_rtt() const {
+  return (bits & kKindMask) == kRttKind;
+}
+
+auto StackType::value_type() const -> binary::ValueType {
+  assert(is_value_type());
+  u32 payload = bits >> kPayloadShift;
+  auto heap_type = [&]() {
+    return (bits & kIndexBit)
+               ? binary::HeapType{At<Index>{payload}}
+               : binary::HeapType{At<HeapKind>{static_cast<HeapKind>(payload)}};
+  };
+
+  switch (bits & kKindMask) {
+    case kNumericKind:
+      return binary::ValueType{static_cast<NumericType>(payload)};
+
+    case kReferenceKindKind:
+      return binary::ValueType{
+          binary::ReferenceType{static_cast<ReferenceKind>(payload)}};
+
+    case kRefKind:
+      return binary::ValueType{binary::ReferenceType{binary::RefType{
+          heap_type(), (bits & kNullBit) ? Null::Yes : Null::No}}};
+
+    case kRttKind:
+      return binary::ValueType{binary::Rtt{
+          static_cast<Index>((bits & 0xffffffff) >> kDepthShift),
+          heap_type()}};
+
+    default:
+      WASP_UNREACHABLE();
+  }
 }
 
 auto ToValueType(binary::StorageType type) -> binary::ValueType {
@@ -159,12 +245,11 @@ auto ToStackTypeList(const binary::LocalsList& locals_list) -> StackTypeList {
 }
 
 bool IsReferenceTypeOrAny(StackType type) {
-  return type.is_any() ||
-         (type.is_value_type() && type.value_type().is_reference_type());
+  return type.is_any() || type.is_reference_type();
 }
 
 bool IsRttOrAny(StackType type) {
-  return type.is_any() || (type.is_value_type() && type.value_type().is_rtt());
+  return type.is_any() || type.is_rtt();
 }
 
 auto Canonicalize(binary::ReferenceType type) -> binary::ReferenceType {
@@ -227,8 +312,7 @@ bool IsNullableType(binary::ValueType type) {
 }
 
 bool IsNullableType(StackType type) {
-  return type.is_any() ||
-         (type.is_value_type() && IsNullableType(type.value_type()));
+  return type.is_any() || type.is_reference_type();
 }
 
 auto AsNonNullableType(binary::RefType type) -> binary::RefType {
@@ -34,7 +34,7 @@ namespace wasp::valid {
 bool BeginTypeSection(Context& context, Index type_count) {
   context.defined_type_count = type_count;
   context.same_types.Reset(type_count);
-  context.match_types.Reset(type_count);
+  context.match_types.Reset();
   return true;
 }
 
@@ -259,11 +259,12 @@ bool Validate(Context& context,
     case Opcode::RefFunc: {
       actual_type = binary::ReferenceType::Funcref_NoLocation();
       auto index = instruction->index_immediate();
-      if (!ValidateIndex(context, index, static_cast<Index>(context.functions.size()),
-                         "function index")) {
+      if (ValidateIndex(context, index, static_cast<Index>(context.functions.size()),
+                        "function index")) {
+        context.declared_functions.insert(index);
+      } else {
         valid = false;
       }
-      context.declared_functions.insert(index);
       break;
     }
 
@@ -316,8 +317,9 @@ bool Validate(Context& context, const At<binary::ElementSegment>& value) {
     }
 
     for (auto index : elements.list) {
-      valid &= ValidateIndex(context, index, max_index, "index");
-      if (elements.kind == ExternalKind::Function) {
+      if (!ValidateIndex(context, index, max_index, "index")) {
+        valid = false;
+      } else if (elements.kind == ExternalKind::Function) {
         context.declared_functions.insert(index);
       }
     }
@@ -336,18 +338,20 @@ bool Validate(Context& context, const At<binary::Export>& value) {
   ErrorsContextGuard guard{*context.errors, value.loc(), "export"};
   bool valid = true;
 
-  if (context.export_names.find(value->name) != context.export_names.end()) {
+  if (!context.export_names.insert(value->name).second) {
     context.errors->OnError(value.loc(),
                             concat("Duplicate export name ", value->name));
     valid = false;
   }
-  context.export_names.insert(value->name);
 
   switch (value->kind) {
     case ExternalKind::Function:
-      valid &= ValidateIndex(context, value->index, static_cast<Index>(context.functions.size()),
-                             "function index");
-      context.declared_functions.insert(value->index);
+      if (ValidateIndex(context, value->index, static_cast<Index>(context.functions.size()),
+                        "function index")) {
+        context.declared_functions.insert(value->index);
+      } else {
+        valid = false;
+      }
       break;
 
     case ExternalKind::Table:
@@ -620,6 +624,13 @@ bool Validate(Context& context, const At<binary::ReferenceType>& value) {
 }
 
 bool Validate(Context& context, const At<binary::Rtt>& value) {
+  ErrorsContextGuard guard{*context.errors, value.loc(), "rtt"};
+  if (value->depth > StackType::kMaxRttDepth) {
+    context.errors->OnError(value->depth.loc(),
+                            concat("Expected rtt depth ", value->depth,
+                                   " to be <= ", StackType::kMaxRttDepth));
+    return false;
+  }
   return true;
 }
 
@@ -720,6 +731,8 @@ bool Validate(Context& context, const At<binary::ValueType>& value) {
   ErrorsContextGuard guard{*context.errors, value.loc(), "value type"};
   if (value->is_reference_type()) {
     return Validate(context, value->reference_type());
+  } else if (value->is_rtt()) {
+    return Validate(context, value->rtt());
   }
   return true;
 }
@@ -761,7 +774,8 @@ bool ValidateKnownSection(Context& context, const optional<T>& value) {
   return valid;
 }
 
-bool Validate(Context& context, const binary::Module& value) {
+bool ValidateSectionsBeforeCode(Context& context,
+                                const binary::Module& value) {
   bool valid = true;
   valid &= BeginTypeSection(context, static_cast<Index>(value.types.size()));
   valid &= ValidateKnownSection(context, value.types);
@@ -775,8 +789,18 @@ bool Validate(Context& context, const binary::Module& value) {
   valid &= ValidateKnownSection(context, value.start);
   valid &= ValidateKnownSection(context, value.element_segments);
   valid &= ValidateKnownSection(context, value.data_count);
+  return valid;
+}
+
+bool ValidateSectionsAfterCode(Context& context, const binary::Module& value) {
+  return ValidateKnownSection(context, value.data_segments);
+}
+
+bool Validate(Context& context, const binary::Module& value) {
+  bool valid = true;
+  valid &= ValidateSectionsBeforeCode(context, value);
   valid &= ValidateKnownSection(context, value.codes);
-  valid &= ValidateKnownSection(context, value.data_segments);
+  valid &= ValidateSectionsAfterCode(context, value);
   return valid;
 }
 
@@ -25,11 +25,16 @@
 #include "wasp/base/formatters.h"
 #include "wasp/base/macros.h"
 #include "wasp/base/types.h"
+#include "wasp/binary/encoding.h"
 #include "wasp/binary/formatters.h"
+#include "wasp/binary/read.h"
+#include "wasp/binary/read/context.h"
+#include "wasp/binary/read/read_var_int.h"
 #include "wasp/valid/context.h"
 #include "wasp/valid/formatters.h"
 #include "wasp/valid/match.h"
 #include "wasp/valid/validate.h"
+#include "wasp/valid/validate_expression.h"
 
 namespace wasp::valid {
 
@@ -613,42 +618,63 @@ bool BrIf(Context& context, Location loc, At<Index> depth) {
       PopAndPushTypes(context, loc, label_.br_types(), label_.br_types()));
 }
 
+// br_table is validated in three steps so the targets can be checked without
+// first collecting them: BrTableDefault, then BrTableTarget for each target,
+// then SetUnreachable.
+const Label* BrTableDefault(Context& context,
+                           Location loc,
+                           At<Index> default_target,
+                           bool* valid) {
+  *valid &= PopType(context, loc, StackType::I32());
+  const auto* default_label = GetLabel(context, default_target);
+  if (default_label) {
+    *valid &= CheckTypes(context, default_target.loc(),
+                         default_label->br_types());
+  }
+  return default_label;
+}
+
+bool BrTableTarget(Context& context, StackTypeSpan br_types, At<Index> target) {
+  const auto* label = GetLabel(context, target);
+  if (!label) {
+    return false;
+  }
+
+  bool valid = true;
+  if (context.features.function_references_enabled()) {
+    if (br_types.size() != label->br_types().size()) {
+      context.errors->OnError(
+          target.loc(),
+          concat("br_table labels must have the same arity; expected ",
+                 br_types.size(), ", got ", label->br_types().size()));
+      valid = false;
+    }
+    valid &= CheckTypes(context, target.loc(), label->br_types());
+  } else {
+    if (br_types != label->br_types()) {
+      context.errors->OnError(
+          target.loc(),
+          concat("br_table labels must have the same signature; expected ",
+                 br_types, ", got ", label->br_types()));
+      valid = false;
+    }
+  }
+  return valid;
+}
+
 bool BrTable(Context& context,
              Location loc,
              const At<BrTableImmediate>& immediate) {
-  bool valid = PopType(context, loc, StackType::I32());
-  const auto* default_label = GetLabel(context, immediate->default_target);
+  bool valid = true;
+  const auto* default_label =
+      BrTableDefault(context, loc, immediate->default_target, &valid);
   if (!default_label) {
     return false;
   }
 
   StackTypeSpan br_types = default_label->br_types();
-  valid &= CheckTypes(context, immediate->default_target.loc(), br_types);
-
   for (auto target : immediate->targets) {
-    const auto* label = GetLabel(context, target);
-    if (label) {
-      if (context.features.function_references_enabled()) {
-        if (br_types.size() != label->br_types().size()) {
-          context.errors->OnError(
-              target.loc(),
-              concat("br_table labels must have the same arity; expected ",
-                     br_types.size(), ", got ", label->br_types().size()));
-          valid = false;
-        }
-        valid &= CheckTypes(context, target.loc(), label->br_types());
-      } else {
-        if (br_types != label->br_types()) {
-          context.errors->OnError(
-              target.loc(),
-              concat("br_table labels must have the same signature; expected ",
-                     br_types, ", got ", label->br_types()));
-          valid = false;
-        }
-      }
-    } else {
-      valid = false;
-    }
+    valid &= BrTableTarget(context, br_types, target);
   }
   SetUnreachable(context);
   return valid;
@@ -758,8 +784,7 @@ bool TableSet(Context& context, Location loc, At<Index> index) {
 }
 
 bool RefFunc(Context& context, Location loc, At<Index> index) {
-  if (context.declared_functions.find(index) ==
-      context.declared_functions.end()) {
+  if (context.declared_functions.count(index) == 0) {
     context.errors->OnError(loc,
                             concat("Undeclared function reference ", index));
     return false;
@@ -772,11 +797,13 @@ bool RefFunc(Context& context, Location loc, At<Index> index) {
 }
 
 bool CheckAlignment(Context& context,
-                    const At<Instruction>& instruction,
+                    Location loc,
+                    Opcode opcode,
+                    const At<MemArgImmediate>& mem_arg,
                     u32 max_align) {
-  if (instruction->mem_arg_immediate()->align_log2 > max_align) {
-    context.errors->OnError(instruction.loc(),
-                            concat("Invalid alignment ", instruction));
+  if (mem_arg->align_log2 > max_align) {
+    context.errors->OnError(
+        loc, concat("Invalid alignment ", Instruction{opcode, mem_arg}));
     return false;
   }
   return true;
@@ -796,12 +823,15 @@ StackTypeSpan GetIndexTypeSpan(const optional<MemoryType>& memory_type) {
   return span_i32;
 }
 
-bool Load(Context& context, Location loc, const At<Instruction>& instruction) {
+bool Load(Context& context,
+          Location loc,
+          Opcode opcode,
+          const At<MemArgImmediate>& mem_arg) {
   auto memory_type = GetMemoryType(context, 0);
   auto index_span = GetIndexTypeSpan(memory_type);
   StackTypeSpan span;
   u32 max_align;
-  switch (instruction->opcode) {
+  switch (opcode) {
     case Opcode::I32Load:    span = span_i32; max_align = 2; break;
     case Opcode::I64Load:    span = span_i64; max_align = 3; break;
     case Opcode::F32Load:    span = span_f32; max_align = 2; break;
@@ -833,16 +863,19 @@ bool Load(Context& context, Location loc, const At<Instruction>& instruction) {
       WASP_UNREACHABLE();
   }
 
-  bool valid = CheckAlignment(context, instruction, max_align);
+  bool valid = CheckAlignment(context, loc, opcode, mem_arg, max_align);
   return AllTrue(memory_type, valid,
                  PopAndPushTypes(context, loc, index_span, span));
 }
 
-bool Store(Context& context, Location loc, const At<Instruction>& instruction) {
+bool Store(Context& context,
+           Location loc,
+           Opcode opcode,
+           const At<MemArgImmediate>& mem_arg) {
   auto memory_type = GetMemoryType(context, 0);
   StackType type;
   u32 max_align;
-  switch (instruction->opcode) {
+  switch (opcode) {
     case Opcode::I32Store:   type = StackType::I32(); max_align = 2; break;
     case Opcode::I64Store:   type = StackType::I64(); max_align = 3; break;
     case Opcode::F32Store:   type = StackType::F32(); max_align = 2; break;
@@ -858,7 +891,7 @@ bool Store(Context& context, Location loc, const At<Instruction>& instruction) {
   }
 
   StackTypeList params{GetIndexType(memory_type), type};
-  bool valid = CheckAlignment(context, instruction, max_align);
+  bool valid = CheckAlignment(context, loc, opcode, mem_arg, max_align);
   return AllTrue(memory_type, valid, PopTypes(context, loc, params));
 }
 
@@ -1429,11 +1462,11 @@ bool RttSub(Context& context, Location loc, const At<HeapType>& immediate) {
   if (type_opt && type_opt->is_any()) {
     return true;
   }
-  u32 new_depth = old_rtt->depth + 1;
-  if (new_depth == 0) {
-    context.errors->OnError(loc, concat("Invalid rtt depth", old_rtt->depth));
+  if (old_rtt->depth >= StackType::kMaxRttDepth) {
+    context.errors->OnError(loc, concat("Invalid rtt depth ", old_rtt->depth));
     return false;
   }
+  u32 new_depth = old_rtt->depth + 1;
   Rtt new_rtt{new_depth, immediate};
   if (!IsMatch(context, old_rtt->type, new_rtt.type)) {
     context.errors->OnError(
@@ -1753,480 +1786,215 @@ bool ArrayLen(Context& context, Location loc, const At<Index>& immediate) {
   return PopAndPushTypes(context, loc, params, span_i32);
 }
 
-}  // namespace
-
-bool Validate(Context& context,
-              const At<Locals>& value,
-              RequireDefaultable require_defaultable) {
-  ErrorsContextGuard guard{*context.errors, value.loc(), "locals"};
-  bool valid = true;
-  if (require_defaultable == RequireDefaultable::Yes) {
-    valid &= CheckDefaultable(context, value->type, "local type");
-  }
-  valid &= Validate(context, value->type);
+// Gets the signature of an instruction that has no immediates and only pops
+// and pushes fixed types. Returns false for all other instructions.
+bool GetSimpleSignature(Opcode opcode,
+                        StackTypeSpan* params,
+                        StackTypeSpan* results) {
+  switch (opcode) {
+    case Opcode::I32Eqz:
+    case Opcode::I32Clz:
+    case Opcode::I32Ctz:
+    case Opcode::I32Popcnt:
+    case Opcode::I32Extend8S:
+    case Opcode::I32Extend16S:
+      *params = span_i32, *results = span_i32;
+      return true;
 
-  if (!context.locals.Append(value->count, value->type)) {
-    const Index max = std::numeric_limits<Index>::max();
-    context.errors->OnError(
-        value.loc(),
-        concat("Too many locals; max is ", max, ", got ",
-               static_cast<u64>(context.locals.GetCount()) + value->count));
-    valid = false;
-  }
-  return valid;
-}
+    case Opcode::I64Eqz:
+    case Opcode::I32WrapI64:
+      *params = span_i64, *results = span_i32;
+      return true;
 
-bool Validate(Context& context,
-              const At<LocalsList>& value,
-              RequireDefaultable require_defaultable) {
-  bool valid = true;
-  for (auto&& locals : *value) {
-    valid &= Validate(context, locals, require_defaultable);
-  }
-  return valid;
-}
+    case Opcode::I64Clz:
+    case Opcode::I64Ctz:
+    case Opcode::I64Popcnt:
+    case Opcode::I64Extend8S:
+    case Opcode::I64Extend16S:
+    case Opcode::I64Extend32S:
+      *params = span_i64, *results = span_i64;
+      return true;
 
-bool Validate(Context& context, const At<Instruction>& value) {
-  ErrorsContextGuard guard{*context.errors, value.loc(), "instruction"};
-  if (context.label_stack.empty()) {
-    context.errors->OnError(value.loc(),
-                            "Unexpected instruction after function end");
-    return false;
-  }
+    case Opcode::I32Eq:
+    case Opcode::I32Ne:
+    case Opcode::I32LtS:
+    case Opcode::I32LtU:
+    case Opcode::I32GtS:
+    case Opcode::I32GtU:
+    case Opcode::I32LeS:
+    case Opcode::I32LeU:
+    case Opcode::I32GeS:
+    case Opcode::I32GeU:
+    case Opcode::I32Add:
+    case Opcode::I32Sub:
+    case Opcode::I32Mul:
+    case Opcode::I32DivS:
+    case Opcode::I32DivU:
+    case Opcode::I32RemS:
+    case Opcode::I32RemU:
+    case Opcode::I32And:
+    case Opcode::I32Or:
+    case Opcode::I32Xor:
+    case Opcode::I32Shl:
+    case Opcode::I32ShrS:
+    case Opcode::I32ShrU:
+    case Opcode::I32Rotl:
+    case Opcode::I32Rotr:
+      *params = span_i32_i32, *results = span_i32;
+      return true;
 
-  Location loc = value.loc();
+    case Opcode::I64Eq:
+    case Opcode::I64Ne:
+    case Opcode::I64LtS:
+    case Opcode::I64LtU:
+    case Opcode::I64GtS:
+    case Opcode::I64GtU:
+    case Opcode::I64LeS:
+    case Opcode::I64LeU:
+    case Opcode::I64GeS:
+    case Opcode::I64GeU:
+      *params = span_i64_i64, *results = span_i32;
+      return true;
 
-  StackTypeSpan params, results;
-  switch (value->opcode) {
-    case Opcode::Unreachable:
-      SetUnreachable(context);
+    case Opcode::F32Eq:
+    case Opcode::F32Ne:
+    case Opcode::F32Lt:
+    case Opcode::F32Gt:
+    case Opcode::F32Le:
+    case Opcode::F32Ge:
+      *params = span_f32_f32, *results = span_i32;
       return true;
 
-    case Opcode::Nop:
+    case Opcode::F64Eq:
+    case Opcode::F64Ne:
+    case Opcode::F64Lt:
+    case Opcode::F64Gt:
+    case Opcode::F64Le:
+    case Opcode::F64Ge:
+      *params = span_f64_f64, *results = span_i32;
       return true;
 
-    case Opcode::Block:
-      return PushLabel(context, loc, LabelType::Block,
-                       value->block_type_immediate());
+    case Opcode::I64Add:
+    case Opcode::I64Sub:
+    case Opcode::I64Mul:
+    case Opcode::I64DivS:
+    case Opcode::I64DivU:
+    case Opcode::I64RemS:
+    case Opcode::I64RemU:
+    case Opcode::I64And:
+    case Opcode::I64Or:
+    case Opcode::I64Xor:
+    case Opcode::I64Shl:
+    case Opcode::I64ShrS:
+    case Opcode::I64ShrU:
+    case Opcode::I64Rotl:
+    case Opcode::I64Rotr:
+      *params = span_i64_i64, *results = span_i64;
+      return true;
 
-    case Opcode::Loop:
-      return PushLabel(context, loc, LabelType::Loop,
-                       value->block_type_immediate());
+    case Opcode::F32Abs:
+    case Opcode::F32Neg:
+    case Opcode::F32Ceil:
+    case Opcode::F32Floor:
+    case Opcode::F32Trunc:
+    case Opcode::F32Nearest:
+    case Opcode::F32Sqrt:
+      *params = span_f32, *results = span_f32;
+      return true;
 
-    case Opcode::If: {
-      bool valid = PopType(context, loc, StackType::I32());
-      valid &=
-          PushLabel(context, loc, LabelType::If, value->block_type_immediate());
-      return valid;
-    }
+    case Opcode::F32Add:
+    case Opcode::F32Sub:
+    case Opcode::F32Mul:
+    case Opcode::F32Div:
+    case Opcode::F32Min:
+    case Opcode::F32Max:
+    case Opcode::F32Copysign:
+      *params = span_f32_f32, *results = span_f32;
+      return true;
 
-    case Opcode::Else:
-      return Else(context, loc);
+    case Opcode::F64Abs:
+    case Opcode::F64Neg:
+    case Opcode::F64Ceil:
+    case Opcode::F64Floor:
+    case Opcode::F64Trunc:
+    case Opcode::F64Nearest:
+    case Opcode::F64Sqrt:
+      *params = span_f64, *results = span_f64;
+      return true;
 
-    case Opcode::End:
-      return End(context, loc);
+    case Opcode::F64Add:
+    case Opcode::F64Sub:
+    case Opcode::F64Mul:
+    case Opcode::F64Div:
+    case Opcode::F64Min:
+    case Opcode::F64Max:
+    case Opcode::F64Copysign:
+      *params = span_f64_f64, *results = span_f64;
+      return true;
 
-    case Opcode::Try:
-      return PushLabel(context, loc, LabelType::Try,
-                       value->block_type_immediate());
+    case Opcode::I32TruncF32S:
+    case Opcode::I32TruncF32U:
+    case Opcode::I32ReinterpretF32:
+    case Opcode::I32TruncSatF32S:
+    case Opcode::I32TruncSatF32U:
+      *params = span_f32, *results = span_i32;
+      return true;
 
-    case Opcode::Catch:
-      return Catch(context, loc);
+    case Opcode::I32TruncF64S:
+    case Opcode::I32TruncF64U:
+    case Opcode::I32TruncSatF64S:
+    case Opcode::I32TruncSatF64U:
+      *params = span_f64, *results = span_i32;
+      return true;
 
-    case Opcode::Throw:
-      return Throw(context, loc, value->index_immediate());
+    case Opcode::I64ExtendI32S:
+    case Opcode::I64ExtendI32U:
+      *params = span_i32, *results = span_i64;
+      return true;
 
-    case Opcode::Rethrow:
-      return Rethrow(context, loc);
+    case Opcode::I64TruncF32S:
+    case Opcode::I64TruncF32U:
+    case Opcode::I64TruncSatF32S:
+    case Opcode::I64TruncSatF32U:
+      *params = span_f32, *results = span_i64;
+      return true;
 
-    case Opcode::BrOnExn:
-      return BrOnExn(context, loc, value->br_on_exn_immediate());
+    case Opcode::I64TruncF64S:
+    case Opcode::I64TruncF64U:
+    case Opcode::I64ReinterpretF64:
+    case Opcode::I64TruncSatF64S:
+    case Opcode::I64TruncSatF64U:
+      *params = span_f64, *results = span_i64;
+      return true;
 
-    case Opcode::Br:
-      return Br(context, loc, value->index_immediate());
+    case Opcode::F32ConvertI32S:
+    case Opcode::F32ConvertI32U:
+    case Opcode::F32ReinterpretI32:
+      *params = span_i32, *results = span_f32;
+      return true;
 
-    case Opcode::BrIf:
-      return BrIf(context, loc, value->index_immediate());
+    case Opcode::F32ConvertI64S:
+    case Opcode::F32ConvertI64U:
+      *params = span_i64, *results = span_f32;
+      return true;
 
-    case Opcode::BrTable:
-      return BrTable(context, loc, value->br_table_immediate());
-
-    case Opcode::Return:
-      return Br(context, loc, static_cast<Index>(context.label_stack.size() - 1));
-
-    case Opcode::Call:
-      return Call(context, loc, value->index_immediate());
-
-    case Opcode::CallIndirect:
-      return CallIndirect(context, loc, value->call_indirect_immediate());
-
-    case Opcode::Drop:
-      return DropTypes(context, loc, 1);
-
-    case Opcode::Select:
-      return Select(context, loc);
-
-    case Opcode::SelectT:
-      return SelectT(context, loc, value->select_immediate());
-
-    case Opcode::LocalGet:
-      return LocalGet(context, value->index_immediate());
-
-    case Opcode::LocalSet:
-      return LocalSet(context, loc, value->index_immediate());
-
-    case Opcode::LocalTee:
-      return LocalTee(context, loc, value->index_immediate());
-
-    case Opcode::GlobalGet:
-      return GlobalGet(context, value->index_immediate());
-
-    case Opcode::GlobalSet:
-      return GlobalSet(context, loc, value->index_immediate());
-
-    case Opcode::TableGet:
-      return TableGet(context, loc, value->index_immediate());
-
-    case Opcode::TableSet:
-      return TableSet(context, loc, value->index_immediate());
-
-    case Opcode::RefNull:
-      PushType(context, ToStackType(value->heap_type_immediate()));
-      return true;
-
-    case Opcode::RefIsNull: {
-      auto type = PopReferenceType(context, loc);
-      PushType(context, StackType::I32());
-      return AllTrue(type);
-    }
-
-    case Opcode::RefFunc:
-      return RefFunc(context, loc, value->index_immediate());
-
-    case Opcode::BrOnNull:
-      return BrOnNull(context, loc, value->index_immediate());
-
-    case Opcode::RefAsNonNull:
-      return RefAsNonNull(context, loc);
-
-    case Opcode::CallRef:
-      return CallRef(context, loc);
-
-    case Opcode::ReturnCallRef:
-      return ReturnCallRef(context, loc);
-
-    case Opcode::FuncBind:
-      return FuncBind(context, loc, value->func_bind_immediate());
-
-    case Opcode::Let:
-      return Let(context, loc, value->let_immediate());
-
-    case Opcode::I32Load:
-    case Opcode::I64Load:
-    case Opcode::F32Load:
-    case Opcode::F64Load:
-    case Opcode::I32Load8S:
-    case Opcode::I32Load8U:
-    case Opcode::I32Load16S:
-    case Opcode::I32Load16U:
-    case Opcode::I64Load8S:
-    case Opcode::I64Load8U:
-    case Opcode::I64Load16S:
-    case Opcode::I64Load16U:
-    case Opcode::I64Load32S:
-    case Opcode::I64Load32U:
-    case Opcode::V128Load:
-    case Opcode::V128Load8Splat:
-    case Opcode::V128Load16Splat:
-    case Opcode::V128Load32Splat:
-    case Opcode::V128Load64Splat:
-    case Opcode::V128Load8X8S:
-    case Opcode::V128Load8X8U:
-    case Opcode::V128Load16X4S:
-    case Opcode::V128Load16X4U:
-    case Opcode::V128Load32X2S:
-    case Opcode::V128Load32X2U:
-    case Opcode::V128Load32Zero:
-    case Opcode::V128Load64Zero:
-      return Load(context, loc, value);
-
-    case Opcode::I32Store:
-    case Opcode::I64Store:
-    case Opcode::F32Store:
-    case Opcode::F64Store:
-    case Opcode::I32Store8:
-    case Opcode::I32Store16:
-    case Opcode::I64Store8:
-    case Opcode::I64Store16:
-    case Opcode::I64Store32:
-    case Opcode::V128Store:
-      return Store(context, loc, value);
-
-    case Opcode::MemorySize:
-      return MemorySize(context);
-
-    case Opcode::MemoryGrow:
-      return MemoryGrow(context, loc);
-
-    case Opcode::I32Const:
-      PushType(context, StackType::I32());
-      return true;
-
-    case Opcode::I64Const:
-      PushType(context, StackType::I64());
-      return true;
-
-    case Opcode::F32Const:
-      PushType(context, StackType::F32());
-      return true;
-
-    case Opcode::F64Const:
-      PushType(context, StackType::F64());
-      return true;
-
-    case Opcode::I32Eqz:
-    case Opcode::I32Clz:
-    case Opcode::I32Ctz:
-    case Opcode::I32Popcnt:
-    case Opcode::I32Extend8S:
-    case Opcode::I32Extend16S:
-      params = span_i32, results = span_i32;
-      break;
-
-    case Opcode::I64Eqz:
-    case Opcode::I32WrapI64:
-      params = span_i64, results = span_i32;
-      break;
-
-    case Opcode::I64Clz:
-    case Opcode::I64Ctz:
-    case Opcode::I64Popcnt:
-    case Opcode::I64Extend8S:
-    case Opcode::I64Extend16S:
-    case Opcode::I64Extend32S:
-      params = span_i64, results = span_i64;
-      break;
-
-    case Opcode::I32Eq:
-    case Opcode::I32Ne:
-    case Opcode::I32LtS:
-    case Opcode::I32LtU:
-    case Opcode::I32GtS:
-    case Opcode::I32GtU:
-    case Opcode::I32LeS:
-    case Opcode::I32LeU:
-    case Opcode::I32GeS:
-    case Opcode::I32GeU:
-    case Opcode::I32Add:
-    case Opcode::I32Sub:
-    case Opcode::I32Mul:
-    case Opcode::I32DivS:
-    case Opcode::I32DivU:
-    case Opcode::I32RemS:
-    case Opcode::I32RemU:
-    case Opcode::I32And:
-    case Opcode::I32Or:
-    case Opcode::I32Xor:
-    case Opcode::I32Shl:
-    case Opcode::I32ShrS:
-    case Opcode::I32ShrU:
-    case Opcode::I32Rotl:
-    case Opcode::I32Rotr:
-      params = span_i32_i32, results = span_i32;
-      break;
-
-    case Opcode::I64Eq:
-    case Opcode::I64Ne:
-    case Opcode::I64LtS:
-    case Opcode::I64LtU:
-    case Opcode::I64GtS:
-    case Opcode::I64GtU:
-    case Opcode::I64LeS:
-    case Opcode::I64LeU:
-    case Opcode::I64GeS:
-    case Opcode::I64GeU:
-      params = span_i64_i64, results = span_i32;
-      break;
-
-    case Opcode::F32Eq:
-    case Opcode::F32Ne:
-    case Opcode::F32Lt:
-    case Opcode::F32Gt:
-    case Opcode::F32Le:
-    case Opcode::F32Ge:
-      params = span_f32_f32, results = span_i32;
-      break;
-
-    case Opcode::F64Eq:
-    case Opcode::F64Ne:
-    case Opcode::F64Lt:
-    case Opcode::F64Gt:
-    case Opcode::F64Le:
-    case Opcode::F64Ge:
-      params = span_f64_f64, results = span_i32;
-      break;
-
-    case Opcode::I64Add:
-    case Opcode::I64Sub:
-    case Opcode::I64Mul:
-    case Opcode::I64DivS:
-    case Opcode::I64DivU:
-    case Opcode::I64RemS:
-    case Opcode::I64RemU:
-    case Opcode::I64And:
-    case Opcode::I64Or:
-    case Opcode::I64Xor:
-    case Opcode::I64Shl:
-    case Opcode::I64ShrS:
-    case Opcode::I64ShrU:
-    case Opcode::I64Rotl:
-    case Opcode::I64Rotr:
-      params = span_i64_i64, results = span_i64;
-      break;
-
-    case Opcode::F32Abs:
-    case Opcode::F32Neg:
-    case Opcode::F32Ceil:
-    case Opcode::F32Floor:
-    case Opcode::F32Trunc:
-    case Opcode::F32Nearest:
-    case Opcode::F32Sqrt:
-      params = span_f32, results = span_f32;
-      break;
-
-    case Opcode::F32Add:
-    case Opcode::F32Sub:
-    case Opcode::F32Mul:
-    case Opcode::F32Div:
-    case Opcode::F32Min:
-    case Opcode::F32Max:
-    case Opcode::F32Copysign:
-      params = span_f32_f32, results = span_f32;
-      break;
-
-    case Opcode::F64Abs:
-    case Opcode::F64Neg:
-    case Opcode::F64Ceil:
-    case Opcode::F64Floor:
-    case Opcode::F64Trunc:
-    case Opcode::F64Nearest:
-    case Opcode::F64Sqrt:
-      params = span_f64, results = span_f64;
-      break;
-
-    case Opcode::F64Add:
-    case Opcode::F64Sub:
-    case Opcode::F64Mul:
-    case Opcode::F64Div:
-    case Opcode::F64Min:
-    case Opcode::F64Max:
-    case Opcode::F64Copysign:
-      params = span_f64_f64, results = span_f64;
-      break;
-
-    case Opcode::I32TruncF32S:
-    case Opcode::I32TruncF32U:
-    case Opcode::I32ReinterpretF32:
-    case Opcode::I32TruncSatF32S:
-    case Opcode::I32TruncSatF32U:
-      params = span_f32, results = span_i32;
-      break;
-
-    case Opcode::I32TruncF64S:
-    case Opcode::I32TruncF64U:
-    case Opcode::I32TruncSatF64S:
-    case Opcode::I32TruncSatF64U:
-      params = span_f64, results = span_i32;
-      break;
-
-    case Opcode::I64ExtendI32S:
-    case Opcode::I64ExtendI32U:
-      params = span_i32, results = span_i64;
-      break;
-
-    case Opcode::I64TruncF32S:
-    case Opcode::I64TruncF32U:
-    case Opcode::I64TruncSatF32S:
-    case Opcode::I64TruncSatF32U:
-      params = span_f32, results = span_i64;
-      break;
-
-    case Opcode::I64TruncF64S:
-    case Opcode::I64TruncF64U:
-    case Opcode::I64ReinterpretF64:
-    case Opcode::I64TruncSatF64S:
-    case Opcode::I64TruncSatF64U:
-      params = span_f64, results = span_i64;
-      break;
-
-    case Opcode::F32ConvertI32S:
-    case Opcode::F32ConvertI32U:
-    case Opcode::F32ReinterpretI32:
-      params = span_i32, results = span_f32;
-      break;
-
-    case Opcode::F32ConvertI64S:
-    case Opcode::F32ConvertI64U:
-      params = span_i64, results = span_f32;
-      break;
-
-    case Opcode::F32DemoteF64:
-      params = span_f64, results = span_f32;
-      break;
+    case Opcode::F32DemoteF64:
+      *params = span_f64, *results = span_f32;
+      return true;
 
     case Opcode::F64ConvertI32S:
     case Opcode::F64ConvertI32U:
-      params = span_i32, results = span_f64;
-      break;
-
-    case Opcode::F64ConvertI64S:
-    case Opcode::F64ConvertI64U:
-    case Opcode::F64ReinterpretI64:
-      params = span_i64, results = span_f64;
-      break;
-
-    case Opcode::F64PromoteF32:
-      params = span_f32, results = span_f64;
-      break;
-
-    case Opcode::ReturnCall:
-      return ReturnCall(context, loc, value->index_immediate());
-
-    case Opcode::ReturnCallIndirect:
-      return ReturnCallIndirect(context, loc, value->call_indirect_immediate());
-
-    case Opcode::MemoryInit:
-      return MemoryInit(context, loc, value->init_immediate());
-
-    case Opcode::DataDrop:
-      return DataDrop(context, value->index_immediate());
-
-    case Opcode::MemoryCopy:
-      return MemoryCopy(context, loc, value->copy_immediate());
-
-    case Opcode::MemoryFill:
-      return MemoryFill(context, loc);
-
-    case Opcode::TableInit:
-      return TableInit(context, loc, value->init_immediate());
-
-    case Opcode::ElemDrop:
-      return ElemDrop(context, value->index_immediate());
-
-    case Opcode::TableCopy:
-      return TableCopy(context, loc, value->copy_immediate());
-
-    case Opcode::TableGrow:
-      return TableGrow(context, loc, value->index_immediate());
-
-    case Opcode::TableSize:
-      return TableSize(context, value->index_immediate());
-
-    case Opcode::TableFill:
-      return TableFill(context, loc, value->index_immediate());
+      *params = span_i32, *results = span_f64;
+      return true;
 
-    case Opcode::V128Const:
-      PushType(context, StackType::V128());
+    case Opcode::F64ConvertI64S:
+    case Opcode::F64ConvertI64U:
+    case Opcode::F64ReinterpretI64:
+      *params = span_i64, *results = span_f64;
+      return true;
+
+    case Opcode::F64PromoteF32:
+      *params = span_f32, *results = span_f64;
       return true;
 
     case Opcode::V128Not:
@@ -2263,12 +2031,12 @@ bool Validate(Context& context, const At<Instruction>& value) {
     case Opcode::I8X16Abs:
     case Opcode::I16X8Abs:
     case Opcode::I32X4Abs:
-      params = span_v128, results = span_v128;
-      break;
+      *params = span_v128, *results = span_v128;
+      return true;
 
     case Opcode::V128BitSelect:
-      params = span_v128_v128_v128, results = span_v128;
-      break;
+      *params = span_v128_v128_v128, *results = span_v128;
+      return true;
 
     case Opcode::I8X16Eq:
     case Opcode::I8X16Ne:
@@ -2371,29 +2139,343 @@ bool Validate(Context& context, const At<Instruction>& value) {
     case Opcode::V128Andnot:
     case Opcode::I8X16AvgrU:
     case Opcode::I16X8AvgrU:
-      params = span_v128_v128, results = span_v128;
-      break;
+      *params = span_v128_v128, *results = span_v128;
+      return true;
+
+    case Opcode::I8X16Splat:
+    case Opcode::I16X8Splat:
+    case Opcode::I32X4Splat:
+      *params = span_i32, *results = span_v128;
+      return true;
+
+    case Opcode::I64X2Splat:
+      *params = span_i64, *results = span_v128;
+      return true;
+
+    case Opcode::F32X4Splat:
+      *params = span_f32, *results = span_v128;
+      return true;
+
+    case Opcode::F64X2Splat:
+      *params = span_f64, *results = span_v128;
+      return true;
+
+    case Opcode::I8X16AnyTrue:
+    case Opcode::I8X16AllTrue:
+    case Opcode::I8X16Bitmask:
+    case Opcode::I16X8AnyTrue:
+    case Opcode::I16X8AllTrue:
+    case Opcode::I16X8Bitmask:
+    case Opcode::I32X4AnyTrue:
+    case Opcode::I32X4AllTrue:
+    case Opcode::I32X4Bitmask:
+      *params = span_v128, *results = span_i32;
+      return true;
+
+    case Opcode::I8X16Shl:
+    case Opcode::I8X16ShrS:
+    case Opcode::I8X16ShrU:
+    case Opcode::I16X8Shl:
+    case Opcode::I16X8ShrS:
+    case Opcode::I16X8ShrU:
+    case Opcode::I32X4Shl:
+    case Opcode::I32X4ShrS:
+    case Opcode::I32X4ShrU:
+    case Opcode::I64X2Shl:
+    case Opcode::I64X2ShrS:
+    case Opcode::I64X2ShrU:
+      *params = span_v128_i32, *results = span_v128;
+      return true;
+
+    case Opcode::RefEq:
+      *params = span_eqref_eqref, *results = span_i32;
+      return true;
+
+    case Opcode::I31New:
+      *params = span_i32, *results = span_i31ref;
+      return true;
+
+    case Opcode::I31GetS:
+    case Opcode::I31GetU:
+      *params = span_i31ref, *results = span_i32;
+      return true;
+
+    default:
+      return false;
+  }
+}
+
+}  // namespace
+
+bool Validate(Context& context,
+              const At<Locals>& value,
+              RequireDefaultable require_defaultable) {
+  ErrorsContextGuard guard{*context.errors, value.loc(), "locals"};
+  bool valid = true;
+  if (require_defaultable == RequireDefaultable::Yes) {
+    valid &= CheckDefaultable(context, value->type, "local type");
+  }
+  valid &= Validate(context, value->type);
+
+  if (!context.locals.Append(value->count, value->type)) {
+    const Index max = std::numeric_limits<Index>::max();
+    context.errors->OnError(
+        value.loc(),
+        concat("Too many locals; max is ", max, ", got ",
+               static_cast<u64>(context.locals.GetCount()) + value->count));
+    valid = false;
+  }
+  return valid;
+}
+
+bool Validate(Context& context,
+              const At<LocalsList>& value,
+              RequireDefaultable require_defaultable) {
+  bool valid = true;
+  for (auto&& locals : *value) {
+    valid &= Validate(context, locals, require_defaultable);
+  }
+  return valid;
+}
+
+bool Validate(Context& context, const At<Instruction>& value) {
+  ErrorsContextGuard guard{*context.errors, value.loc(), "instruction"};
+  if (context.label_stack.empty()) {
+    context.errors->OnError(value.loc(),
+                            "Unexpected instruction after function end");
+    return false;
+  }
+
+  Location loc = value.loc();
+  switch (value->opcode) {
+    case Opcode::Unreachable:
+      SetUnreachable(context);
+      return true;
+
+    case Opcode::Nop:
+      return true;
+
+    case Opcode::Block:
+      return PushLabel(context, loc, LabelType::Block,
+                       value->block_type_immediate());
+
+    case Opcode::Loop:
+      return PushLabel(context, loc, LabelType::Loop,
+                       value->block_type_immediate());
+
+    case Opcode::If: {
+      bool valid = PopType(context, loc, StackType::I32());
+      valid &=
+          PushLabel(context, loc, LabelType::If, value->block_type_immediate());
+      return valid;
+    }
+
+    case Opcode::Else:
+      return Else(context, loc);
+
+    case Opcode::End:
+      return End(context, loc);
+
+    case Opcode::Try:
+      return PushLabel(context, loc, LabelType::Try,
+                       value->block_type_immediate());
+
+    case Opcode::Catch:
+      return Catch(context, loc);
+
+    case Opcode::Throw:
+      return Throw(context, loc, value->index_immediate());
+
+    case Opcode::Rethrow:
+      return Rethrow(context, loc);
+
+    case Opcode::BrOnExn:
+      return BrOnExn(context, loc, value->br_on_exn_immediate());
+
+    case Opcode::Br:
+      return Br(context, loc, value->index_immediate());
+
+    case Opcode::BrIf:
+      return BrIf(context, loc, value->index_immediate());
+
+    case Opcode::BrTable:
+      return BrTable(context, loc, value->br_table_immediate());
+
+    case Opcode::Return:
+      return Br(context, loc, static_cast<Index>(context.label_stack.size() - 1));
+
+    case Opcode::Call:
+      return Call(context, loc, value->index_immediate());
+
+    case Opcode::CallIndirect:
+      return CallIndirect(context, loc, value->call_indirect_immediate());
+
+    case Opcode::Drop:
+      return DropTypes(context, loc, 1);
+
+    case Opcode::Select:
+      return Select(context, loc);
+
+    case Opcode::SelectT:
+      return SelectT(context, loc, value->select_immediate());
+
+    case Opcode::LocalGet:
+      return LocalGet(context, value->index_immediate());
+
+    case Opcode::LocalSet:
+      return LocalSet(context, loc, value->index_immediate());
+
+    case Opcode::LocalTee:
+      return LocalTee(context, loc, value->index_immediate());
+
+    case Opcode::GlobalGet:
+      return GlobalGet(context, value->index_immediate());
+
+    case Opcode::GlobalSet:
+      return GlobalSet(context, loc, value->index_immediate());
+
+    case Opcode::TableGet:
+      return TableGet(context, loc, value->index_immediate());
+
+    case Opcode::TableSet:
+      return TableSet(context, loc, value->index_immediate());
+
+    case Opcode::RefNull:
+      PushType(context, ToStackType(value->heap_type_immediate()));
+      return true;
+
+    case Opcode::RefIsNull: {
+      auto type = PopReferenceType(context, loc);
+      PushType(context, StackType::I32());
+      return AllTrue(type);
+    }
+
+    case Opcode::RefFunc:
+      return RefFunc(context, loc, value->index_immediate());
+
+    case Opcode::BrOnNull:
+      return BrOnNull(context, loc, value->index_immediate());
+
+    case Opcode::RefAsNonNull:
+      return RefAsNonNull(context, loc);
+
+    case Opcode::CallRef:
+      return CallRef(context, loc);
+
+    case Opcode::ReturnCallRef:
+      return ReturnCallRef(context, loc);
+
+    case Opcode::FuncBind:
+      return FuncBind(context, loc, value->func_bind_immediate());
+
+    case Opcode::Let:
+      return Let(context, loc, value->let_immediate());
+
+    case Opcode::I32Load:
+    case Opcode::I64Load:
+    case Opcode::F32Load:
+    case Opcode::F64Load:
+    case Opcode::I32Load8S:
+    case Opcode::I32Load8U:
+    case Opcode::I32Load16S:
+    case Opcode::I32Load16U:
+    case Opcode::I64Load8S:
+    case Opcode::I64Load8U:
+    case Opcode::I64Load16S:
+    case Opcode::I64Load16U:
+    case Opcode::I64Load32S:
+    case Opcode::I64Load32U:
+    case Opcode::V128Load:
+    case Opcode::V128Load8Splat:
+    case Opcode::V128Load16Splat:
+    case Opcode::V128Load32Splat:
+    case Opcode::V128Load64Splat:
+    case Opcode::V128Load8X8S:
+    case Opcode::V128Load8X8U:
+    case Opcode::V128Load16X4S:
+    case Opcode::V128Load16X4U:
+    case Opcode::V128Load32X2S:
+    case Opcode::V128Load32X2U:
+    case Opcode::V128Load32Zero:
+    case Opcode::V128Load64Zero:
+      return Load(context, loc, value->opcode, value->mem_arg_immediate());
 
-    case Opcode::I8X16Shuffle:
-      return SimdShuffle(context, loc, value->shuffle_immediate());
+    case Opcode::I32Store:
+    case Opcode::I64Store:
+    case Opcode::F32Store:
+    case Opcode::F64Store:
+    case Opcode::I32Store8:
+    case Opcode::I32Store16:
+    case Opcode::I64Store8:
+    case Opcode::I64Store16:
+    case Opcode::I64Store32:
+    case Opcode::V128Store:
+      return Store(context, loc, value->opcode, value->mem_arg_immediate());
 
-    case Opcode::I8X16Splat:
-    case Opcode::I16X8Splat:
-    case Opcode::I32X4Splat:
-      params = span_i32, results = span_v128;
-      break;
+    case Opcode::MemorySize:
+      return MemorySize(context);
 
-    case Opcode::I64X2Splat:
-      params = span_i64, results = span_v128;
-      break;
+    case Opcode::MemoryGrow:
+      return MemoryGrow(context, loc);
 
-    case Opcode::F32X4Splat:
-      params = span_f32, results = span_v128;
-      break;
+    case Opcode::I32Const:
+      PushType(context, StackType::I32());
+      return true;
 
-    case Opcode::F64X2Splat:
-      params = span_f64, results = span_v128;
-      break;
+    case Opcode::I64Const:
+      PushType(context, StackType::I64());
+      return true;
+
+    case Opcode::F32Const:
+      PushType(context, StackType::F32());
+      return true;
+
+    case Opcode::F64Const:
+      PushType(context, StackType::F64());
+      return true;
+
+    case Opcode::ReturnCall:
+      return ReturnCall(context, loc, value->index_immediate());
+
+    case Opcode::ReturnCallIndirect:
+      return ReturnCallIndirect(context, loc, value->call_indirect_immediate());
+
+    case Opcode::MemoryInit:
+      return MemoryInit(context, loc, value->init_immediate());
+
+    case Opcode::DataDrop:
+      return DataDrop(context, value->index_immediate());
+
+    case Opcode::MemoryCopy:
+      return MemoryCopy(context, loc, value->copy_immediate());
+
+    case Opcode::MemoryFill:
+      return MemoryFill(context, loc);
+
+    case Opcode::TableInit:
+      return TableInit(context, loc, value->init_immediate());
+
+    case Opcode::ElemDrop:
+      return ElemDrop(context, value->index_immediate());
+
+    case Opcode::TableCopy:
+      return TableCopy(context, loc, value->copy_immediate());
+
+    case Opcode::TableGrow:
+      return TableGrow(context, loc, value->index_immediate());
+
+    case Opcode::TableSize:
+      return TableSize(context, value->index_immediate());
+
+    case Opcode::TableFill:
+      return TableFill(context, loc, value->index_immediate());
+
+    case Opcode::V128Const:
+      PushType(context, StackType::V128());
+      return true;
+
+    case Opcode::I8X16Shuffle:
+      return SimdShuffle(context, loc, value->shuffle_immediate());
 
     case Opcode::I8X16ExtractLaneS:
     case Opcode::I8X16ExtractLaneU:
@@ -2411,33 +2493,6 @@ bool Validate(Context& context, const At<Instruction>& value) {
     case Opcode::F64X2ReplaceLane:
       return SimdLane(context, loc, value);
 
-    case Opcode::I8X16AnyTrue:
-    case Opcode::I8X16AllTrue:
-    case Opcode::I8X16Bitmask:
-    case Opcode::I16X8AnyTrue:
-    case Opcode::I16X8AllTrue:
-    case Opcode::I16X8Bitmask:
-    case Opcode::I32X4AnyTrue:
-    case Opcode::I32X4AllTrue:
-    case Opcode::I32X4Bitmask:
-      params = span_v128, results = span_i32;
-      break;
-
-    case Opcode::I8X16Shl:
-    case Opcode::I8X16ShrS:
-    case Opcode::I8X16ShrU:
-    case Opcode::I16X8Shl:
-    case Opcode::I16X8ShrS:
-    case Opcode::I16X8ShrU:
-    case Opcode::I32X4Shl:
-    case Opcode::I32X4ShrS:
-    case Opcode::I32X4ShrU:
-    case Opcode::I64X2Shl:
-    case Opcode::I64X2ShrS:
-    case Opcode::I64X2ShrU:
-      params = span_v128_i32, results = span_v128;
-      break;
-
     case Opcode::MemoryAtomicNotify:
       return MemoryAtomicNotify(context, loc, value);
 
@@ -2514,19 +2569,6 @@ bool Validate(Context& context, const At<Instruction>& value) {
     case Opcode::I64AtomicRmw32CmpxchgU:
       return AtomicRmw(context, loc, value);
 
-    case Opcode:: RefEq:
-      params = span_eqref_eqref, results = span_i32;
-      break;
-
-    case Opcode:: I31New:
-      params = span_i32, results = span_i31ref;
-      break;
-
-    case Opcode:: I31GetS:
-    case Opcode:: I31GetU:
-      params = span_i31ref, results = span_i32;
-      break;
-
     case Opcode:: RttCanon:
       return RttCanon(context, loc, value->heap_type_immediate());
 
@@ -2576,9 +2618,410 @@ bool Validate(Context& context, const At<Instruction>& value) {
 
     case Opcode:: ArrayLen:
       return ArrayLen(context, loc, value->index_immediate());
+
+    default: {
+      StackTypeSpan params, results;
+      if (!GetSimpleSignature(value->opcode, &params, &results)) {
+        WASP_UNREACHABLE();
+      }
+      return PopAndPushTypes(context, loc, params, results);
+    }
+  }
+}
+
+namespace {
+
+// The single-byte opcodes that don't depend on any feature, indexed by their
+// encoding. All other opcodes are read by binary::Read.
+struct SingleByteOpcodes {
+  constexpr SingleByteOpcodes() {
+#define WASP_V(prefix, val, Name, str) \
+  is_valid[val] = true;                \
+  opcodes[val] = Opcode::Name;
+#define WASP_FEATURE_V(...)
+#define WASP_PREFIX_V(...)
+#include "wasp/base/inc/opcode.inc"
+#undef WASP_V
+#undef WASP_FEATURE_V
+#undef WASP_PREFIX_V
+  }
+
+  bool is_valid[256] = {};
+  Opcode opcodes[256] = {};
+};
+
+constexpr SingleByteOpcodes kSingleByteOpcodes;
+
+enum class FusedResult {
+  Valid,
+  Invalid,
+  NotHandled,  // The instruction must be read with binary::Read instead.
+};
+
+// Decodes a LEB128 immediate. Fails instead of reporting an error; the
+// instruction is then re-read with binary::Read, which reports it.
+template <typename T>
+bool DecodeImmediate(SpanU8* data, At<T>* out) {
+  T value;
+  int length = DecodeVarIntFast(*data, &value);
+  if (length == 0) {
+    return false;
+  }
+  *out = At{data->first(length), value};
+  data->remove_prefix(length);
+  return true;
+}
+
+bool SkipImmediate(SpanU8* data, span_extent_t size) {
+  if (data->size() < size) {
+    return false;
+  }
+  data->remove_prefix(size);
+  return true;
+}
+
+OptAt<BlockType> DecodeBlockType(SpanU8* data, const Features& features) {
+  if (data->empty()) {
+    return nullopt;
+  }
+  Location loc = data->first(1);
+  u8 byte = data->front();
+  OptAt<BlockType> result;
+  if (byte == encoding::BlockType::Void) {
+    result = At{loc, BlockType{At{loc, VoidType{}}}};
+  } else if (encoding::NumericType::Is(byte)) {
+    auto numeric_type = encoding::NumericType::Decode(byte, features);
+    if (!numeric_type) {
+      return nullopt;
+    }
+    result = At{loc, BlockType{At{loc, ValueType{At{loc, *numeric_type}}}}};
+  } else {
+    return nullopt;
+  }
+  data->remove_prefix(1);
+  return result;
+}
+
+bool DecodeMemArg(SpanU8* data, At<MemArgImmediate>* out) {
+  const u8* begin = data->begin();
+  At<u32> align_log2, offset;
+  if (!(DecodeImmediate(data, &align_log2) &&
+        DecodeImmediate(data, &offset))) {
+    return false;
+  }
+  *out = At{MakeSpan(begin, data->begin()),
+            MemArgImmediate{align_log2, offset}};
+  return true;
+}
+
+// Validates br_table straight from its encoding, so the targets don't need to
+// be collected into a BrTableImmediate.
+FusedResult ValidateBrTable(Context& context,
+                            SpanU8* data,
+                            const u8* instr_begin) {
+  // The default target is encoded after the other targets, but is validated
+  // first, so decode the immediate once to find it.
+  At<u32> count;
+  if (!DecodeImmediate(data, &count)) {
+    return FusedResult::NotHandled;
+  }
+  SpanU8 targets = *data;
+  for (u32 i = 0; i < *count; ++i) {
+    At<Index> target;
+    if (!DecodeImmediate(data, &target)) {
+      return FusedResult::NotHandled;
+    }
+  }
+  targets = MakeSpan(targets.begin(), data->begin());
+  At<Index> default_target;
+  if (!DecodeImmediate(data, &default_target)) {
+    return FusedResult::NotHandled;
+  }
+
+  Location loc = MakeSpan(instr_begin, data->begin());
+  ErrorsContextGuard guard{*context.errors, loc, "instruction"};
+  bool valid = true;
+  const auto* default_label =
+      BrTableDefault(context, loc, default_target, &valid);
+  if (!default_label) {
+    return FusedResult::Invalid;
+  }
+  StackTypeSpan br_types = default_label->br_types();
+  while (!targets.empty()) {
+    At<Index> target;
+    DecodeImmediate(&targets, &target);
+    valid &= BrTableTarget(context, br_types, target);
+  }
+  SetUnreachable(context);
+  return valid ? FusedResult::Valid : FusedResult::Invalid;
+}
+
+// Decodes and validates one instruction from the front of `data`, if it is
+// one of the common instructions that can be validated without constructing
+// a binary::Instruction. `data` is only advanced if the instruction was
+// handled.
+FusedResult ValidateEncodedInstruction(Context& context,
+                                       binary::Context& binary_context,
+                                       SpanU8* data) {
+  const u8* begin = data->begin();
+  u8 byte = data->front();
+  if (!kSingleByteOpcodes.is_valid[byte]) {
+    return FusedResult::NotHandled;
+  }
+  const Opcode opcode = kSingleByteOpcodes.opcodes[byte];
+  const At<Opcode> at_opcode{data->first(1), opcode};
+  SpanU8 rest = data->subspan(1);
+  auto valid = [&](bool b) {
+    *data = rest;
+    return b ? FusedResult::Valid : FusedResult::Invalid;
+  };
+  auto range = [&]() { return MakeSpan(begin, rest.begin()); };
+
+  // Each case first decodes the immediates, returning NotHandled on failure,
+  // and only then updates the binary::Context and validates.
+  switch (opcode) {
+    case Opcode::Block:
+    case Opcode::Loop:
+    case Opcode::If: {
+      auto block_type = DecodeBlockType(&rest, binary_context.features);
+      if (!block_type) {
+        return FusedResult::NotHandled;
+      }
+      binary_context.open_blocks.push_back(at_opcode);
+      Location loc = range();
+      ErrorsContextGuard guard{*context.errors, loc, "instruction"};
+      if (opcode == Opcode::If) {
+        bool ok = PopType(context, loc, StackType::I32());
+        ok &= PushLabel(context, loc, LabelType::If, *block_type);
+        return valid(ok);
+      }
+      return valid(PushLabel(context, loc,
+                             opcode == Opcode::Block ? LabelType::Block
+                                                     : LabelType::Loop,
+                             *block_type));
+    }
+
+    case Opcode::Else: {
+      auto& open_blocks = binary_context.open_blocks;
+      if (open_blocks.empty() || open_blocks.back() != Opcode::If) {
+        return FusedResult::NotHandled;
+      }
+      open_blocks.back() = at_opcode;
+      Location loc = range();
+      ErrorsContextGuard guard{*context.errors, loc, "instruction"};
+      return valid(Else(context, loc));
+    }
+
+    case Opcode::End: {
+      auto& open_blocks = binary_context.open_blocks;
+      if (open_blocks.empty()) {
+        binary_context.seen_final_end = true;
+      } else if (open_blocks.back() == Opcode::Try) {
+        return FusedResult::NotHandled;
+      } else {
+        open_blocks.pop_back();
+      }
+      Location loc = range();
+      ErrorsContextGuard guard{*context.errors, loc, "instruction"};
+      return valid(End(context, loc));
+    }
+
+    case Opcode::Br:
+    case Opcode::BrIf:
+    case Opcode::Call:
+    case Opcode::LocalGet:
+    case Opcode::LocalSet:
+    case Opcode::LocalTee:
+    case Opcode::GlobalGet:
+    case Opcode::GlobalSet: {
+      At<Index> index;
+      if (!DecodeImmediate(&rest, &index)) {
+        return FusedResult::NotHandled;
+      }
+      Location loc = range();
+      ErrorsContextGuard guard{*context.errors, loc, "instruction"};
+      switch (opcode) {
+        case Opcode::Br:        return valid(Br(context, loc, index));
+        case Opcode::BrIf:      return valid(BrIf(context, loc, index));
+        case Opcode::Call:      return valid(Call(context, loc, index));
+        case Opcode::LocalGet:  return valid(LocalGet(context, index));
+        case Opcode::LocalSet:  return valid(LocalSet(context, loc, index));
+        case Opcode::LocalTee:  return valid(LocalTee(context, loc, index));
+        case Opcode::GlobalGet: return valid(GlobalGet(context, index));
+        case Opcode::GlobalSet: return valid(GlobalSet(context, loc, index));
+        default:
+          WASP_UNREACHABLE();
+      }
+    }
+
+    case Opcode::BrTable: {
+      auto result = ValidateBrTable(context, &rest, begin);
+      if (result != FusedResult::NotHandled) {
+        *data = rest;
+      }
+      return result;
+    }
+
+    case Opcode::Return: {
+      Location loc = range();
+      ErrorsContextGuard guard{*context.errors, loc, "instruction"};
+      return valid(
+          Br(context, loc, static_cast<Index>(context.label_stack.size() - 1)));
+    }
+
+    case Opcode::I32Load:
+    case Opcode::I64Load:
+    case Opcode::F32Load:
+    case Opcode::F64Load:
+    case Opcode::I32Load8S:
+    case Opcode::I32Load8U:
+    case Opcode::I32Load16S:
+    case Opcode::I32Load16U:
+    case Opcode::I64Load8S:
+    case Opcode::I64Load8U:
+    case Opcode::I64Load16S:
+    case Opcode::I64Load16U:
+    case Opcode::I64Load32S:
+    case Opcode::I64Load32U: {
+      At<MemArgImmediate> mem_arg;
+      if (!DecodeMemArg(&rest, &mem_arg)) {
+        return FusedResult::NotHandled;
+      }
+      Location loc = range();
+      ErrorsContextGuard guard{*context.errors, loc, "instruction"};
+      return valid(Load(context, loc, opcode, mem_arg));
+    }
+
+    case Opcode::I32Store:
+    case Opcode::I64Store:
+    case Opcode::F32Store:
+    case Opcode::F64Store:
+    case Opcode::I32Store8:
+    case Opcode::I32Store16:
+    case Opcode::I64Store8:
+    case Opcode::I64Store16:
+    case Opcode::I64Store32: {
+      At<MemArgImmediate> mem_arg;
+      if (!DecodeMemArg(&rest, &mem_arg)) {
+        return FusedResult::NotHandled;
+      }
+      Location loc = range();
+      ErrorsContextGuard guard{*context.errors, loc, "instruction"};
+      return valid(Store(context, loc, opcode, mem_arg));
+    }
+
+    case Opcode::MemorySize:
+    case Opcode::MemoryGrow: {
+      if (rest.empty() || rest.front() != 0) {
+        return FusedResult::NotHandled;
+      }
+      rest.remove_prefix(1);
+      Location loc = range();
+      ErrorsContextGuard guard{*context.errors, loc, "instruction"};
+      if (opcode == Opcode::MemorySize) {
+        return valid(MemorySize(context));
+      }
+      return valid(MemoryGrow(context, loc));
+    }
+
+    case Opcode::I32Const:
+    case Opcode::I64Const:
+    case Opcode::F32Const:
+    case Opcode::F64Const: {
+      At<s32> s32_value;
+      At<s64> s64_value;
+      StackType type;
+      bool decoded;
+      switch (opcode) {
+        case Opcode::I32Const:
+          decoded = DecodeImmediate(&rest, &s32_value);
+          type = StackType::I32();
+          break;
+        case Opcode::I64Const:
+          decoded = DecodeImmediate(&rest, &s64_value);
+          type = StackType::I64();
+          break;
+        case Opcode::F32Const:
+          decoded = SkipImmediate(&rest, sizeof(f32));
+          type = StackType::F32();
+          break;
+        case Opcode::F64Const:
+          decoded = SkipImmediate(&rest, sizeof(f64));
+          type = StackType::F64();
+          break;
+        default:
+          WASP_UNREACHABLE();
+      }
+      if (!decoded) {
+        return FusedResult::NotHandled;
+      }
+      PushType(context, type);
+      return valid(true);
+    }
+
+    case Opcode::Unreachable:
+      SetUnreachable(context);
+      return valid(true);
+
+    case Opcode::Nop:
+      return valid(true);
+
+    case Opcode::Drop: {
+      Location loc = range();
+      ErrorsContextGuard guard{*context.errors, loc, "instruction"};
+      return valid(DropTypes(context, loc, 1));
+    }
+
+    case Opcode::Select: {
+      Location loc = range();
+      ErrorsContextGuard guard{*context.errors, loc, "instruction"};
+      return valid(Select(context, loc));
+    }
+
+    default: {
+      StackTypeSpan params, results;
+      if (!GetSimpleSignature(opcode, &params, &results)) {
+        return FusedResult::NotHandled;
+      }
+      Location loc = range();
+      ErrorsContextGuard guard{*context.errors, loc, "instruction"};
+      return valid(PopAndPushTypes(context, loc, params, results));
+    }
   }
+}
+
+}  // namespace
 
-  return PopAndPushTypes(context, loc, params, results);
+bool ValidateExpression(Context& context,
+                        binary::Context& binary_context,
+                        SpanU8 data) {
+  // Same as binary::ReadExpression.
+  binary_context.seen_final_end = false;
+  while (!data.empty()) {
+    // Leave the errors for instructions after the final end to the generic
+    // path.
+    if (!binary_context.seen_final_end && !context.label_stack.empty()) {
+      switch (ValidateEncodedInstruction(context, binary_context, &data)) {
+        case FusedResult::Valid:
+          continue;
+        case FusedResult::Invalid:
+          return false;
+        case FusedResult::NotHandled:
+          break;
+      }
+    }
+
+    auto instr = Read<Instruction>(&data, binary_context);
+    if (!instr) {
+      // The read error has been reported; like iterating a LazyExpression,
+      // stop reading here.
+      return true;
+    }
+    if (!Validate(context, *instr)) {
+      return false;
+    }
+  }
+  return true;
 }
 
 }  // namespace wasp::valid
@@ -16,13 +16,80 @@
 
 #include "wasp/valid/validate_visitor.h"
 
+#include <algorithm>
+#include <atomic>
 #include <cassert>
+#include <memory>
+
+#include "wasp/base/buffered_errors.h"
+#include "wasp/base/thread_pool.h"
+#include "wasp/binary/read.h"
+#include "wasp/binary/read/context.h"
+#include "wasp/valid/validate_expression.h"
 
 namespace wasp::valid {
 
+namespace {
+
+// State for one thread of parallel code validation.
+struct CodeWorker {
+  explicit CodeWorker(const Context& module_context,
+                      const binary::Context& module_binary_context)
+      : context{module_context, errors},
+        binary_context{module_binary_context.features, errors} {
+    binary_context.declared_data_count =
+        module_binary_context.declared_data_count;
+  }
+
+  // The errors of one function, as a range of `errors`.
+  struct ErrorRange {
+    Index code_index;
+    size_t begin;
+    size_t end;
+  };
+
+  BufferedErrors errors;
+  Context context;
+  binary::Context binary_context;
+  std::vector<ErrorRange> error_ranges;
+};
+
+// Does the same work as visiting a single code item with ValidateVisitor.
+bool ValidateCode(Context& context,
+                  binary::Context& binary_context,
+                  Index code_index,
+                  const At<binary::Code>& code) {
+  context.code_count = code_index;
+  if (!(BeginCode(context, code.loc()) &&
+        Validate(context, code->locals, RequireDefaultable::Yes))) {
+    return false;
+  }
+  binary_context.open_blocks.clear();
+  if (!ValidateExpression(context, binary_context, code->body->data)) {
+    return false;
+  }
+  binary::EndCode(code->body->data.last(0), binary_context);
+  return true;
+}
+
+}  // namespace
+
 ValidateVisitor::ValidateVisitor(Features features, Errors& errors)
     : context{features, errors}, features{features}, errors{errors} {}
 
+ValidateVisitor::ValidateVisitor(Features features,
+                                 Errors& errors,
+                                 ThreadPool* thread_pool)
+    : context{features, errors},
+      features{features},
+      errors{errors},
+      thread_pool{thread_pool} {}
+
+auto ValidateVisitor::BeginModule(binary::LazyModule& module) -> Result {
+  binary_context = &module.context;
+  return Result::Ok;
+}
+
 auto ValidateVisitor::BeginTypeSection(binary::LazyTypeSection sec) -> Result {
   return FailUnless(valid::BeginTypeSection(context, sec.count.value_or(0)));
 }
@@ -71,9 +138,45 @@ auto ValidateVisitor::OnDataCount(const At<binary::DataCount>& data_count)
   return FailUnless(Validate(context, data_count));
 }
 
+auto ValidateVisitor::DefersCode() const -> bool {
+  return thread_pool && binary_context;
+}
+
+auto ValidateVisitor::DeferredCodeCount() const -> size_t {
+  return pending_codes.size();
+}
+
 auto ValidateVisitor::BeginCode(const At<binary::Code>& code) -> Result {
-  return FailUnless(valid::BeginCode(context, code.loc()) &&
-                    Validate(context, code->locals, RequireDefaultable::Yes));
+  if (DefersCode()) {
+    pending_codes.push_back(code);
+    pending_code_size += code->body->data.size();
+    if (pending_code_size >= code_batch_size) {
+      // Validate this batch now, so the codes don't have to be kept until the
+      // end of the section.
+      bool ok = ValidateCodesInParallel();
+      pending_codes.clear();
+      pending_code_size = 0;
+      if (!ok) {
+        return Result::Fail;
+      }
+    }
+    return Result::Skip;
+  }
+  if (!(valid::BeginCode(context, code.loc()) &&
+        Validate(context, code->locals, RequireDefaultable::Yes))) {
+    return Result::Fail;
+  }
+  if (binary_context) {
+    // Validate the body here rather than in OnInstruction, so the
+    // instructions don't have to be read into binary::Instruction objects.
+    // Skipping the code means the visitor won't call binary::EndCode either.
+    if (!ValidateExpression(context, *binary_context, code->body->data)) {
+      return Result::Fail;
+    }
+    binary::EndCode(code->body->data.last(0), *binary_context);
+    return Result::Skip;
+  }
+  return Result::Ok;
 }
 
 auto ValidateVisitor::OnInstruction(const At<binary::Instruction>& instruction)
@@ -81,6 +184,16 @@ auto ValidateVisitor::OnInstruction(const At<binary::Instruction>& instruction)
   return FailUnless(Validate(context, instruction));
 }
 
+auto ValidateVisitor::EndCodeSection(binary::LazyCodeSection) -> Result {
+  if (pending_codes.empty()) {
+    return Result::Ok;
+  }
+  bool ok = ValidateCodesInParallel();
+  pending_codes.clear();
+  pending_code_size = 0;
+  return FailUnless(ok);
+}
+
 auto ValidateVisitor::OnData(const At<binary::DataSegment>& segment) -> Result {
   return FailUnless(Validate(context, segment));
 }
@@ -89,4 +202,66 @@ auto ValidateVisitor::FailUnless(bool b) -> Result {
   return b ? Result::Ok : Result::Fail;
 }
 
+auto ValidateVisitor::ValidateCodesInParallel() -> bool {
+  const Index first_code_index = context.code_count;
+  const Index count = static_cast<Index>(pending_codes.size());
+  std::vector<std::unique_ptr<CodeWorker>> workers(
+      thread_pool->thread_count());
+  std::atomic<Index> first_failure{count};
+
+  thread_pool->ParallelFor(count, [&](size_t i, int worker_index) {
+    // Serial validation stops at the first failing function, so there is no
+    // need to validate anything after it.
+    if (i > first_failure.load(std::memory_order_relaxed)) {
+      return;
+    }
+    auto& worker = workers[worker_index];
+    if (!worker) {
+      worker = std::make_unique<CodeWorker>(context, *binary_context);
+    }
+    const Index code_index = static_cast<Index>(i);
+    size_t begin = worker->errors.size();
+    bool ok = ValidateCode(worker->context, worker->binary_context,
+                           first_code_index + code_index, pending_codes[i]);
+    if (worker->errors.size() != begin) {
+      worker->error_ranges.push_back(
+          CodeWorker::ErrorRange{code_index, begin, worker->errors.size()});
+    }
+    if (!ok) {
+      Index prev = first_failure.load(std::memory_order_relaxed);
+      while (code_index < prev &&
+             !first_failure.compare_exchange_weak(prev, code_index)) {
+      }
+    }
+  });
+
+  // Report the errors in function (and therefore source offset) order, up to
+  // the first failing function.
+  struct Pending {
+    const CodeWorker* worker;
+    CodeWorker::ErrorRange range;
+  };
+  std::vector<Pending> pending;
+  for (const auto& worker : workers) {
+    if (worker) {
+      for (const auto& range : worker->error_ranges) {
+        if (range.code_index <= first_failure) {
+          pending.push_back(Pending{worker.get(), range});
+        }
+      }
+    }
+  }
+  std::sort(pending.begin(), pending.end(),
+            [](const Pending& lhs, const Pending& rhs) {
+              return lhs.range.code_index < rhs.range.code_index;
+            });
+  for (const auto& item : pending) {
+    item.worker->errors.ReplayTo(errors, item.range.begin, item.range.end);
+  }
+
+  bool ok = first_failure == count;
+  context.code_count = first_code_index + (ok ? count : first_failure + 1);
+  return ok;
+}
+
 }  // namespace wasp::valid
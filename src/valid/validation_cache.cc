@@ -0,0 +1,361 @@
+//
+// Copyright 2020 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "wasp/valid/validation_cache.h"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "wasp/base/errors.h"
+#include "wasp/base/file.h"
+#include "wasp/binary/lazy_module.h"
+#include "wasp/binary/visitor.h"
+#include "wasp/valid/validate_visitor.h"
+#include "validator_version.h"  // Generated by validator_version.cmake.
+
+namespace wasp::valid {
+
+namespace {
+
+// Bump this whenever the entry format changes. Changes to validation itself
+// are covered by kValidatorVersion, which is part of every entry.
+constexpr u8 kFormatVersion = 2;
+constexpr char kValidatorVersion[] = WASP_VALIDATOR_VERSION;
+constexpr char kMagic[] = {'w', 'a', 's', 'p', 'v', 'c'};
+constexpr u32 kNoOffset = ~u32{0};
+
+struct CachedLocation {
+  u32 offset;
+  u32 size;
+};
+
+struct CachedContext {
+  CachedLocation loc;
+  std::string desc;
+};
+
+struct CachedError {
+  std::vector<CachedContext> context;
+  CachedLocation loc;
+  std::string message;
+};
+
+struct Entry {
+  bool valid;
+  std::vector<CachedError> errors;
+};
+
+auto ToCachedLocation(SpanU8 data, Location loc) -> CachedLocation {
+  if (loc.begin() < data.begin() || loc.end() > data.end()) {
+    return CachedLocation{kNoOffset, 0};
+  }
+  return CachedLocation{static_cast<u32>(loc.begin() - data.begin()),
+                        static_cast<u32>(loc.size())};
+}
+
+auto ToLocation(SpanU8 data, CachedLocation loc) -> Location {
+  if (loc.offset == kNoOffset) {
+    return Location{};
+  }
+  return data.subspan(loc.offset, loc.size);
+}
+
+// Records errors as offsets into `data`, along with their context.
+class EntryErrors : public Errors {
+ public:
+  explicit EntryErrors(SpanU8 data) : data_{data} {}
+
+  std::vector<CachedError> errors;
+
+ protected:
+  void HandleOnError(Location loc, string_view message) override {
+    CachedError error{{}, ToCachedLocation(data_, loc), std::string{message}};
+    error.context.reserve(context().size());
+    for (const auto& item : context()) {
+      error.context.push_back(
+          CachedContext{ToCachedLocation(data_, item.loc),
+                        std::string{item.desc}});
+    }
+    errors.push_back(std::move(error));
+  }
+
+ private:
+  SpanU8 data_;
+};
+
+void ReplayEntry(SpanU8 data, const Entry& entry, Errors& errors) {
+  for (const auto& error : entry.errors) {
+    for (const auto& context : error.context) {
+      errors.PushContext(ToLocation(data, context.loc), context.desc);
+    }
+    errors.OnError(ToLocation(data, error.loc), error.message);
+    for (size_t i = 0; i < error.context.size(); ++i) {
+      errors.PopContext();
+    }
+  }
+}
+
+void WriteU32(std::string& out, u32 value) {
+  for (int i = 0; i < 4; ++i) {
+    out += static_cast<char>((value >> (i * 8)) & 0xff);
+  }
+}
+
+void WriteString(std::string& out, string_view str) {
+  WriteU32(out, static_cast<u32>(str.size()));
+  out.append(str.data(), str.size());
+}
+
+void WriteLocation(std::string& out, CachedLocation loc) {
+  WriteU32(out, loc.offset);
+  WriteU32(out, loc.size);
+}
+
+auto WriteEntry(const Entry& entry) -> std::string {
+  std::string out{kMagic, sizeof(kMagic)};
+  out += static_cast<char>(kFormatVersion);
+  WriteString(out, ValidationCache::ValidatorVersion());
+  out += static_cast<char>(entry.valid);
+  WriteU32(out, static_cast<u32>(entry.errors.size()));
+  for (const auto& error : entry.errors) {
+    WriteU32(out, static_cast<u32>(error.context.size()));
+    for (const auto& context : error.context) {
+      WriteLocation(out, context.loc);
+      WriteString(out, context.desc);
+    }
+    WriteLocation(out, error.loc);
+    WriteString(out, error.message);
+  }
+  return out;
+}
+
+// Reads an entry written by WriteEntry. Truncated or corrupt entries, and
+// locations that don't fit in a module of `data_size` bytes, are treated as
+// misses.
+class EntryReader {
+ public:
+  explicit EntryReader(SpanU8 data, size_t data_size)
+      : data_{data}, data_size_{data_size} {}
+
+  auto Read() -> optional<Entry> {
+    if (data_.size() < sizeof(kMagic) + 1 ||
+        memcmp(data_.data(), kMagic, sizeof(kMagic)) != 0 ||
+        data_[sizeof(kMagic)] != kFormatVersion) {
+      return nullopt;
+    }
+    data_.remove_prefix(sizeof(kMagic) + 1);
+
+    std::string validator_version;
+    if (!ReadString(&validator_version) ||
+        validator_version != ValidationCache::ValidatorVersion() ||
+        data_.empty()) {
+      return nullopt;
+    }
+    Entry entry;
+    entry.valid = data_[0] != 0;
+    data_.remove_prefix(1);
+
+    u32 error_count, context_count;
+    if (!ReadU32(&error_count)) {
+      return nullopt;
+    }
+    for (u32 i = 0; i < error_count; ++i) {
+      CachedError error;
+      if (!ReadU32(&context_count)) {
+        return nullopt;
+      }
+      for (u32 j = 0; j < context_count; ++j) {
+        CachedContext context;
+        if (!ReadLocation(&context.loc) || !ReadString(&context.desc)) {
+          return nullopt;
+        }
+        error.context.push_back(std::move(context));
+      }
+      if (!ReadLocation(&error.loc) || !ReadString(&error.message)) {
+        return nullopt;
+      }
+      entry.errors.push_back(std::move(error));
+    }
+    if (!data_.empty()) {
+      return nullopt;
+    }
+    return entry;
+  }
+
+ private:
+  bool ReadU32(u32* out) {
+    if (data_.size() < 4) {
+      return false;
+    }
+    *out = 0;
+    for (int i = 0; i < 4; ++i) {
+      *out |= u32{data_[i]} << (i * 8);
+    }
+    data_.remove_prefix(4);
+    return true;
+  }
+
+  bool ReadString(std::string* out) {
+    u32 size;
+    if (!ReadU32(&size) || size > data_.size()) {
+      return false;
+    }
+    out->assign(reinterpret_cast<const char*>(data_.data()), size);
+    data_.remove_prefix(size);
+    return true;
+  }
+
+  bool ReadLocation(CachedLocation* out) {
+    if (!ReadU32(&out->offset) || !ReadU32(&out->size)) {
+      return false;
+    }
+    return out->offset == kNoOffset ||
+           (out->offset <= data_size_ && out->size <= data_size_ - out->offset);
+  }
+
+  SpanU8 data_;
+  size_t data_size_;
+};
+
+void AppendHex(std::string& out, u64 value) {
+  const char kDigits[] = "0123456789abcdef";
+  char buffer[16];
+  for (int i = 15; i >= 0; --i) {
+    buffer[i] = kDigits[value & 0xf];
+    value >>= 4;
+  }
+  out.append(buffer, 16);
+}
+
+u64 Rotl(u64 x, int r) {
+  return (x << r) | (x >> (64 - r));
+}
+
+u64 FinalMix(u64 x) {
+  x ^= x >> 33;
+  x *= 0xff51afd7ed558ccdull;
+  x ^= x >> 33;
+  x *= 0xc4ceb9fe1a85ec53ull;
+  x ^= x >> 33;
+  return x;
+}
+
+}  // namespace
+
+ValidationCache::ValidationCache(string_view directory)
+    : directory_{directory} {}
+
+// A MurmurHash3-style hash over 8-byte words. Unlike absl::Hash, it is not
+// seeded per process, so it can be used as a key on disk.
+// static
+u64 ValidationCache::Hash(SpanU8 data) {
+  const u64 c1 = 0x87c37b91114253d5ull;
+  const u64 c2 = 0x4cf5ad432745937full;
+  u64 h = data.size();
+  size_t i = 0;
+  for (; i + 8 <= data.size(); i += 8) {
+    u64 word;
+    memcpy(&word, data.data() + i, sizeof(word));
+    h ^= Rotl(word * c1, 31) * c2;
+    h = Rotl(h, 27) * 5 + 0x52dce729;
+  }
+  u64 tail = 0;
+  for (int shift = 0; i < data.size(); ++i, shift += 8) {
+    tail |= u64{data[i]} << shift;
+  }
+  h ^= Rotl(tail * c1, 31) * c2;
+  return FinalMix(h);
+}
+
+// static
+auto ValidationCache::ValidatorVersion() -> string_view {
+  return kValidatorVersion;
+}
+
+auto ValidationCache::EntryPath(SpanU8 data, const Features& features) const
+    -> std::string {
+  std::string path = directory_;
+  if (!path.empty() && path.back() != '/') {
+    path += '/';
+  }
+  AppendHex(path, Hash(data));
+  path += '-';
+  AppendHex(path, data.size());
+  path += '-';
+  AppendHex(path, features.bits());
+  path += '-';
+  path += kValidatorVersion;
+  path += ".wvc";
+  return path;
+}
+
+auto ValidationCache::Lookup(SpanU8 data,
+                             const Features& features,
+                             Errors& errors) const -> optional<bool> {
+  auto buffer = ReadFile(EntryPath(data, features));
+  if (!buffer) {
+    return nullopt;
+  }
+  auto entry = EntryReader{*buffer, data.size()}.Read();
+  if (!entry) {
+    return nullopt;
+  }
+  ReplayEntry(data, *entry, errors);
+  return entry->valid;
+}
+
+bool ValidationCache::Validate(SpanU8 data,
+                               const Features& features,
+                               Errors& errors,
+                               ThreadPool* thread_pool) {
+  if (auto valid = Lookup(data, features, errors)) {
+    return *valid;
+  }
+
+  EntryErrors entry_errors{data};
+  auto module = binary::ReadModule(data, features, entry_errors);
+  if (module.magic && module.version) {
+    ValidateVisitor visitor{features, entry_errors, thread_pool};
+    binary::visit::Visit(module, visitor);
+  }
+  Entry entry{entry_errors.errors.empty(), std::move(entry_errors.errors)};
+  ReplayEntry(data, entry, errors);
+
+  // Failing to write the entry only means the next run misses the cache.
+  std::string path = EntryPath(data, features);
+  std::string temp_path =
+      path + ".tmp" + std::to_string(std::random_device{}());
+  {
+    std::ofstream stream{temp_path, std::ios::out | std::ios::binary};
+    std::string contents = WriteEntry(entry);
+    stream.write(contents.data(), contents.size());
+    if (!stream) {
+      stream.close();
+      std::remove(temp_path.c_str());
+      return entry.valid;
+    }
+  }
+  if (std::rename(temp_path.c_str(), path.c_str()) != 0) {
+    std::remove(temp_path.c_str());
+  }
+  return entry.valid;
+}
+
+}  // namespace wasp::valid
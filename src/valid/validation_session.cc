@@ -0,0 +1,167 @@
+//
+// Copyright 2020 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "wasp/valid/validation_session.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "wasp/base/concat.h"
+#include "wasp/base/errors.h"
+#include "wasp/base/errors_context_guard.h"
+#include "wasp/base/errors_nop.h"
+#include "wasp/valid/validate.h"
+
+namespace wasp::valid {
+
+namespace {
+
+// The context's errors are always replaced before validating anything; this
+// is only used to construct it.
+Errors& UnusedErrors() {
+  static ErrorsNop errors;
+  return errors;
+}
+
+auto GetRefFuncs(const binary::UnpackedCode& code) -> std::vector<Index> {
+  std::vector<Index> result;
+  for (const auto& instr : code.body.instructions) {
+    if (instr->opcode == Opcode::RefFunc) {
+      result.push_back(instr->index_immediate());
+    }
+  }
+  return result;
+}
+
+}  // namespace
+
+ValidationSession::ValidationSession(const Features& features,
+                                     binary::Module module)
+    : module_{std::move(module)}, context_{features, UnusedErrors()} {}
+
+bool ValidationSession::Validate(Errors& errors) {
+  context_ = Context{context_.features, errors};
+
+  // The same as Validate(Context&, const Module&), but each body gets its own
+  // verdict.
+  bool valid = ValidateSectionsBeforeCode(context_, module_);
+
+  Index code_count = static_cast<Index>(module_.codes.size());
+  code_valid_.assign(code_count, false);
+  ref_funcs_.assign(code_count, {});
+  for (Index i = 0; i < code_count; ++i) {
+    ref_funcs_[i] = GetRefFuncs(module_.codes[i]);
+    ValidateCode(i, errors);
+  }
+
+  valid &= ValidateSectionsAfterCode(context_, module_);
+  module_valid_ = valid;
+  validated_ = true;
+  return IsValid();
+}
+
+bool ValidationSession::ReplaceFunctionBody(
+    Index func_index,
+    const At<binary::UnpackedCode>& value,
+    Errors& errors) {
+  if (!CheckValidated(value.loc(), errors)) {
+    return false;
+  }
+  Index code_index = func_index - context_.imported_function_count;
+  if (func_index < context_.imported_function_count ||
+      code_index >= module_.codes.size()) {
+    errors.OnError(value.loc(),
+                   concat("Invalid function index ", func_index,
+                          ", expected a defined function"));
+    return false;
+  }
+
+  module_.codes[code_index] = value;
+  ref_funcs_[code_index] = GetRefFuncs(value);
+  return ValidateCode(code_index, errors);
+}
+
+bool ValidationSession::AddExport(const At<binary::Export>& value,
+                                  Errors& errors) {
+  if (!CheckValidated(value.loc(), errors)) {
+    return false;
+  }
+  // Validating a duplicate export still declares its function, so check the
+  // name first; a rejected export must leave the session unchanged.
+  if (context_.export_names.count(value->name) != 0) {
+    ErrorsContextGuard guard{errors, value.loc(), "export"};
+    errors.OnError(value.loc(), concat("Duplicate export name ", value->name));
+    return false;
+  }
+  bool newly_declared =
+      value->kind == ExternalKind::Function &&
+      context_.declared_functions.count(value->index) == 0;
+
+  // The context keeps the name, so it must outlive the caller's export.
+  const std::string& name = export_names_.emplace_back(value->name.value());
+  At<binary::Export> export_ = value;
+  export_->name = At<string_view>{value->name.loc(), name};
+  context_.errors = &errors;
+  if (!valid::Validate(context_, export_)) {
+    // The name was unique, so the only thing added is the name.
+    context_.export_names.erase(name);
+    export_names_.pop_back();
+    return false;
+  }
+  module_.exports.push_back(export_);
+
+  if (newly_declared) {
+    // Only bodies that failed could have failed because of an undeclared
+    // ref.func; valid bodies stay valid.
+    for (Index i = 0; i < module_.codes.size(); ++i) {
+      const auto& ref_funcs = ref_funcs_[i];
+      if (!code_valid_[i] && std::find(ref_funcs.begin(), ref_funcs.end(),
+                                       value->index) != ref_funcs.end()) {
+        ValidateCode(i, errors);
+      }
+    }
+  }
+  return true;
+}
+
+bool ValidationSession::IsValid() const {
+  return module_valid_ &&
+         std::find(code_valid_.begin(), code_valid_.end(), false) ==
+             code_valid_.end();
+}
+
+auto ValidationSession::module() const -> const binary::Module& {
+  return module_;
+}
+
+bool ValidationSession::CheckValidated(Location loc, Errors& errors) {
+  if (!validated_) {
+    errors.OnError(loc, "The module must be validated before it is edited");
+    return false;
+  }
+  return true;
+}
+
+bool ValidationSession::ValidateCode(Index code_index, Errors& errors) {
+  context_.errors = &errors;
+  context_.code_count = code_index;
+  bool valid = valid::Validate(context_, module_.codes[code_index]);
+  context_.code_count = static_cast<Index>(module_.codes.size());
+  code_valid_[code_index] = valid;
+  return valid;
+}
+
+}  // namespace wasp::valid
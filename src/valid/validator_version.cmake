@@ -0,0 +1,48 @@
+#
+# Copyright 2020 WebAssembly Community Group participants
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+#
+
+# Writes OUTPUT, a header that defines WASP_VALIDATOR_VERSION as a hash of
+# the sources that reading and validating a module depend on. ValidationCache
+# keys its entries by it, so a build with any change to the validator never
+# reads entries written by another build.
+#
+#   cmake -DROOT=<wasp root> -DOUTPUT=<header> -P validator_version.cmake
+
+function(wasp_validator_sources out root)
+  set(sources)
+  foreach(dir include/wasp/base include/wasp/binary include/wasp/valid
+              src/base src/binary src/valid)
+    file(GLOB dir_sources RELATIVE ${root}
+      ${root}/${dir}/*.h ${root}/${dir}/*.inc ${root}/${dir}/*.def
+      ${root}/${dir}/*.cc)
+    list(APPEND sources ${dir_sources})
+  endforeach()
+  set(${out} ${sources} PARENT_SCOPE)
+endfunction()
+
+if (CMAKE_SCRIPT_MODE_FILE)
+  wasp_validator_sources(sources ${ROOT})
+  set(hashes)
+  foreach(source ${sources})
+    file(SHA256 ${ROOT}/${source} hash)
+    set(hashes "${hashes}${source} ${hash}\n")
+  endforeach()
+  string(SHA256 version "${hashes}")
+  string(SUBSTRING ${version} 0 16 version)
+  file(WRITE ${OUTPUT}
+    "// Generated by validator_version.cmake; do not edit.\n"
+    "#define WASP_VALIDATOR_VERSION \"${version}\"\n")
+endif()
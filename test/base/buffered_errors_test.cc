@@ -0,0 +1,79 @@
+//
+// Copyright 2020 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "wasp/base/buffered_errors.h"
+
+#include "gtest/gtest.h"
+#include "test/test_utils.h"
+#include "wasp/base/errors_context_guard.h"
+
+using namespace ::wasp;
+using namespace ::wasp::test;
+
+TEST(BufferedErrorsTest, Replay) {
+  const SpanU8 data = "abcdef"_su8;
+  BufferedErrors buffered;
+  {
+    ErrorsContextGuard guard{buffered, data.subspan(0, 2), "outer"};
+    buffered.OnError(data.subspan(1, 1), "first");
+    {
+      ErrorsContextGuard guard{buffered, data.subspan(2, 2), "inner"};
+    }
+    buffered.OnError(data.subspan(3, 1), "second");
+  }
+  buffered.OnError(data.subspan(5, 1), "third");
+  EXPECT_EQ(3u, buffered.size());
+  EXPECT_TRUE(buffered.has_error());
+
+  TestErrors errors;
+  buffered.ReplayTo(errors);
+  ExpectErrors({{{0, "outer"}, {1, "first"}},
+                {{0, "outer"}, {3, "second"}},
+                {{5, "third"}}},
+               errors, data);
+
+  TestErrors partial;
+  buffered.ReplayTo(partial, 1, 2);
+  ExpectErrors({{{0, "outer"}, {3, "second"}}}, partial, data);
+}
+
+TEST(BufferedErrorsTest, Clear) {
+  BufferedErrors buffered;
+  buffered.OnError(""_su8, "error");
+  buffered.Clear();
+  EXPECT_EQ(0u, buffered.size());
+  EXPECT_FALSE(buffered.has_error());
+}
+
+TEST(BufferedErrorsTest, Context) {
+  const SpanU8 data = "abcdef"_su8;
+  BufferedErrors buffered;
+  EXPECT_TRUE(buffered.context().empty());
+  {
+    ErrorsContextGuard outer{buffered, data.subspan(0, 2), "outer"};
+    ErrorsContextGuard inner{buffered, data.subspan(2, 2), "inner"};
+    ASSERT_EQ(2u, buffered.context().size());
+    EXPECT_EQ("outer", buffered.context()[0].desc);
+    EXPECT_EQ("inner", buffered.context()[1].desc);
+
+    inner.PopContext();
+    ASSERT_EQ(1u, buffered.context().size());
+    EXPECT_EQ("outer", buffered.context()[0].desc);
+  }
+  EXPECT_TRUE(buffered.context().empty());
+  // Nothing is recorded unless there is an error.
+  EXPECT_FALSE(buffered.has_error());
+}
@@ -0,0 +1,130 @@
+//
+// Copyright 2020 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "wasp/base/compact_location.h"
+
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+using namespace ::wasp;
+
+TEST(CompactLocationTest, Size) {
+  EXPECT_EQ(8u, sizeof(CompactLocation));
+}
+
+TEST(CompactLocationTest, RoundTrip) {
+  SpanU8 data = "hello world"_su8;
+  LocationBase base{data};
+  EXPECT_EQ(data, LocationBase::Get());
+
+  Location loc = data.subspan(6, 5);
+  CompactLocation compact{loc};
+  EXPECT_TRUE(compact.has_value());
+  EXPECT_EQ(loc.data(), compact.ToLocation().data());
+  EXPECT_EQ(loc.size(), compact.ToLocation().size());
+
+  // Empty, but still has a position.
+  CompactLocation empty{data.subspan(3, 0)};
+  EXPECT_TRUE(empty.has_value());
+  EXPECT_EQ(data.data() + 3, empty.ToLocation().data());
+}
+
+TEST(CompactLocationTest, OutsideBase) {
+  SpanU8 data = "hello world"_su8;
+  SpanU8 other = "other"_su8;
+  LocationBase base{data.subspan(0, 5)};
+
+  EXPECT_FALSE(CompactLocation{}.has_value());
+  EXPECT_FALSE(CompactLocation{Location{}}.has_value());
+  EXPECT_FALSE(CompactLocation{other}.has_value());
+  // Overlaps the end of the base.
+  EXPECT_FALSE(CompactLocation{data.subspan(3, 5)}.has_value());
+  EXPECT_EQ(Location{}, CompactLocation{other}.ToLocation());
+}
+
+TEST(CompactLocationTest, NoBase) {
+  SpanU8 data = "hello"_su8;
+  EXPECT_EQ(SpanU8{}, LocationBase::Get());
+  EXPECT_FALSE(CompactLocation{data}.has_value());
+}
+
+TEST(CompactLocationTest, NestedBase) {
+  SpanU8 outer = "outer"_su8;
+  SpanU8 inner = "inner"_su8;
+  LocationBase outer_base{outer};
+  {
+    LocationBase inner_base{inner};
+    EXPECT_EQ(inner, LocationBase::Get());
+  }
+  EXPECT_EQ(outer, LocationBase::Get());
+}
+
+TEST(CompactLocationTest, UnorderedBases) {
+  SpanU8 first = "first"_su8;
+  SpanU8 second = "second"_su8;
+  SpanU8 third = "third"_su8;
+  auto first_base = std::make_unique<LocationBase>(first);
+  auto second_base = std::make_unique<LocationBase>(second);
+  {
+    LocationBase third_base{third};
+    // The newest base is current, even after an older one is destroyed.
+    first_base.reset();
+    EXPECT_EQ(third, LocationBase::Get());
+  }
+  EXPECT_EQ(second, LocationBase::Get());
+  second_base.reset();
+  EXPECT_EQ(SpanU8{}, LocationBase::Get());
+}
+
+TEST(CompactLocationTest, Threads) {
+  constexpr int kThreads = 8;
+  std::vector<std::thread> threads;
+  std::vector<int> ok(kThreads);
+  for (int t = 0; t < kThreads; ++t) {
+    threads.emplace_back([t, &ok] {
+      // Each thread has its own base.
+      std::vector<u8> buffer(16, static_cast<u8>(t));
+      SpanU8 data{buffer};
+      LocationBase base{data};
+      bool result = true;
+      for (size_t i = 0; i < data.size(); ++i) {
+        Location loc = CompactLocation{data.subspan(i, 1)}.ToLocation();
+        result &= loc.data() == data.data() + i && loc.size() == 1;
+      }
+      ok[t] = result;
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  for (int t = 0; t < kThreads; ++t) {
+    EXPECT_TRUE(ok[t]) << t;
+  }
+}
+
+TEST(CompactLocationTest, Equality) {
+  SpanU8 data = "abab"_su8;
+  LocationBase base{data};
+
+  // Like Location, compares the bytes rather than the position.
+  EXPECT_EQ(CompactLocation{data.subspan(0, 2)},
+            CompactLocation{data.subspan(2, 2)});
+  EXPECT_NE(CompactLocation{data.subspan(0, 2)},
+            CompactLocation{data.subspan(1, 2)});
+}
@@ -0,0 +1,170 @@
+//
+// Copyright 2020 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "wasp/base/file.h"
+
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <utility>
+
+#include "gtest/gtest.h"
+
+#if !defined(_WIN32)
+#include <unistd.h>
+#endif
+
+using namespace ::wasp;
+
+namespace {
+
+const Buffer kContents{'\0', 'a', 's', 'm', 1, 2, 3, 0xff};
+
+// Writes `contents` to a file in the test's temporary directory, and returns
+// its name.
+std::string WriteTempFile(const char* name, const Buffer& contents) {
+  std::string filename = ::testing::TempDir() + name;
+  std::ofstream stream{filename, std::ios::out | std::ios::binary};
+  stream.write(reinterpret_cast<const char*>(contents.data()),
+               contents.size());
+  return filename;
+}
+
+#if !defined(_WIN32)
+// Replaces stdin with a pipe holding `contents`, which isn't seekable, until
+// it is destroyed.
+class PipeStdin {
+ public:
+  explicit PipeStdin(const Buffer& contents) {
+    int fds[2];
+    EXPECT_EQ(0, pipe(fds));
+    // Small enough not to fill the pipe, so this doesn't block.
+    EXPECT_EQ(static_cast<ssize_t>(contents.size()),
+              write(fds[1], contents.data(), contents.size()));
+    close(fds[1]);
+    saved_stdin_ = dup(STDIN_FILENO);
+    dup2(fds[0], STDIN_FILENO);
+    close(fds[0]);
+  }
+
+  ~PipeStdin() {
+    dup2(saved_stdin_, STDIN_FILENO);
+    close(saved_stdin_);
+    clearerr(stdin);
+    std::cin.clear();
+  }
+
+ private:
+  int saved_stdin_;
+};
+#endif
+
+}  // namespace
+
+TEST(FileTest, ReadFile) {
+  auto filename = WriteTempFile("read_file", kContents);
+  auto buffer = ReadFile(filename);
+  ASSERT_TRUE(buffer.has_value());
+  EXPECT_EQ(kContents, *buffer);
+}
+
+TEST(FileTest, ReadFile_Empty) {
+  auto filename = WriteTempFile("read_file_empty", Buffer{});
+  auto buffer = ReadFile(filename);
+  ASSERT_TRUE(buffer.has_value());
+  EXPECT_TRUE(buffer->empty());
+}
+
+TEST(FileTest, ReadFile_Missing) {
+  EXPECT_EQ(nullopt, ReadFile(::testing::TempDir() + "no_such_file"));
+}
+
+TEST(FileTest, MapFile) {
+  auto filename = WriteTempFile("map_file", kContents);
+  for (auto access : {FileAccess::Sequential, FileAccess::Random}) {
+    auto file = MapFile(filename, access);
+    ASSERT_TRUE(file.has_value());
+#if !defined(_WIN32)
+    EXPECT_TRUE(file->is_mapped());
+#endif
+    EXPECT_EQ(kContents, ToBuffer(*file));
+  }
+}
+
+TEST(FileTest, MapFile_Empty) {
+  auto filename = WriteTempFile("map_file_empty", Buffer{});
+  auto file = MapFile(filename);
+  ASSERT_TRUE(file.has_value());
+  EXPECT_FALSE(file->is_mapped());
+  EXPECT_TRUE(file->span().empty());
+}
+
+TEST(FileTest, MapFile_Missing) {
+  EXPECT_EQ(nullopt, MapFile(::testing::TempDir() + "no_such_file"));
+}
+
+TEST(FileTest, MappedFile_Buffer) {
+  MappedFile file{kContents};
+  EXPECT_FALSE(file.is_mapped());
+  EXPECT_EQ(kContents, ToBuffer(file));
+
+  // Moving keeps the data where it is, so spans into it stay valid.
+  SpanU8 span = file;
+  MappedFile moved{std::move(file)};
+  EXPECT_EQ(span.data(), moved.span().data());
+  EXPECT_EQ(kContents, ToBuffer(moved));
+}
+
+TEST(FileTest, MappedFile_MoveMapped) {
+  auto filename = WriteTempFile("map_file_move", kContents);
+  auto file = MapFile(filename);
+  ASSERT_TRUE(file.has_value());
+  SpanU8 span = *file;
+
+  MappedFile moved;
+  moved = std::move(*file);
+  EXPECT_EQ(span.data(), moved.span().data());
+  EXPECT_EQ(kContents, ToBuffer(moved));
+  EXPECT_FALSE(file->is_mapped());
+  EXPECT_TRUE(file->span().empty());
+}
+
+#if !defined(_WIN32)
+TEST(FileTest, ReadFile_Stdin) {
+  PipeStdin pipe_stdin{kContents};
+  auto buffer = ReadFile("-");
+  ASSERT_TRUE(buffer.has_value());
+  EXPECT_EQ(kContents, *buffer);
+}
+
+TEST(FileTest, MapFile_Stdin) {
+  PipeStdin pipe_stdin{kContents};
+  auto file = MapFile("-");
+  ASSERT_TRUE(file.has_value());
+  EXPECT_FALSE(file->is_mapped());
+  EXPECT_EQ(kContents, ToBuffer(*file));
+}
+
+TEST(FileTest, MapFile_NonSeekable) {
+  // Opened by name, but a pipe, so it can't be mapped or sized up front.
+  PipeStdin pipe_stdin{kContents};
+  auto file = MapFile("/dev/stdin");
+  ASSERT_TRUE(file.has_value());
+  EXPECT_FALSE(file->is_mapped());
+  EXPECT_EQ(kContents, ToBuffer(*file));
+}
+#endif
@@ -0,0 +1,112 @@
+//
+// Copyright 2020 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "wasp/base/module_arena.h"
+
+#include <cstdint>
+#include <utility>
+
+#include "gtest/gtest.h"
+
+using namespace ::wasp;
+
+TEST(ModuleArenaTest, Allocate) {
+  ModuleArena arena{1024};
+  void* a = arena.Allocate(10, 1);
+  void* b = arena.Allocate(8, 8);
+  EXPECT_NE(a, b);
+  EXPECT_EQ(0u, reinterpret_cast<uintptr_t>(b) % 8);
+  EXPECT_EQ(18u, arena.bytes_allocated());
+  EXPECT_EQ(1u, arena.block_count());
+  arena.Deallocate();
+  arena.Deallocate();
+}
+
+TEST(ModuleArenaTest, NewBlock) {
+  ModuleArena arena{1024};
+  for (int i = 0; i < 20; ++i) {
+    arena.Allocate(100, 4);
+  }
+  EXPECT_EQ(2u, arena.block_count());
+  for (int i = 0; i < 20; ++i) {
+    arena.Deallocate();
+  }
+}
+
+TEST(ModuleArenaTest, LargeAllocation) {
+  ModuleArena arena{1024};
+  arena.Allocate(10, 1);
+  void* large = arena.Allocate(4096, 64);
+  EXPECT_EQ(0u, reinterpret_cast<uintptr_t>(large) % 64);
+  EXPECT_EQ(2u, arena.block_count());
+
+  // Later small allocations still use the first block.
+  arena.Allocate(10, 1);
+  EXPECT_EQ(2u, arena.block_count());
+  for (int i = 0; i < 3; ++i) {
+    arena.Deallocate();
+  }
+}
+
+TEST(ModuleArenaTest, ArenaVector) {
+  ModuleArena arena;
+  ArenaVector<int> heap_vec{1, 2, 3};
+  EXPECT_EQ(nullptr, heap_vec.get_allocator().arena());
+
+  ArenaVector<int> vec{{1, 2, 3}, ArenaAllocator<int>{&arena}};
+  EXPECT_EQ(&arena, vec.get_allocator().arena());
+  EXPECT_EQ(3 * sizeof(int), arena.bytes_allocated());
+  vec.push_back(4);
+  EXPECT_EQ((ArenaVector<int>{1, 2, 3, 4}), vec);
+}
+
+TEST(ModuleArenaTest, ArenaInlinedVector) {
+  ModuleArena arena;
+  ArenaInlinedVector<int, 2> vec{{1, 2}, ArenaAllocator<int>{&arena}};
+  EXPECT_EQ(0u, arena.bytes_allocated());
+
+  // Only growing past the inline capacity allocates, from the arena.
+  vec.push_back(3);
+  EXPECT_NE(0u, arena.bytes_allocated());
+  EXPECT_EQ((ArenaInlinedVector<int, 2>{1, 2, 3}), vec);
+}
+
+TEST(ModuleArenaTest, MoveKeepsArena) {
+  ModuleArena arena;
+  ArenaVector<int> moved;
+  {
+    ArenaVector<int> vec{{1, 2, 3}, ArenaAllocator<int>{&arena}};
+    moved = std::move(vec);
+  }
+  EXPECT_EQ(&arena, moved.get_allocator().arena());
+  EXPECT_EQ((ArenaVector<int>{1, 2, 3}), moved);
+}
+
+TEST(ModuleArenaTest, CopyUsesHeap) {
+  ModuleArena arena;
+  ArenaVector<int> vec{{1, 2, 3}, ArenaAllocator<int>{&arena}};
+
+  // Copies never bind to an arena, so they can outlive it.
+  ArenaVector<int> copy = vec;
+  EXPECT_EQ(nullptr, copy.get_allocator().arena());
+  EXPECT_EQ(vec, copy);
+
+  // Also when an inlined vector has spilled into the arena.
+  ArenaInlinedVector<int, 2> inlined{{1, 2, 3}, ArenaAllocator<int>{&arena}};
+  ArenaInlinedVector<int, 2> inlined_copy = inlined;
+  EXPECT_EQ(nullptr, inlined_copy.get_allocator().arena());
+  EXPECT_EQ(inlined, inlined_copy);
+}
@@ -0,0 +1,69 @@
+//
+// Copyright 2020 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "wasp/base/thread_pool.h"
+
+#include <atomic>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "wasp/base/compact_location.h"
+
+using namespace ::wasp;
+
+TEST(ThreadPoolTest, ParallelFor) {
+  for (int thread_count : {1, 2, 3, 8}) {
+    ThreadPool pool{thread_count};
+    EXPECT_EQ(thread_count, pool.thread_count());
+
+    for (size_t count : {0u, 1u, 2u, 7u, 1000u}) {
+      std::vector<std::atomic<int>> seen(count);
+      std::atomic<bool> bad_worker{false};
+      pool.ParallelFor(count, [&](size_t index, int worker) {
+        seen[index]++;
+        if (worker < 0 || worker >= thread_count) {
+          bad_worker = true;
+        }
+      });
+      for (size_t i = 0; i < count; ++i) {
+        EXPECT_EQ(1, seen[i]) << "index " << i << " with " << thread_count
+                              << " threads";
+      }
+      EXPECT_FALSE(bad_worker);
+    }
+  }
+}
+
+TEST(ThreadPoolTest, InvalidThreadCount) {
+  ThreadPool pool{0};
+  EXPECT_EQ(1, pool.thread_count());
+  int count = 0;
+  pool.ParallelFor(3, [&](size_t, int) { count++; });
+  EXPECT_EQ(3, count);
+}
+
+TEST(ThreadPoolTest, LocationBase) {
+  SpanU8 data = "data"_su8;
+  LocationBase base{data};
+  ThreadPool pool{4};
+  std::atomic<int> bad_base{0};
+  pool.ParallelFor(100, [&](size_t, int) {
+    if (LocationBase::Get() != data) {
+      bad_base++;
+    }
+  });
+  EXPECT_EQ(0, bad_base);
+}
@@ -17,6 +17,8 @@
 #include "wasp/base/utf8.h"
 
 #include <cassert>
+#include <random>
+#include <string>
 
 #include "gtest/gtest.h"
 
@@ -169,3 +171,46 @@ TEST(Utf8Test, invalid_4_bytes) {
     assert_is_valid_utf8(false, 4, cu0, 0x80, 0x80, 0x80);
   }
 }
+
+TEST(Utf8Test, long_strings) {
+  // Put each sequence at every offset in a long ASCII string, so it is checked
+  // at every position in a SIMD chunk, and straddling two chunks.
+  const std::string sequences[] = {
+      // Valid.
+      "\xc2\x80", "\xe0\xa0\x80", "\xed\x9f\xbf", "\xf0\x90\x80\x80",
+      "\xf4\x8f\xbf\xbf",
+      // Invalid.
+      "\x80", "\xc0\x80", "\xe0\x80\x80", "\xed\xa0\x80",
+      "\xf4\x90\x80\x80", "\xff",
+      // Truncated.
+      "\xc2", "\xe0\xa0", "\xf0\x90\x80",
+  };
+  for (const auto& sequence : sequences) {
+    bool expected = IsValidUtf8Scalar(sequence);
+    for (size_t offset = 0; offset < 80; ++offset) {
+      std::string str(100, 'a');
+      str.replace(offset, sequence.size(), sequence);
+      ASSERT_EQ(expected, IsValidUtf8(str)) << offset;
+      ASSERT_EQ(expected, IsValidUtf8Scalar(str)) << offset;
+      // Truncated just after the sequence.
+      str.resize(offset + sequence.size());
+      ASSERT_EQ(expected, IsValidUtf8(str)) << offset;
+    }
+  }
+}
+
+TEST(Utf8Test, matches_scalar) {
+  std::mt19937 rng{0};
+  // Mostly ASCII, with some multi-byte and invalid sequences.
+  std::discrete_distribution<int> kind_dist{{90, 4, 3, 2, 1}};
+  const std::string kinds[] = {"x", "\xc3\xa9", "\xe2\x82\xac",
+                               "\xf0\x9f\x98\x80", "\xa0"};
+  for (int i = 0; i < 1000; ++i) {
+    std::string str;
+    size_t length = rng() % 300;
+    while (str.size() < length) {
+      str += kinds[kind_dist(rng)];
+    }
+    ASSERT_EQ(IsValidUtf8Scalar(str), IsValidUtf8(str)) << i;
+  }
+}
@@ -0,0 +1,93 @@
+//
+// Copyright 2020 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "wasp/binary/code_section_index.h"
+
+#include "gtest/gtest.h"
+#include "test/binary/constants.h"
+#include "test/binary/test_utils.h"
+#include "test/test_utils.h"
+#include "wasp/binary/lazy_module.h"
+#include "wasp/binary/read/context.h"
+
+using namespace ::wasp;
+using namespace ::wasp::binary;
+using namespace ::wasp::binary::test;
+using namespace ::wasp::test;
+
+TEST(BinaryCodeSectionIndexTest, Basic) {
+  TestErrors errors;
+  Context context{errors};
+  auto index = ReadCodeSectionIndex(
+      "\x02"                           // Count.
+      "\x02\x00\x0b"                   // (func)
+      "\x05\x01\x01\x7f\x6a\x0b"_su8,  // (func (local i32) i32.add)
+      context);
+
+  ASSERT_EQ(2u, index.size());
+  EXPECT_EQ("\x02\x00\x0b"_su8, index.GetEntryData(0));
+  EXPECT_EQ("\x05\x01\x01\x7f\x6a\x0b"_su8, index.GetEntryData(1));
+  EXPECT_EQ(nullopt, index.GetEntryData(2));
+
+  EXPECT_EQ((Code{{}, At{"\x0b"_su8, "\x0b"_expr}}), index.GetCode(0, context));
+  EXPECT_EQ((Code{{At{"\x01\x7f"_su8,
+                      Locals{At{"\x01"_su8, Index{1}}, At{"\x7f"_su8, VT_I32}}}},
+                  At{"\x6a\x0b"_su8, "\x6a\x0b"_expr}}),
+            index.GetCode(1, context));
+  EXPECT_EQ(nullopt, index.GetCode(2, context));
+  ExpectNoErrors(errors);
+}
+
+TEST(BinaryCodeSectionIndexTest, PastEnd) {
+  TestErrors errors;
+  Context context{errors};
+  const SpanU8 data =
+      "\x02"             // Count.
+      "\x02\x00\x0b"     // (func)
+      "\x05\x01\x01"_su8;  // Truncated.
+  auto index = ReadCodeSectionIndex(data, context);
+
+  // Entries before the error are still available.
+  ASSERT_EQ(1u, index.size());
+  EXPECT_EQ("\x02\x00\x0b"_su8, index.GetEntryData(0));
+  ExpectError({{0, "code section"}, {4, "Length extends past end: 5 > 2"}},
+              errors, data);
+}
+
+TEST(BinaryCodeSectionIndexTest, LazyModule) {
+  Features features;
+  TestErrors errors;
+  auto module = ReadModule(
+      "\0asm\x01\0\0\0"
+      "\x0a\x07\x02"        // Code section, count = 2
+      "\x02\x00\x0b"        // (func)
+      "\x02\x00\x0b"_su8,   // (func)
+      features, errors);
+
+  auto& index = module.code_section_index();
+  EXPECT_EQ(2u, index.size());
+  // The index is only built once.
+  EXPECT_EQ(&index, &module.code_section_index());
+  ExpectNoErrors(errors);
+}
+
+TEST(BinaryCodeSectionIndexTest, LazyModule_NoCodeSection) {
+  Features features;
+  TestErrors errors;
+  auto module = ReadModule("\0asm\x01\0\0\0"_su8, features, errors);
+  EXPECT_TRUE(module.code_section_index().empty());
+  ExpectNoErrors(errors);
+}
@@ -0,0 +1,154 @@
+//
+// Copyright 2020 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "wasp/binary/eager_module.h"
+
+#include <memory>
+#include <utility>
+
+#include "gtest/gtest.h"
+#include "test/test_utils.h"
+#include "wasp/base/features.h"
+#include "wasp/base/thread_pool.h"
+
+using namespace ::wasp;
+using namespace ::wasp::binary;
+using namespace ::wasp::test;
+
+namespace {
+
+// A module with one type `(func)` and six functions. Functions 2 and 4 have
+// malformed bodies (an unknown opcode, and a missing final `end`).
+const SpanU8 kModule =
+    "\0asm\x01\x00\x00\x00"
+    "\x01\x04\x01\x60\x00\x00"  // type section
+    "\x03\x07\x06\x00\x00\x00\x00\x00\x00"  // function section
+    "\x0a\x16\x06"  // code section
+    "\x02\x00\x0b"  // func 0
+    "\x02\x00\x0b"  // func 1
+    "\x03\x00\xff\x0b"  // func 2 (malformed)
+    "\x02\x00\x0b"  // func 3
+    "\x04\x00\x02\x40\x0b"  // func 4 (malformed)
+    "\x02\x00\x0b"_su8;  // func 5
+
+// A module with one function, that has locals and a br_table with more
+// targets than are stored inline.
+const SpanU8 kListsModule =
+    "\0asm\x01\x00\x00\x00"
+    "\x01\x04\x01\x60\x00\x00"  // type section
+    "\x03\x02\x01\x00"  // function section
+    "\x0a\x0e\x01"  // code section
+    "\x0c\x01\x02\x7f"  // func 0, (local i32 i32)
+    "\x0e\x05\x00\x00\x00\x00\x00\x00\x0b"_su8;  // br_table 0 0 0 0 0 0, end
+
+}  // namespace
+
+TEST(BinaryEagerModuleTest, Basic) {
+  TestErrors errors;
+  auto module = ReadModuleEager(kModule, Features{}, errors);
+  EXPECT_EQ(1u, module.types.size());
+  EXPECT_EQ(6u, module.functions.size());
+  ASSERT_EQ(6u, module.codes.size());
+
+  EXPECT_EQ("\x02\x00\x0b"_su8, module.codes[0].loc());
+  ASSERT_EQ(1u, module.codes[0]->body.instructions.size());
+  EXPECT_EQ(Opcode::End, module.codes[0]->body.instructions[0]->opcode);
+
+  EXPECT_EQ(0u, module.codes[2]->body.instructions.size());
+
+  ASSERT_EQ(2u, module.codes[4]->body.instructions.size());
+  EXPECT_EQ(Opcode::Block, module.codes[4]->body.instructions[0]->opcode);
+  EXPECT_EQ(Opcode::End, module.codes[4]->body.instructions[1]->opcode);
+
+  // Function 2 has an unknown opcode and no final end; function 4 has no
+  // final end.
+  EXPECT_EQ(3u, errors.errors.size());
+}
+
+TEST(BinaryEagerModuleTest, ParallelMatchesSerial) {
+  TestErrors serial_errors;
+  auto serial_module = ReadModuleEager(kModule, Features{}, serial_errors);
+
+  for (int thread_count : {1, 2, 4}) {
+    ThreadPool pool{thread_count};
+    TestErrors parallel_errors;
+    auto parallel_module =
+        ReadModuleEager(kModule, Features{}, parallel_errors, &pool);
+    EXPECT_EQ(serial_module, parallel_module);
+    ExpectErrors(serial_errors.errors, parallel_errors);
+  }
+}
+
+TEST(BinaryEagerModuleTest, ArenaMatchesHeap) {
+  for (SpanU8 data : {kModule, kListsModule}) {
+    TestErrors heap_errors;
+    auto heap_module = ReadModuleEager(data, Features{}, heap_errors);
+
+    for (int thread_count : {0, 1, 2}) {
+      auto pool = thread_count ? std::make_unique<ThreadPool>(thread_count)
+                               : nullptr;
+      TestErrors arena_errors;
+      auto arena_module =
+          ReadArenaModuleEager(data, Features{}, arena_errors, pool.get());
+      EXPECT_EQ(heap_module, arena_module.module);
+      EXPECT_NE(0u, arena_module.bytes_allocated());
+      ExpectErrors(heap_errors.errors, arena_errors);
+    }
+  }
+}
+
+TEST(BinaryEagerModuleTest, ArenaLists) {
+  TestErrors errors;
+  auto arena_module = ReadArenaModuleEager(kListsModule, Features{}, errors);
+  ExpectNoErrors(errors);
+  ASSERT_EQ(1u, arena_module.module.codes.size());
+  const auto& code = *arena_module.module.codes[0];
+  ASSERT_EQ(2u, code.body.instructions.size());
+  const auto& br_table = code.body.instructions[0]->br_table_immediate();
+
+  EXPECT_NE(nullptr, code.locals.get_allocator().arena());
+  EXPECT_NE(nullptr, code.body.instructions.get_allocator().arena());
+  EXPECT_EQ(code.body.instructions.get_allocator(),
+            br_table->targets.get_allocator());
+
+  // Copies don't refer to the arena.
+  auto copy = arena_module.module;
+  const auto& copy_code = *copy.codes[0];
+  EXPECT_EQ(nullptr, copy_code.body.instructions.get_allocator().arena());
+  EXPECT_EQ(nullptr, copy_code.body.instructions[0]
+                         ->br_table_immediate()
+                         ->targets.get_allocator()
+                         .arena());
+
+  // So they outlive it.
+  arena_module = ArenaModule{};
+  EXPECT_EQ(5u, copy_code.body.instructions[0]
+                    ->br_table_immediate()
+                    ->targets.size());
+}
+
+TEST(BinaryEagerModuleTest, ArenaModuleMove) {
+  TestErrors errors;
+  auto expected = ReadModuleEager(kListsModule, Features{}, errors);
+
+  // Moving keeps the arenas along with the module, and assigning drops the
+  // old module before its arenas.
+  ArenaModule arena_module =
+      ReadArenaModuleEager(kModule, Features{}, errors);
+  arena_module = ReadArenaModuleEager(kListsModule, Features{}, errors);
+  ArenaModule moved{std::move(arena_module)};
+  EXPECT_EQ(expected, moved.module);
+}
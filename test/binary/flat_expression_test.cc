@@ -0,0 +1,150 @@
+//
+// Copyright 2020 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "wasp/binary/flat_expression.h"
+
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "test/binary/constants.h"
+#include "test/test_utils.h"
+#include "wasp/base/features.h"
+#include "wasp/binary/lazy_expression.h"
+#include "wasp/binary/read/context.h"
+
+using namespace ::wasp;
+using namespace ::wasp::binary;
+using namespace ::wasp::binary::test;
+using namespace ::wasp::test;
+
+namespace {
+
+const SpanU8 kExpr =
+    "\x02\x40"                              // block
+    "\x20\x00"                              //   local.get 0
+    "\x0e\x02\x00\x01\x00"                  //   br_table 0 1 0
+    "\x0b"                                  // end
+    "\x41\x7f"                              // i32.const -1
+    "\x42\x80\x80\x80\x80\x80\x01"          // i64.const 2**35
+    "\x43\x00\x00\x80\x3f"                  // f32.const 1
+    "\x44\x00\x00\x00\x00\x00\x00\xf0\x3f"  // f64.const 1
+    "\x28\x02\x10"                          // i32.load align=4 offset=16
+    "\x11\x01\x00"                          // call_indirect 1 0
+    "\xfc\x0a\x00\x00"                      // memory.copy
+    "\xfd\x0c\x00\x01\x02\x03\x04\x05\x06\x07"
+    "\x08\x09\x0a\x0b\x0c\x0d\x0e\x0f"      // v128.const
+    "\x6a"                                  // i32.add
+    "\x10\x05"                              // call 5
+    "\x0b"_su8;                             // end
+
+}  // namespace
+
+TEST(BinaryFlatExpressionTest, MatchesLazyExpression) {
+  TestErrors errors;
+  Features features;
+  features.enable_bulk_memory();
+  features.enable_simd();
+  Context context{features, errors};
+
+  std::vector<At<Instruction>> expected;
+  for (auto&& instr : ReadExpression(kExpr, context)) {
+    expected.push_back(instr);
+  }
+
+  auto expr = ReadFlatExpression(kExpr, context);
+  ExpectNoErrors(errors);
+  ASSERT_EQ(expected.size(), expr.instructions.size());
+  EXPECT_EQ(kExpr, expr.data);
+  for (Index i = 0; i < expr.size(); ++i) {
+    EXPECT_EQ(expected[i]->opcode, expr.instructions[i].opcode);
+    EXPECT_EQ(expected[i].loc(), expr.GetInstructionData(i));
+    auto instr = expr.ToInstruction(i, context);
+    ASSERT_TRUE(instr.has_value());
+    EXPECT_EQ(expected[i], *instr);
+    EXPECT_EQ(expected[i].loc(), instr->loc());
+  }
+  ExpectNoErrors(errors);
+}
+
+TEST(BinaryFlatExpressionTest, Immediates) {
+  TestErrors errors;
+  Features features;
+  features.enable_bulk_memory();
+  features.enable_simd();
+  Context context{features, errors};
+  auto expr = ReadFlatExpression(kExpr, context);
+  ASSERT_EQ(15u, expr.size());
+  const auto& instrs = expr.instructions;
+
+  EXPECT_EQ(0u, instrs[1].index_immediate());
+  EXPECT_EQ((std::vector<Index>{0, 1, 0}),
+            (std::vector<Index>{expr.GetBrTableTargets(instrs[2]).begin(),
+                                expr.GetBrTableTargets(instrs[2]).end()}));
+  EXPECT_EQ(-1, instrs[4].s32_immediate());
+  EXPECT_EQ(s64{1} << 35, instrs[5].s64_immediate());
+  EXPECT_EQ(1.0f, instrs[6].f32_immediate());
+  EXPECT_EQ(1.0, instrs[7].f64_immediate());
+  EXPECT_EQ(2u, instrs[8].low_immediate());
+  EXPECT_EQ(16u, instrs[8].high_immediate());
+  EXPECT_EQ(1u, instrs[9].low_immediate());
+  EXPECT_EQ(0u, instrs[9].high_immediate());
+  EXPECT_EQ(0u, instrs[12].immediate);
+  EXPECT_EQ(5u, instrs[13].index_immediate());
+  EXPECT_EQ(62u, instrs[13].offset);
+}
+
+TEST(BinaryFlatExpressionTest, StopsAtError) {
+  TestErrors errors;
+  Context context{errors};
+  auto expr = ReadFlatExpression("\x01\x20"_su8, context);
+  ASSERT_EQ(1u, expr.size());
+  EXPECT_EQ(Opcode::Nop, expr.instructions[0].opcode);
+  EXPECT_EQ("\x01"_su8, expr.data);
+  EXPECT_FALSE(errors.errors.empty());
+}
+
+TEST(BinaryFlatExpressionTest, GetReadFlatExpression) {
+  const SpanU8 kSignExtend =
+      "\x20\x00"  // local.get 0
+      "\xc0"      // i32.extend8_s
+      "\x0b"_su8;  // end
+
+  Features all_features;
+  all_features.EnableAll();
+  EXPECT_EQ(Features::kDefaultBits, Features{}.bits());
+  EXPECT_EQ(Features::kAllBits, all_features.bits());
+
+  for (const auto& features : {Features{}, all_features}) {
+    for (auto data : {kExpr, kSignExtend}) {
+      TestErrors expected_errors, actual_errors;
+      Context expected_context{features, expected_errors};
+      Context actual_context{features, actual_errors};
+      auto expected = ReadFlatExpression(data, expected_context);
+      auto actual = GetReadFlatExpression(features)(data, actual_context);
+      EXPECT_EQ(expected.data, actual.data);
+      ASSERT_EQ(expected.size(), actual.size());
+      for (Index i = 0; i < expected.size(); ++i) {
+        EXPECT_EQ(expected.instructions[i].opcode,
+                  actual.instructions[i].opcode);
+        EXPECT_EQ(expected.instructions[i].offset,
+                  actual.instructions[i].offset);
+        EXPECT_EQ(expected.instructions[i].immediate,
+                  actual.instructions[i].immediate);
+      }
+      EXPECT_EQ(expected_errors.errors.size(), actual_errors.errors.size());
+    }
+  }
+}
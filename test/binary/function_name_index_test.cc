@@ -0,0 +1,84 @@
+//
+// Copyright 2020 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "wasp/binary/function_name_index.h"
+
+#include "gtest/gtest.h"
+#include "test/test_utils.h"
+#include "wasp/binary/lazy_module.h"
+
+using namespace ::wasp;
+using namespace ::wasp::binary;
+using namespace ::wasp::test;
+
+TEST(BinaryFunctionNameIndexTest, Basic) {
+  FunctionNameIndex index{3};
+  index.Insert(0, "a");
+  index.Insert(2, "b");
+  index.Insert(100, "c");
+
+  EXPECT_EQ(3u, index.size());
+  EXPECT_EQ("a"_sv, index.GetName(0));
+  EXPECT_EQ(nullopt, index.GetName(1));
+  EXPECT_EQ("b"_sv, index.GetName(2));
+  EXPECT_EQ("c"_sv, index.GetName(100));
+  EXPECT_EQ(nullopt, index.GetName(3));
+
+  EXPECT_EQ(0u, index.GetIndex("a"));
+  EXPECT_EQ(2u, index.GetIndex("b"));
+  EXPECT_EQ(100u, index.GetIndex("c"));
+  EXPECT_EQ(nullopt, index.GetIndex("d"));
+}
+
+TEST(BinaryFunctionNameIndexTest, FirstNameWins) {
+  FunctionNameIndex index{2};
+  index.Insert(0, "a");
+  index.Insert(0, "b");
+  index.Insert(1, "a");
+
+  EXPECT_EQ("a"_sv, index.GetName(0));
+  EXPECT_EQ("a"_sv, index.GetName(1));
+  EXPECT_EQ(0u, index.GetIndex("a"));
+  EXPECT_EQ(0u, index.GetIndex("b"));
+}
+
+TEST(BinaryFunctionNameIndexTest, ReadFunctionNameIndex) {
+  Features features;
+  TestErrors errors;
+  auto module = ReadModule(
+      "\0asm\x01\0\0\0"
+      "\x01\x04\x01\x60\0\0"          // 1 type: params:[] results:[]
+      "\x02\x0b\x01\0\x06import\0\0"  // 1 import: func mod:"" name:"import"
+      "\x03\x03\x02\0\0"              // 2 funcs: type 0, type 0
+      "\x07\x0a\x01\x06"
+      "export\0\x01"                      // 1 export: func 1 name:"export"
+      "\x0a\x07\x02\x02\0\x0b\x02\0\x0b"  // 2 code: both empty
+      "\0\x17\x04name"                    // "name" section
+      "\x01\x10\x02"                      // function names, 2 entries
+      "\x01\x05other"                     // func 1, name "other"
+      "\x02\x06"
+      "custom"_su8,  // func 2, name "custom"
+      features, errors);
+
+  const auto& index = module.function_name_index();
+  EXPECT_EQ(4u, index.size());
+  EXPECT_EQ("import"_sv, index.GetName(0));
+  EXPECT_EQ("export"_sv, index.GetName(1));
+  EXPECT_EQ("custom"_sv, index.GetName(2));
+  EXPECT_EQ(1u, index.GetIndex("other"));
+  EXPECT_EQ(2u, index.GetIndex("custom"));
+  ExpectNoErrors(errors);
+}
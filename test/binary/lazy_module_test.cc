@@ -67,6 +67,16 @@ TEST(BinaryLazyModuleTest, Basic) {
   ExpectNoErrors(errors);
 }
 
+TEST(BinaryLazyModuleTest, LocationBase) {
+  SpanU8 data = "\0asm\x01\0\0\0"_su8;
+  TestErrors errors;
+  {
+    auto module = ReadModule(data, Features{}, errors);
+    EXPECT_EQ(data, LocationBase::Get());
+  }
+  EXPECT_EQ(SpanU8{}, LocationBase::Get());
+}
+
 TEST(BinaryLazyModuleTest, BadMagic) {
   TestErrors errors;
   auto data = "wasm\x01\0\0\0"_su8;
@@ -109,3 +119,41 @@ TEST(BinaryLazyModuleTest, Version_PastEnd) {
 
   ExpectError({{4, "version"}, {4, "Unable to read 4 bytes"}}, errors, data);
 }
+
+TEST(BinaryLazyModuleTest, SectionAccessors) {
+  Features features;
+  TestErrors errors;
+  auto module = ReadModule(
+      "\0asm\x01\0\0\0"
+      "\x01\x04\x01\x60\0\0"          // 1 type: params:[] results:[]
+      "\x03\x03\x02\0\0"              // 2 funcs: type 0, type 0
+      "\x08\x01\x01"                  // start: func 1
+      "\x0a\x07\x02\x02\0\x0b\x02\0\x0b"_su8,  // 2 code: both empty
+      features, errors);
+
+  auto type_section = module.type_section();
+  ASSERT_TRUE(type_section.has_value());
+  EXPECT_EQ(1u, type_section->count);
+
+  auto function_section = module.function_section();
+  ASSERT_TRUE(function_section.has_value());
+  EXPECT_EQ(2u, function_section->count);
+
+  EXPECT_EQ((Start{At{"\x01"_su8, Index{1}}}), module.start_section());
+  EXPECT_EQ(2u, module.code_section()->count);
+  EXPECT_EQ(2u, module.code_section_index().size());
+
+  EXPECT_FALSE(module.import_section().has_value());
+  EXPECT_FALSE(module.export_section().has_value());
+  EXPECT_FALSE(module.data_section().has_value());
+  EXPECT_EQ(nullopt, module.data_count_section());
+
+  // Using the directory doesn't disturb iterating the sections afterward.
+  int section_count = 0;
+  for (auto section : module.sections) {
+    WASP_USE(section);
+    section_count++;
+  }
+  EXPECT_EQ(4, section_count);
+  ExpectNoErrors(errors);
+}
@@ -21,6 +21,7 @@
 
 #include "gtest/gtest.h"
 #include "test/test_utils.h"
+#include "wasp/base/macros.h"
 
 using namespace ::wasp;
 using namespace ::wasp::binary;
@@ -104,3 +105,23 @@ TEST(BinaryLazyModuleUtilsTest, GetImportCount) {
   EXPECT_EQ(1u, GetImportCount(module, ExternalKind::Table));
   ExpectNoErrors(errors);
 }
+
+TEST(BinaryLazyModuleUtilsTest, RepeatedCalls) {
+  Features features;
+  TestErrors errors;
+  auto module = ReadModule(GetModuleData(), features, errors);
+
+  // Each call must leave the module's sections readable from the start.
+  for (int i = 0; i < 2; ++i) {
+    std::map<Index, string_view> function_names;
+    CopyFunctionNames(module,
+                      std::inserter(function_names, function_names.end()));
+    EXPECT_EQ(3u, function_names.size());
+    EXPECT_EQ(1u, GetImportCount(module, ExternalKind::Function));
+  }
+
+  for (auto section : module.sections) {
+    WASP_USE(section);
+  }
+  ExpectNoErrors(errors);
+}
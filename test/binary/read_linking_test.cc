@@ -238,6 +238,18 @@ TEST_F(BinaryReadLinkingTest, SymbolInfo_Function) {
      "\x00\x40\x00\x04name"_su8);
 }
 
+TEST_F(BinaryReadLinkingTest, SymbolInfo_Name) {
+  using SI = SymbolInfo;
+  EXPECT_EQ(nullopt,
+            (SI{undefined_flags,
+                SI::Base{SymbolInfoKind::Function, Index{0}, nullopt}}
+                 .name()));
+  EXPECT_EQ("name"_sv,
+            (SI{explicit_name_flags,
+                SI::Base{SymbolInfoKind::Function, Index{0}, "name"_sv}}
+                 .name()));
+}
+
 TEST_F(BinaryReadLinkingTest, SymbolInfo_Data) {
   using SI = SymbolInfo;
   OK(Read<SI>,
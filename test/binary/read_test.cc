@@ -23,9 +23,11 @@
 #include "test/binary/constants.h"
 #include "test/binary/test_utils.h"
 #include "test/test_utils.h"
+#include "wasp/base/buffer.h"
 #include "wasp/binary/formatters.h"
 #include "wasp/binary/name_section/read.h"
 #include "wasp/binary/read/context.h"
+#include "wasp/binary/read/read_var_int.h"
 #include "wasp/binary/read/read_vector.h"
 
 #include "wasp/base/concat.h"
@@ -3684,6 +3686,63 @@ TEST_F(BinaryReadTest, U32_PastEnd) {
        "\xf0\xf0\xf0\xf0"_su8);
 }
 
+namespace {
+
+template <typename T>
+void ExpectFastMatchesSlow(SpanU8 encoded) {
+  // Follow the value with extra bytes so the 8-byte load path is used too.
+  for (size_t padding : {0u, 8u}) {
+    Buffer buffer = ToBuffer(encoded);
+    buffer.insert(buffer.end(), padding, 0xff);
+
+    TestErrors errors;
+    Context context{errors};
+    SpanU8 fast_data{buffer};
+    SpanU8 slow_data{buffer};
+    auto fast = ReadVarInt<T>(&fast_data, context, "fast");
+    auto slow = ReadVarIntSlow<T>(&slow_data, context, "slow");
+    ExpectNoErrors(errors);
+    ASSERT_TRUE(fast.has_value());
+    ASSERT_TRUE(slow.has_value());
+    EXPECT_EQ(*slow, *fast);
+    EXPECT_EQ(slow->loc(), fast->loc());
+    EXPECT_EQ(padding, fast_data.size());
+  }
+}
+
+}  // namespace
+
+TEST_F(BinaryReadTest, VarInt_FastPath) {
+  ExpectFastMatchesSlow<u32>("\x20"_su8);
+  ExpectFastMatchesSlow<u32>("\xc0\x03"_su8);
+  ExpectFastMatchesSlow<u32>("\xa0\xb0\xc0\x30"_su8);
+  ExpectFastMatchesSlow<u32>("\xf0\xf0\xf0\xf0\x03"_su8);
+  ExpectFastMatchesSlow<u32>("\x80\x80\x80\x80\x00"_su8);
+  ExpectFastMatchesSlow<s32>("\x70"_su8);
+  ExpectFastMatchesSlow<s32>("\xd0\x84\x52"_su8);
+  ExpectFastMatchesSlow<s32>("\xf0\xf0\xf0\xf0\x7c"_su8);
+  ExpectFastMatchesSlow<s32>("\xff\xff\xff\xff\x7f"_su8);
+  ExpectFastMatchesSlow<s64>("\xc0\x63"_su8);
+  ExpectFastMatchesSlow<s64>("\xc0\xc0\xc0\xc0\xc0\xd0\x63"_su8);
+  ExpectFastMatchesSlow<s64>("\xaa\xaa\xaa\xaa\xaa\xa0\xb0\x6a"_su8);
+  ExpectFastMatchesSlow<s64>("\xfe\xed\xfe\xed\xfe\xed\xfe\xed\x4e"_su8);
+}
+
+TEST_F(BinaryReadTest, VarInt_FastPathFallbackErrors) {
+  // Over-long and truncated values followed by more data still get the slow
+  // path's errors.
+  Fail(Read<u32>,
+       {{0, "u32"},
+        {4, "Last byte of u32 must be zero extension: expected 0x2, got 0x12"}},
+       "\xf0\xf0\xf0\xf0\x12\x00\x00\x00"_su8);
+  Fail(Read<s32>,
+       {{0, "s32"},
+        {4,
+         "Last byte of s32 must be sign extension: expected "
+         "0x5 or 0x7d, got 0x15"}},
+       "\xf0\xf0\xf0\xf0\x15\x00\x00\x00"_su8);
+}
+
 TEST_F(BinaryReadTest, U8) {
   OK(Read<u8>, 32, "\x20"_su8);
   Fail(Read<u8>, {{0, "Unable to read u8"}}, ""_su8);
@@ -3781,7 +3840,7 @@ TEST_F(BinaryReadTest, ReadVector_u8) {
   SpanU8 copy = data;
   auto result = ReadVector<u8>(&copy, context, "test");
   ExpectNoErrors(errors);
-  EXPECT_EQ((std::vector<At<u8>>{
+  EXPECT_EQ((ArenaVector<At<u8>>{
                 At{"h"_su8, u8{'h'}},
                 At{"e"_su8, u8{'e'}},
                 At{"l"_su8, u8{'l'}},
@@ -3801,7 +3860,7 @@ TEST_F(BinaryReadTest, ReadVector_u32) {
   SpanU8 copy = data;
   auto result = ReadVector<u32>(&copy, context, "test");
   ExpectNoErrors(errors);
-  EXPECT_EQ((std::vector<At<u32>>{
+  EXPECT_EQ((ArenaVector<At<u32>>{
                 At{"\x05"_su8, u32{5}},
                 At{"\x80\x01"_su8, u32{128}},
                 At{"\xcc\xcc\x0c"_su8, u32{206412}},
@@ -0,0 +1,82 @@
+//
+// Copyright 2020 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "wasp/binary/section_directory.h"
+
+#include "gtest/gtest.h"
+#include "test/test_utils.h"
+#include "wasp/binary/read/context.h"
+
+using namespace ::wasp;
+using namespace ::wasp::binary;
+using namespace ::wasp::test;
+
+TEST(BinarySectionDirectoryTest, Basic) {
+  TestErrors errors;
+  Context context{errors};
+  auto directory = ReadSectionDirectory(
+      "\x01\x04\x01\x60\0\0"            // 1 type: params:[] results:[]
+      "\x03\x03\x02\0\0"                // 2 funcs: type 0, type 0
+      "\x08\x01\x00"                    // start: func 0
+      "\x0a\x07\x02\x02\0\x0b\x02\0\x0b"  // 2 code: both empty
+      "\x00\x06\x03yup\0\0"             // Custom section "yup"
+      "\x00\x04\x03yup"                 // Another custom section "yup"
+      "\x00\x05\x04name"_su8,           // Custom section "name"
+      context);
+
+  EXPECT_EQ("\x01\x60\0\0"_su8, directory.Find(SectionId::Type)->data);
+  EXPECT_EQ(1u, directory.GetCount(SectionId::Type));
+  EXPECT_EQ("\x02\0\0"_su8,
+            directory.GetKnownSection(SectionId::Function)->data);
+  EXPECT_EQ(2u, directory.GetCount(SectionId::Function));
+  EXPECT_EQ("\x00"_su8, directory.Find(SectionId::Start)->data);
+  EXPECT_EQ(nullopt, directory.GetCount(SectionId::Start));
+  EXPECT_EQ(2u, directory.GetCount(SectionId::Code));
+
+  EXPECT_EQ(nullopt, directory.Find(SectionId::Import));
+  EXPECT_EQ(nullopt, directory.GetKnownSection(SectionId::Data));
+  EXPECT_EQ(nullopt, directory.GetCount(SectionId::Export));
+
+  ASSERT_EQ(3u, directory.custom_sections().size());
+  EXPECT_EQ("\0\0"_su8, directory.FindCustom("yup")->data);
+  EXPECT_EQ(""_su8, directory.GetCustomSection("name")->data);
+  EXPECT_EQ(nullopt, directory.FindCustom("linking"));
+  ExpectNoErrors(errors);
+}
+
+TEST(BinarySectionDirectoryTest, DuplicateSection) {
+  TestErrors errors;
+  Context context{errors};
+  auto directory = ReadSectionDirectory(
+      "\x03\x02\x01\0"       // 1 func
+      "\x03\x03\x02\0\0"_su8,  // 2 funcs
+      context);
+
+  // Only the first section is recorded.
+  EXPECT_EQ(1u, directory.GetCount(SectionId::Function));
+}
+
+TEST(BinarySectionDirectoryTest, StopsAtBadSection) {
+  TestErrors errors;
+  Context context{errors};
+  auto directory = ReadSectionDirectory(
+      "\x01\x01\x00"       // 0 types
+      "\x03\x05\x01"_su8,  // Function section, past end.
+      context);
+
+  EXPECT_EQ(0u, directory.GetCount(SectionId::Type));
+  EXPECT_EQ(nullopt, directory.Find(SectionId::Function));
+}
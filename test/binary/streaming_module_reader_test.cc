@@ -0,0 +1,214 @@
+//
+// Copyright 2020 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "wasp/binary/streaming_module_reader.h"
+
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "test/test_utils.h"
+#include "wasp/base/concat.h"
+#include "wasp/base/features.h"
+#include "wasp/binary/formatters.h"
+#include "wasp/binary/lazy_module.h"
+#include "wasp/binary/visitor.h"
+
+using namespace ::wasp;
+using namespace ::wasp::binary;
+using namespace ::wasp::test;
+
+namespace {
+
+// (module
+//   (type (func))
+//   (import "" "import" (func (type 0)))
+//   (func (type 0) i32.const 1 drop)
+//   (func (type 0))
+//   (export "export" (func 1))
+//   (@custom "yup" "\00\00"))
+const u8 kTestModule[] = {
+    0x00, 0x61, 0x73, 0x6d, 0x01, 0x00, 0x00, 0x00, 0x01, 0x04, 0x01, 0x60,
+    0x00, 0x00, 0x02, 0x0b, 0x01, 0x00, 0x06, 0x69, 0x6d, 0x70, 0x6f, 0x72,
+    0x74, 0x00, 0x00, 0x03, 0x03, 0x02, 0x00, 0x00, 0x07, 0x0a, 0x01, 0x06,
+    0x65, 0x78, 0x70, 0x6f, 0x72, 0x74, 0x00, 0x01, 0x0a, 0x0a, 0x02, 0x05,
+    0x00, 0x41, 0x01, 0x1a, 0x0b, 0x02, 0x00, 0x0b, 0x00, 0x06, 0x03, 0x79,
+    0x75, 0x70, 0x00, 0x00,
+};
+
+struct LogVisitor : visit::Visitor {
+  using Result = visit::Result;
+
+  Result BeginModule(LazyModule&) { return Log("BeginModule"); }
+  Result EndModule(LazyModule&) { return Log("EndModule"); }
+  Result OnSection(At<Section> section) {
+    if (section->is_custom()) {
+      return Log(concat("OnSection ", section->custom()->name));
+    }
+    return Log(concat("OnSection ", section->id()));
+  }
+  Result OnType(const At<DefinedType>& x) { return Log(concat(x)); }
+  Result OnImport(const At<Import>& x) { return Log(concat(x)); }
+  Result OnFunction(const At<Function>& x) { return Log(concat(x)); }
+  Result OnExport(const At<Export>& x) { return Log(concat(x)); }
+  Result BeginCodeSection(LazyCodeSection sec) {
+    Log(concat("BeginCodeSection ", sec.count));
+    return begin_code_section;
+  }
+  Result BeginCode(const At<Code>& x) { return Log(concat("BeginCode ", x)); }
+  Result OnInstruction(const At<Instruction>& x) { return Log(concat(x)); }
+  Result EndCode(const At<Code>&) { return Log("EndCode"); }
+  Result EndCodeSection(LazyCodeSection sec) {
+    return Log(concat("EndCodeSection ", sec.count));
+  }
+
+  Result Log(std::string str) {
+    log.push_back(str);
+    return Result::Ok;
+  }
+
+  std::vector<std::string> log;
+  Result begin_code_section = Result::Ok;
+};
+
+std::vector<std::string> GetVisitLog(SpanU8 data, LogVisitor visitor) {
+  TestErrors errors;
+  auto module = ReadModule(data, Features{}, errors);
+  visit::Visit(module, visitor);
+  ExpectNoErrors(errors);
+  return visitor.log;
+}
+
+}  // namespace
+
+TEST(BinaryStreamingModuleReaderTest, MatchesVisit) {
+  const SpanU8 data{kTestModule};
+  const auto expected = GetVisitLog(data, LogVisitor{});
+
+  for (size_t chunk_size = 1; chunk_size <= data.size(); ++chunk_size) {
+    TestErrors errors;
+    StreamingErrors streaming_errors{errors};
+    LogVisitor visitor;
+    StreamingModuleReader<LogVisitor> reader{visitor, Features{},
+                                             streaming_errors};
+    for (SpanU8 rest = data; !rest.empty();) {
+      auto chunk = rest.first(std::min(chunk_size, rest.size()));
+      rest.remove_prefix(chunk.size());
+      EXPECT_EQ(visit::Result::Ok, reader.Push(chunk));
+    }
+    EXPECT_EQ(visit::Result::Ok, reader.Finish());
+    EXPECT_EQ(expected, visitor.log) << "chunk size: " << chunk_size;
+    ExpectNoErrors(errors);
+  }
+}
+
+TEST(BinaryStreamingModuleReaderTest, SkipCodeSection) {
+  const SpanU8 data{kTestModule};
+  LogVisitor skip_visitor;
+  skip_visitor.begin_code_section = visit::Result::Skip;
+  const auto expected = GetVisitLog(data, skip_visitor);
+
+  TestErrors errors;
+  StreamingErrors streaming_errors{errors};
+  LogVisitor visitor;
+  visitor.begin_code_section = visit::Result::Skip;
+  StreamingModuleReader<LogVisitor> reader{visitor, Features{},
+                                           streaming_errors};
+  EXPECT_EQ(visit::Result::Ok, reader.Push(data));
+  EXPECT_EQ(visit::Result::Ok, reader.Finish());
+  EXPECT_EQ(expected, visitor.log);
+  ExpectNoErrors(errors);
+}
+
+TEST(BinaryStreamingModuleReaderTest, FailingVisitor) {
+  const SpanU8 data{kTestModule};
+  TestErrors errors;
+  StreamingErrors streaming_errors{errors};
+  LogVisitor visitor;
+  visitor.begin_code_section = visit::Result::Fail;
+  StreamingModuleReader<LogVisitor> reader{visitor, Features{},
+                                           streaming_errors};
+  EXPECT_EQ(visit::Result::Fail, reader.Push(data));
+  EXPECT_EQ(visit::Result::Fail, reader.Finish());
+  EXPECT_EQ("BeginCodeSection 2", visitor.log.back());
+}
+
+TEST(BinaryStreamingModuleReaderTest, BadMagic) {
+  TestErrors errors;
+  StreamingErrors streaming_errors{errors};
+  LogVisitor visitor;
+  StreamingModuleReader<LogVisitor> reader{visitor, Features{},
+                                           streaming_errors};
+  // Like visit::Visit, a bad magic or version is reported, but the rest of
+  // the module is still visited.
+  EXPECT_EQ(visit::Result::Ok, reader.Push("wasm\x01\0\0\0"_su8));
+  EXPECT_EQ(visit::Result::Ok, reader.Finish());
+  ASSERT_EQ(1u, errors.errors.size());
+  EXPECT_EQ(R"(Mismatch: expected "\00\61\73\6d", got "\77\61\73\6d")",
+            errors.errors[0].back().message);
+  // The location refers to the module, not the reader's copy of the header.
+  EXPECT_EQ(0u, streaming_errors.module_offset(errors.errors[0].back().loc));
+  EXPECT_EQ("wasm"_su8, errors.errors[0].back().loc);
+}
+
+TEST(BinaryStreamingModuleReaderTest, TruncatedHeader) {
+  TestErrors errors;
+  StreamingErrors streaming_errors{errors};
+  LogVisitor visitor;
+  StreamingModuleReader<LogVisitor> reader{visitor, Features{},
+                                           streaming_errors};
+  EXPECT_EQ(visit::Result::Ok, reader.Push("\0as"_su8));
+  EXPECT_EQ(visit::Result::Fail, reader.Finish());
+  EXPECT_TRUE(visitor.log.empty());
+  EXPECT_FALSE(errors.errors.empty());
+}
+
+TEST(BinaryStreamingModuleReaderTest, Truncated) {
+  const SpanU8 data{kTestModule};
+  // Stop in the middle of each section, and of each code entry.
+  for (size_t size : {4u, 11u, 30u, 50u, 55u, 60u}) {
+    TestErrors errors;
+    StreamingErrors streaming_errors{errors};
+    LogVisitor visitor;
+    StreamingModuleReader<LogVisitor> reader{visitor, Features{},
+                                             streaming_errors};
+    reader.Push(data.first(size));
+    reader.Finish();
+    EXPECT_FALSE(errors.errors.empty()) << "size: " << size;
+  }
+}
+
+TEST(BinaryStreamingModuleReaderTest, CodeCountMismatch) {
+  TestErrors errors;
+  StreamingErrors streaming_errors{errors};
+  LogVisitor visitor;
+  StreamingModuleReader<LogVisitor> reader{visitor, Features{},
+                                           streaming_errors};
+  const SpanU8 data =
+      "\0asm\x01\0\0\0"
+      "\x01\x04\x01\x60\0\0"           // 1 type: params:[] results:[]
+      "\x03\x02\x01\0"                 // 1 func: type 0
+      "\x0a\x04\x02\x02\0\x0b"_su8;  // code section with count 2, 1 entry.
+  reader.Push(data);
+  reader.Finish();
+  ASSERT_EQ(1u, errors.errors.size());
+  EXPECT_EQ("Expected code section to have count 2, got 1",
+            errors.errors[0].back().message);
+  // Reported at the end of the section, like LazySequence.
+  EXPECT_EQ(data.size(),
+            streaming_errors.module_offset(errors.errors[0].back().loc));
+  EXPECT_EQ(0u, errors.errors[0].back().loc.size());
+}
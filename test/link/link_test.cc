@@ -0,0 +1,290 @@
+//
+// Copyright 2020 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "wasp/link/link.h"
+
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "test/test_utils.h"
+#include "wasp/base/features.h"
+#include "wasp/base/thread_pool.h"
+#include "wasp/binary/eager_module.h"
+
+using namespace ::wasp;
+using namespace ::wasp::binary;
+using namespace ::wasp::link;
+using namespace ::wasp::test;
+
+namespace {
+
+// llvm-mc -triple=wasm32 -filetype=obj main.s
+//
+//   .functype foo () -> (i32)
+//   .globl main
+// main:
+//   .functype main () -> (i32)
+//   call foo
+//   end_function
+const SpanU8 kMain =
+    "\x00\x61\x73\x6d\x01\x00\x00\x00\x01\x85\x80\x80\x80\x00\x01\x60"
+    "\x00\x01\x7f\x02\xa2\x80\x80\x80\x00\x02\x03\x65\x6e\x76\x0f\x5f"
+    "\x5f\x6c\x69\x6e\x65\x61\x72\x5f\x6d\x65\x6d\x6f\x72\x79\x02\x00"
+    "\x00\x03\x65\x6e\x76\x03\x66\x6f\x6f\x00\x00\x03\x82\x80\x80\x80"
+    "\x00\x01\x00\x0a\x8a\x80\x80\x80\x00\x01\x08\x00\x10\x80\x80\x80"
+    "\x80\x00\x0b\x00\x9b\x80\x80\x80\x00\x07\x6c\x69\x6e\x6b\x69\x6e"
+    "\x67\x02\x08\x8c\x80\x80\x80\x00\x02\x00\x00\x01\x04\x6d\x61\x69"
+    "\x6e\x00\x10\x00\x00\x90\x80\x80\x80\x00\x0a\x72\x65\x6c\x6f\x63"
+    "\x2e\x43\x4f\x44\x45\x03\x01\x00\x04\x01"_su8;
+
+// llvm-mc -triple=wasm32 -filetype=obj foo.s
+//
+//   .globaltype __stack_pointer, i32
+//   .functype bar () -> (i32)
+//   .globl foo
+// foo:
+//   .functype foo () -> (i32)
+//   global.get __stack_pointer
+//   drop
+//   i32.const msg
+//   i32.load 0
+//   i32.const bar
+//   i32.add
+//   end_function
+//
+//   .section .data.msg,"",@
+//   .globl msg
+//   .p2align 2
+// msg:
+//   .int32 str
+//   .size msg, 4
+//
+//   .section .rodata.str,"",@
+// str:
+//   .asciz "hello"
+//   .size str, 6
+const SpanU8 kFoo =
+    "\x00\x61\x73\x6d\x01\x00\x00\x00\x01\x85\x80\x80\x80\x00\x01\x60"
+    "\x00\x01\x7f\x02\xdb\x80\x80\x80\x00\x04\x03\x65\x6e\x76\x0f\x5f"
+    "\x5f\x6c\x69\x6e\x65\x61\x72\x5f\x6d\x65\x6d\x6f\x72\x79\x02\x00"
+    "\x01\x03\x65\x6e\x76\x0f\x5f\x5f\x73\x74\x61\x63\x6b\x5f\x70\x6f"
+    "\x69\x6e\x74\x65\x72\x03\x7f\x01\x03\x65\x6e\x76\x03\x62\x61\x72"
+    "\x00\x00\x03\x65\x6e\x76\x19\x5f\x5f\x69\x6e\x64\x69\x72\x65\x63"
+    "\x74\x5f\x66\x75\x6e\x63\x74\x69\x6f\x6e\x5f\x74\x61\x62\x6c\x65"
+    "\x01\x70\x00\x01\x03\x82\x80\x80\x80\x00\x01\x00\x09\x87\x80\x80"
+    "\x80\x00\x01\x00\x41\x01\x0b\x01\x00\x0c\x81\x80\x80\x80\x00\x02"
+    "\x0a\x9b\x80\x80\x80\x00\x01\x19\x00\x23\x80\x80\x80\x80\x00\x1a"
+    "\x41\x80\x80\x80\x80\x00\x28\x02\x00\x41\x81\x80\x80\x80\x00\x6a"
+    "\x0b\x0b\x95\x80\x80\x80\x00\x02\x00\x41\x00\x0b\x04\x04\x00\x00"
+    "\x00\x00\x41\x04\x0b\x06\x68\x65\x6c\x6c\x6f\x00\x00\xd0\x80\x80"
+    "\x80\x00\x07\x6c\x69\x6e\x6b\x69\x6e\x67\x02\x08\xa0\x80\x80\x80"
+    "\x00\x05\x00\x00\x01\x03\x66\x6f\x6f\x02\x10\x00\x01\x00\x03\x6d"
+    "\x73\x67\x00\x00\x04\x00\x10\x00\x01\x02\x03\x73\x74\x72\x01\x00"
+    "\x06\x05\x9b\x80\x80\x80\x00\x02\x09\x2e\x64\x61\x74\x61\x2e\x6d"
+    "\x73\x67\x02\x00\x0b\x2e\x72\x6f\x64\x61\x74\x61\x2e\x73\x74\x72"
+    "\x00\x00\x00\x97\x80\x80\x80\x00\x0a\x72\x65\x6c\x6f\x63\x2e\x43"
+    "\x4f\x44\x45\x05\x03\x07\x04\x01\x04\x0b\x02\x00\x01\x14\x03\x00"
+    "\x91\x80\x80\x80\x00\x0a\x72\x65\x6c\x6f\x63\x2e\x44\x41\x54\x41"
+    "\x06\x01\x05\x06\x04\x00"_su8;
+
+// llvm-mc -triple=wasm32 -filetype=obj bar.s
+//
+//   .globl bar
+// bar:
+//   .functype bar () -> (i32)
+//   i32.const 42
+//   end_function
+const SpanU8 kBar =
+    "\x00\x61\x73\x6d\x01\x00\x00\x00\x01\x85\x80\x80\x80\x00\x01\x60"
+    "\x00\x01\x7f\x02\x98\x80\x80\x80\x00\x01\x03\x65\x6e\x76\x0f\x5f"
+    "\x5f\x6c\x69\x6e\x65\x61\x72\x5f\x6d\x65\x6d\x6f\x72\x79\x02\x00"
+    "\x00\x03\x82\x80\x80\x80\x00\x01\x00\x0a\x86\x80\x80\x80\x00\x01"
+    "\x04\x00\x41\x2a\x0b\x00\x97\x80\x80\x80\x00\x07\x6c\x69\x6e\x6b"
+    "\x69\x6e\x67\x02\x08\x88\x80\x80\x80\x00\x01\x00\x00\x00\x03\x62"
+    "\x61\x72"_su8;
+
+// llvm-mc -triple=wasm32 -filetype=obj weakbar.s
+//
+//   .weak bar
+// bar:
+//   .functype bar () -> (i32)
+//   i32.const 7
+//   end_function
+const SpanU8 kWeakBar =
+    "\x00\x61\x73\x6d\x01\x00\x00\x00\x01\x85\x80\x80\x80\x00\x01\x60"
+    "\x00\x01\x7f\x02\x98\x80\x80\x80\x00\x01\x03\x65\x6e\x76\x0f\x5f"
+    "\x5f\x6c\x69\x6e\x65\x61\x72\x5f\x6d\x65\x6d\x6f\x72\x79\x02\x00"
+    "\x00\x03\x82\x80\x80\x80\x00\x01\x00\x0a\x86\x80\x80\x80\x00\x01"
+    "\x04\x00\x41\x07\x0b\x00\x97\x80\x80\x80\x00\x07\x6c\x69\x6e\x6b"
+    "\x69\x6e\x67\x02\x08\x88\x80\x80\x80\x00\x01\x00\x01\x00\x03\x62"
+    "\x61\x72"_su8;
+
+// llvm-mc -triple=wasm32 -filetype=obj inl.s
+//
+//   .section .text.inl,"G",@,inl,comdat
+//   .weak inl
+// inl:
+//   .functype inl () -> (i32)
+//   i32.const 5
+//   end_function
+const SpanU8 kInl =
+    "\x00\x61\x73\x6d\x01\x00\x00\x00\x01\x85\x80\x80\x80\x00\x01\x60"
+    "\x00\x01\x7f\x02\x98\x80\x80\x80\x00\x01\x03\x65\x6e\x76\x0f\x5f"
+    "\x5f\x6c\x69\x6e\x65\x61\x72\x5f\x6d\x65\x6d\x6f\x72\x79\x02\x00"
+    "\x00\x03\x82\x80\x80\x80\x00\x01\x00\x0a\x86\x80\x80\x80\x00\x01"
+    "\x04\x00\x41\x05\x0b\x00\xa6\x80\x80\x80\x00\x07\x6c\x69\x6e\x6b"
+    "\x69\x6e\x67\x02\x08\x88\x80\x80\x80\x00\x01\x00\x01\x00\x03\x69"
+    "\x6e\x6c\x07\x89\x80\x80\x80\x00\x01\x03\x69\x6e\x6c\x00\x01\x01"
+    "\x00"_su8;
+
+Features LinkFeatures() {
+  // llvm-mc always writes a data count section.
+  Features features;
+  features.enable_bulk_memory();
+  return features;
+}
+
+auto LinkObjects(std::vector<SpanU8> objects,
+                 TestErrors& errors,
+                 const LinkOptions& options = {},
+                 ThreadPool* thread_pool = nullptr) -> optional<Buffer> {
+  return Link(objects, LinkFeatures(), options, errors, thread_pool);
+}
+
+auto ReadOutput(const Buffer& buffer) -> Module {
+  TestErrors errors;
+  auto module = ReadModuleEager(buffer, LinkFeatures(), errors);
+  ExpectNoErrors(errors);
+  return module;
+}
+
+}  // namespace
+
+TEST(LinkTest, Basic) {
+  TestErrors errors;
+  LinkOptions options;
+  options.exports = {"main"};
+  auto buffer = LinkObjects({kMain, kFoo, kBar}, errors, options);
+  ExpectNoErrors(errors);
+  ASSERT_TRUE(buffer.has_value());
+
+  auto module = ReadOutput(*buffer);
+  EXPECT_EQ(0u, module.imports.size());
+  EXPECT_EQ(1u, module.types.size());
+  ASSERT_EQ(3u, module.codes.size());
+
+  // main: call foo
+  const auto& main_body = module.codes[0]->body.instructions;
+  EXPECT_EQ(Opcode::Call, main_body[0]->opcode);
+  EXPECT_EQ(Index{1}, main_body[0]->index_immediate());
+
+  // foo: global.get __stack_pointer, drop, i32.const msg, i32.load,
+  //      i32.const bar (table slot), i32.add
+  const auto& foo_body = module.codes[1]->body.instructions;
+  EXPECT_EQ(Index{0}, foo_body[0]->index_immediate());
+  EXPECT_EQ(s32{1024}, foo_body[2]->s32_immediate());
+  EXPECT_EQ(s32{1}, foo_body[4]->s32_immediate());
+
+  // The table holds bar in slot 1.
+  ASSERT_EQ(1u, module.element_segments.size());
+  ASSERT_EQ(1u, module.element_segments[0]->indexes().list.size());
+  EXPECT_EQ(Index{2}, module.element_segments[0]->indexes().list[0]);
+
+  // msg holds the address of str, which follows it.
+  ASSERT_EQ(2u, module.data_segments.size());
+  EXPECT_EQ("\x04\x04\x00\x00"_su8, module.data_segments[0]->init);
+  EXPECT_EQ("hello\0"_su8, module.data_segments[1]->init);
+
+  // The stack is placed after the data, 16-byte aligned.
+  ASSERT_EQ(1u, module.globals.size());
+  EXPECT_EQ(s32{1040 + 64 * 1024},
+            module.globals[0]->init->instructions[0]->s32_immediate());
+
+  ASSERT_EQ(2u, module.exports.size());
+  EXPECT_EQ("memory"_sv, module.exports[0]->name);
+  EXPECT_EQ("main"_sv, module.exports[1]->name);
+  EXPECT_EQ(Index{0}, module.exports[1]->index);
+}
+
+TEST(LinkTest, UndefinedFunctionIsImported) {
+  TestErrors errors;
+  auto buffer = LinkObjects({kMain}, errors);
+  ExpectNoErrors(errors);
+  ASSERT_TRUE(buffer.has_value());
+
+  auto module = ReadOutput(*buffer);
+  ASSERT_EQ(1u, module.imports.size());
+  EXPECT_EQ("env"_sv, module.imports[0]->module);
+  EXPECT_EQ("foo"_sv, module.imports[0]->name);
+  ASSERT_EQ(1u, module.codes.size());
+  EXPECT_EQ(Index{0}, module.codes[0]->body.instructions[0]->index_immediate());
+}
+
+TEST(LinkTest, StrongOverridesWeak) {
+  TestErrors errors;
+  auto buffer = LinkObjects({kWeakBar, kMain, kFoo, kBar}, errors);
+  ExpectNoErrors(errors);
+  ASSERT_TRUE(buffer.has_value());
+
+  // The table slot for bar refers to the strong definition, function 3.
+  auto module = ReadOutput(*buffer);
+  ASSERT_EQ(1u, module.element_segments.size());
+  EXPECT_EQ(Index{3}, module.element_segments[0]->indexes().list[0]);
+}
+
+TEST(LinkTest, DuplicateSymbol) {
+  TestErrors errors;
+  EXPECT_EQ(nullopt, LinkObjects({kBar, kBar}, errors));
+  EXPECT_EQ(1u, errors.errors.size());
+}
+
+TEST(LinkTest, Comdat) {
+  TestErrors errors;
+  auto buffer = LinkObjects({kInl, kInl}, errors);
+  ExpectNoErrors(errors);
+  ASSERT_TRUE(buffer.has_value());
+  EXPECT_EQ(1u, ReadOutput(*buffer).codes.size());
+}
+
+TEST(LinkTest, NotRelocatable) {
+  const SpanU8 module = "\0asm\x01\x00\x00\x00"_su8;
+  TestErrors errors;
+  EXPECT_EQ(nullopt, LinkObjects({module}, errors));
+  EXPECT_EQ(1u, errors.errors.size());
+}
+
+TEST(LinkTest, UndefinedExport) {
+  TestErrors errors;
+  LinkOptions options;
+  options.exports = {"missing"};
+  EXPECT_EQ(nullopt, LinkObjects({kBar}, errors, options));
+  EXPECT_EQ(1u, errors.errors.size());
+}
+
+TEST(LinkTest, ParallelMatchesSerial) {
+  TestErrors serial_errors;
+  auto serial = LinkObjects({kWeakBar, kMain, kFoo, kBar}, serial_errors);
+  ASSERT_TRUE(serial.has_value());
+
+  for (int thread_count : {1, 2, 4}) {
+    ThreadPool pool{thread_count};
+    TestErrors parallel_errors;
+    auto parallel = LinkObjects({kWeakBar, kMain, kFoo, kBar},
+                                parallel_errors, {}, &pool);
+    ExpectNoErrors(parallel_errors);
+    EXPECT_EQ(serial, parallel);
+  }
+}
@@ -42,34 +42,27 @@ std::string TestErrorsToString(const TestErrors& errors) {
 }
 
 void TestErrors::Clear() {
-  context_stack.clear();
   errors.clear();
 }
 
-void TestErrors::HandlePushContext(Location loc, string_view desc) {
-  context_stack.push_back(Error{loc, std::string{desc}});
-}
-
-void TestErrors::HandlePopContext() {
-  context_stack.pop_back();
-}
-
 void TestErrors::HandleOnError(Location loc, string_view message) {
   errors.emplace_back();
   auto& error = errors.back();
-  error = context_stack;
+  for (const auto& item : context()) {
+    error.push_back(Error{item.loc, std::string{item.desc}});
+  }
   error.push_back(Error{loc, std::string{message}});
 }
 
 void ExpectNoErrors(const TestErrors& errors) {
   EXPECT_TRUE(errors.errors.empty()) << TestErrorsToString(errors);
-  EXPECT_TRUE(errors.context_stack.empty());
+  EXPECT_TRUE(errors.context().empty());
 }
 
 void ExpectErrors(const std::vector<ExpectedError>& expected_errors,
                   const TestErrors& errors,
                   SpanU8 orig_data) {
-  EXPECT_TRUE(errors.context_stack.empty());
+  EXPECT_TRUE(errors.context().empty());
   ASSERT_EQ(expected_errors.size(), errors.errors.size());
   for (size_t j = 0; j < expected_errors.size(); ++j) {
     const ExpectedError& expected = expected_errors[j];
@@ -90,7 +83,7 @@ void ExpectError(const ExpectedError& expected,
 
 void ExpectErrors(const std::vector<ErrorList>& expected_errors,
                   const TestErrors& errors) {
-  EXPECT_TRUE(errors.context_stack.empty());
+  EXPECT_TRUE(errors.context().empty());
   ASSERT_EQ(expected_errors.size(), errors.errors.size());
   for (size_t j = 0; j < expected_errors.size(); ++j) {
     const ErrorList& expected = expected_errors[j];
@@ -36,14 +36,11 @@ using ExpectedError = std::vector<ErrorWithPos>;
 
 class TestErrors : public Errors {
  public:
-  std::vector<Error> context_stack;
   std::vector<ErrorList> errors;
 
   void Clear();
 
  protected:
-  void HandlePushContext(Location loc, string_view desc);
-  void HandlePopContext();
   void HandleOnError(Location loc, string_view message);
 };
 
@@ -164,3 +164,116 @@ TEST(ValidLocalMapTest, PopToEmpty) {
   locals.Pop();
   ExpectTypes(locals, {});
 }
+
+TEST(ValidLocalMapTest, DenseLimit_Append) {
+  // Appending past the limit switches to the run-length encoding.
+  LocalMap locals{4};
+
+  EXPECT_TRUE(locals.Append(2, VT_I32));
+  EXPECT_TRUE(locals.Append(1, VT_F32));
+  ExpectTypes(locals, {VT_I32, VT_I32, VT_F32});
+
+  EXPECT_TRUE(locals.Append(1, VT_I64));
+  ExpectTypes(locals, {VT_I32, VT_I32, VT_F32, VT_I64});
+
+  EXPECT_TRUE(locals.Append(2, VT_F64));
+  ExpectTypes(locals, {VT_I32, VT_I32, VT_F32, VT_I64, VT_F64, VT_F64});
+
+  EXPECT_TRUE(locals.Append({VT_I32, VT_I64}));
+  ExpectTypes(locals, {VT_I32, VT_I32, VT_F32, VT_I64, VT_F64, VT_F64,
+                       VT_I32, VT_I64});
+}
+
+TEST(ValidLocalMapTest, DenseLimit_Large) {
+  LocalMap locals{4};
+  EXPECT_TRUE(locals.Append(3, VT_I32));
+  EXPECT_TRUE(locals.Append(100, VT_F32));
+  EXPECT_TRUE(locals.Append(1, VT_I64));
+
+  EXPECT_EQ(104u, locals.GetCount());
+  EXPECT_EQ(VT_I32, locals.GetType(0));
+  EXPECT_EQ(VT_I32, locals.GetType(2));
+  EXPECT_EQ(VT_F32, locals.GetType(3));
+  EXPECT_EQ(VT_F32, locals.GetType(102));
+  EXPECT_EQ(VT_I64, locals.GetType(103));
+  EXPECT_EQ(nullopt, locals.GetType(104));
+  EXPECT_EQ(nullopt, locals.GetType(0xffff'ffff));
+}
+
+TEST(ValidLocalMapTest, DenseLimit_PushPop) {
+  LocalMap locals{4};
+
+  EXPECT_TRUE(locals.Append(2, VT_I32));
+  EXPECT_TRUE(locals.Append(1, VT_F32));
+  ExpectTypes(locals, {VT_I32, VT_I32, VT_F32});
+
+  // The let block crosses the limit.
+  locals.Push();
+  EXPECT_TRUE(locals.Append(2, VT_I64));
+  ExpectTypes(locals, {VT_I64, VT_I64, VT_I32, VT_I32, VT_F32});
+
+  // Nested let block, with the sparse path already active.
+  locals.Push();
+  EXPECT_TRUE(locals.Append(1, VT_F64));
+  EXPECT_TRUE(locals.Append(1, VT_I32));
+  ExpectTypes(locals,
+              {VT_F64, VT_I32, VT_I64, VT_I64, VT_I32, VT_I32, VT_F32});
+  EXPECT_EQ(nullopt, locals.GetType(7));
+
+  locals.Pop();
+  ExpectTypes(locals, {VT_I64, VT_I64, VT_I32, VT_I32, VT_F32});
+
+  // Appending to the outer let block after popping the inner one.
+  EXPECT_TRUE(locals.Append(1, VT_I64));
+  ExpectTypes(locals, {VT_I64, VT_I64, VT_I64, VT_I32, VT_I32, VT_F32});
+
+  locals.Pop();
+  ExpectTypes(locals, {VT_I32, VT_I32, VT_F32});
+  EXPECT_EQ(nullopt, locals.GetType(3));
+
+  // Appending to the function's block still works.
+  EXPECT_TRUE(locals.Append(2, VT_F64));
+  ExpectTypes(locals, {VT_I32, VT_I32, VT_F32, VT_F64, VT_F64});
+}
+
+TEST(ValidLocalMapTest, DenseLimit_PushPopWithinLimit) {
+  // A let block that stays within the limit keeps the dense path.
+  LocalMap locals{4};
+
+  EXPECT_TRUE(locals.Append(1, VT_I32));
+  locals.Push();
+  EXPECT_TRUE(locals.Append(2, VT_F32));
+  ExpectTypes(locals, {VT_F32, VT_F32, VT_I32});
+  locals.Pop();
+  ExpectTypes(locals, {VT_I32});
+
+  locals.Push();
+  EXPECT_TRUE(locals.Append(3, VT_I64));
+  ExpectTypes(locals, {VT_I64, VT_I64, VT_I64, VT_I32});
+  locals.Pop();
+  ExpectTypes(locals, {VT_I32});
+}
+
+TEST(ValidLocalMapTest, DenseLimit_Reset) {
+  LocalMap locals{4};
+  EXPECT_TRUE(locals.Append(10, VT_I32));
+  ExpectTypes(locals, binary::ValueTypeList(10, VT_I32));
+
+  // Reset starts with the dense representation again.
+  locals.Reset();
+  EXPECT_EQ(nullopt, locals.GetType(0));
+  EXPECT_TRUE(locals.Append(1, VT_F64));
+  EXPECT_TRUE(locals.Append(1, VT_F32));
+  ExpectTypes(locals, {VT_F64, VT_F32});
+}
+
+TEST(ValidLocalMapTest, DenseLimit_Zero) {
+  // Every local uses the run-length encoding.
+  LocalMap locals{0};
+  EXPECT_TRUE(locals.Append(1, VT_I32));
+  locals.Push();
+  EXPECT_TRUE(locals.Append(1, VT_F32));
+  ExpectTypes(locals, {VT_F32, VT_I32});
+  locals.Pop();
+  ExpectTypes(locals, {VT_I32});
+}
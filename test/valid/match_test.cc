@@ -298,6 +298,49 @@ TEST_F(ValidMatchTest, IsSame_ValueType_VarMutuallyRecursive) {
   EXPECT_TRUE(IsSame(context, VT_Ref1, VT_Ref2));
 }
 
+TEST_F(ValidMatchTest, IsSame_ValueType_VarRecursiveCycles) {
+  // Cycles of different lengths that unroll to the same infinite type.
+  context.same_types.Reset(3);
+  PushStructType(StructType{FieldTypeList{
+      FieldType{StorageType{VT_Ref0}, Mutability::Const}}});  // 0
+  PushStructType(StructType{FieldTypeList{
+      FieldType{StorageType{VT_Ref2}, Mutability::Const}}});  // 1
+  PushStructType(StructType{FieldTypeList{
+      FieldType{StorageType{VT_Ref1}, Mutability::Const}}});  // 2
+
+  EXPECT_TRUE(IsSame(context, VT_Ref0, VT_Ref1));
+  EXPECT_TRUE(IsSame(context, VT_Ref0, VT_Ref2));
+  EXPECT_TRUE(IsSame(context, VT_Ref1, VT_Ref2));
+  EXPECT_FALSE(IsSame(context, VT_RefNull0, VT_Ref1));
+}
+
+TEST_F(ValidMatchTest, IsSame_ValueType_VarLongChains) {
+  // Two chains of structs, each referencing the next, which only differ at
+  // the end, and a third that is the same as the first.
+  const Index kLength = 1000;
+  auto ref = [](Index index) {
+    return ValueType{ReferenceType{RefType{HeapType{Index{index}}, Null::No}}};
+  };
+  auto push_chain = [&](Index start, const ValueType& last) {
+    for (Index i = 0; i < kLength - 1; ++i) {
+      PushStructType(StructType{FieldTypeList{
+          FieldType{StorageType{ref(start + i + 1)}, Mutability::Const}}});
+    }
+    PushStructType(StructType{
+        FieldTypeList{FieldType{StorageType{last}, Mutability::Const}}});
+  };
+  context.same_types.Reset(3 * kLength);
+  push_chain(0, VT_I32);
+  push_chain(kLength, VT_I64);
+  push_chain(2 * kLength, VT_I32);
+
+  for (Index i = 0; i < kLength; ++i) {
+    EXPECT_FALSE(IsSame(context, ref(i), ref(kLength + i)));
+    EXPECT_TRUE(IsSame(context, ref(i), ref(2 * kLength + i)));
+  }
+  EXPECT_FALSE(IsSame(context, ref(0), ref(1)));
+}
+
 TEST_F(ValidMatchTest, IsSame_StorageType) {
   std::vector<StorageType> types{
       StorageType{VT_I32},
@@ -677,6 +720,20 @@ TEST_F(ValidMatchTest, IsMatch_StructType_Subtyping) {
                           FieldType{StorageType{VT_I32}, Mutability::Var}}}));
 }
 
+TEST_F(ValidMatchTest, IsMatch_StructType_SubtypingIsDirected) {
+  context.match_types.Reset();
+  PushStructType(StructType{FieldTypeList{
+      FieldType{StorageType{VT_I32}, Mutability::Const}}});  // 0
+  PushStructType(StructType{
+      FieldTypeList{FieldType{StorageType{VT_I32}, Mutability::Const},
+                    FieldType{StorageType{VT_I64}, Mutability::Const}}});  // 1
+
+  // The result for one direction must not be reused for the other.
+  EXPECT_TRUE(IsMatch(context, VT_Ref0, VT_Ref1));
+  EXPECT_FALSE(IsMatch(context, VT_Ref1, VT_Ref0));
+  EXPECT_TRUE(IsMatch(context, VT_Ref0, VT_Ref1));
+}
+
 TEST_F(ValidMatchTest, IsMatch_ArrayType_Simple) {
   std::vector<ArrayType> types{
       ArrayType{FieldType{StorageType{VT_I32}, Mutability::Const}},
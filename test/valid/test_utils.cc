@@ -23,7 +23,7 @@ namespace wasp::valid::test {
 void ExpectErrors(const std::vector<ExpectedError>& expected_errors,
                   TestErrors& errors) {
   // TODO: Share w/ binary/test_utils.cc
-  EXPECT_TRUE(errors.context_stack.empty());
+  EXPECT_TRUE(errors.context().empty());
   ASSERT_EQ(expected_errors.size(), errors.errors.size());
   for (size_t j = 0; j < expected_errors.size(); ++j) {
     const ExpectedError& expected = expected_errors[j];
@@ -58,7 +58,6 @@ void ExpectErrorSubstr(const ExpectedError& expected, TestErrors& errors) {
 }
 
 void ClearErrors(TestErrors& errors) {
-  errors.context_stack.clear();
   errors.errors.clear();
 }
 
@@ -0,0 +1,165 @@
+//
+// Copyright 2020 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "wasp/valid/validate_expression.h"
+
+#include <random>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "test/binary/constants.h"
+#include "test/test_utils.h"
+#include "wasp/base/features.h"
+#include "wasp/binary/lazy_expression.h"
+#include "wasp/valid/validate.h"
+
+using namespace ::wasp;
+using namespace ::wasp::binary::test;
+using namespace ::wasp::test;
+
+namespace {
+
+struct Result {
+  bool valid;
+  TestErrors errors;
+};
+
+enum class Mode { Fused, Unfused };
+
+// Validates `data` as the body of a function `(param i32) (result i32)`, in a
+// module with a memory and a mutable i32 global.
+void Validate(SpanU8 data, Mode mode, Result* result) {
+  Features features;
+  auto& errors = result->errors;
+  valid::Context context{features, errors};
+  context.types.push_back(binary::DefinedType{
+      binary::FunctionType{{VT_I32}, {VT_I32}}});
+  context.defined_type_count = 1;
+  context.same_types.Reset(1);
+  context.match_types.Reset();
+  context.functions.push_back(binary::Function{0});
+  context.memories.push_back(MemoryType{Limits{1}});
+  context.globals.push_back(binary::GlobalType{VT_I32, Mutability::Var});
+  ASSERT_TRUE(valid::BeginCode(context, Location{}));
+
+  binary::Context binary_context{features, errors};
+  if (mode == Mode::Fused) {
+    result->valid = valid::ValidateExpression(context, binary_context, data);
+  } else {
+    result->valid = true;
+    for (auto&& instr : binary::ReadExpression(data, binary_context)) {
+      if (!valid::Validate(context, instr)) {
+        result->valid = false;
+        break;
+      }
+    }
+  }
+}
+
+void ExpectSameAsUnfused(SpanU8 data) {
+  Result fused, unfused;
+  Validate(data, Mode::Fused, &fused);
+  Validate(data, Mode::Unfused, &unfused);
+  EXPECT_EQ(unfused.valid, fused.valid);
+  ExpectErrors(unfused.errors.errors, fused.errors);
+}
+
+// Exercises every instruction that ValidateExpression decodes itself.
+const SpanU8 kBody =
+    "\x02\x40"              // block
+    "\x03\x7f"              //   loop (result i32)
+    "\x20\x00"              //     local.get 0
+    "\x04\x7f"              //     if (result i32)
+    "\x41\x01"              //       i32.const 1
+    "\x05"                  //     else
+    "\x42\x80\x01"          //       i64.const 128
+    "\xa7"                  //       i32.wrap_i64
+    "\x0b"                  //     end
+    "\x22\x00"              //     local.tee 0
+    "\x0d\x00"              //     br_if 0
+    "\x20\x00"              //     local.get 0
+    "\x20\x00"              //     local.get 0
+    "\x0e\x02\x01\x01\x01"  //     br_table 1 1 1
+    "\x0b"                  //   end
+    "\x0c\x00"              //   br 0
+    "\x0b"                  // end
+    "\x23\x00"              // global.get 0
+    "\x41\x00"              // i32.const 0
+    "\x28\x02\x04"          // i32.load align=4 offset=4
+    "\x6a"                  // i32.add
+    "\x24\x00"              // global.set 0
+    "\x41\x00"              // i32.const 0
+    "\x43\x00\x00\x80\x3f"  // f32.const 1
+    "\x38\x02\x00"          // f32.store
+    "\x3f\x00"              // memory.size
+    "\x40\x00"              // memory.grow
+    "\x1a"                  // drop
+    "\x44\x00\x00\x00\x00\x00\x00\xf0\x3f"  // f64.const 1
+    "\x1a"                  // drop
+    "\x01"                  // nop
+    "\x20\x00"              // local.get 0
+    "\x21\x00"              // local.set 0
+    "\x23\x00"              // global.get 0
+    "\x10\x00"              // call 0
+    "\x41\x00"              // i32.const 0
+    "\x20\x00"              // local.get 0
+    "\x1b"                  // select
+    "\x0f"                  // return
+    "\x00"                  // unreachable
+    "\x0b"_su8;             // end
+
+}  // namespace
+
+TEST(ValidateExpressionTest, Valid) {
+  Result result;
+  Validate(kBody, Mode::Fused, &result);
+  EXPECT_TRUE(result.valid);
+  ExpectNoErrors(result.errors);
+  ExpectSameAsUnfused(kBody);
+}
+
+TEST(ValidateExpressionTest, Invalid) {
+  // Validation errors.
+  ExpectSameAsUnfused("\x6a\x0b"_su8);              // i32.add
+  ExpectSameAsUnfused("\x42\x00\x0b"_su8);          // i64.const 0
+  ExpectSameAsUnfused("\x0c\x05\x0b"_su8);          // br 5
+  ExpectSameAsUnfused("\x20\x01\x0b"_su8);          // local.get 1
+  ExpectSameAsUnfused("\x41\x00\x28\x03\x00\x0b"_su8);  // bad alignment
+  ExpectSameAsUnfused("\x41\x00\x0e\x01\x00\x02\x0b"_su8);  // br_table 0 2
+  ExpectSameAsUnfused("\x02\x7e\x0b\x0b"_su8);      // block (result i64)
+
+  // Read errors, which are reported by binary::Read.
+  ExpectSameAsUnfused("\x20"_su8);                  // truncated local.get
+  ExpectSameAsUnfused("\x20\x80\x80\x80\x80\x70\x0b"_su8);  // bad LEB128
+  ExpectSameAsUnfused("\x05\x0b"_su8);              // else without if
+  ExpectSameAsUnfused("\x3f\x01\x0b"_su8);          // bad reserved byte
+  ExpectSameAsUnfused("\x20\x00\x0b\x01"_su8);      // nop after final end
+  ExpectSameAsUnfused("\xff\x0b"_su8);              // unknown opcode
+}
+
+TEST(ValidateExpressionTest, Mutations) {
+  // Corrupt bytes of a valid body; both ways of validating must always agree.
+  std::mt19937 rng{0};
+  std::vector<u8> body(kBody.begin(), kBody.end());
+  for (int i = 0; i < 2000; ++i) {
+    std::vector<u8> mutated = body;
+    int count = 1 + rng() % 3;
+    for (int j = 0; j < count; ++j) {
+      mutated[rng() % mutated.size()] = static_cast<u8>(rng());
+    }
+    ExpectSameAsUnfused(SpanU8{mutated});
+  }
+}
@@ -66,7 +66,7 @@ class ValidateInstructionTest : public ::testing::Test {
   void IncrementDefinedTypeCount() {
     context.defined_type_count++;
     context.same_types.Reset(context.defined_type_count);
-    context.match_types.Reset(context.defined_type_count);
+    context.match_types.Reset();
   }
 
   Index AddFunctionType(const FunctionType& function_type) {
@@ -137,7 +137,7 @@ class ValidateInstructionTest : public ::testing::Test {
                        const StackTypeList& result_types) {
     TestErrors errors;
     Context context_copy{context, errors};
-    context_copy.type_stack = param_types;
+    context_copy.type_stack.assign(param_types.begin(), param_types.end());
     EXPECT_TRUE(Validate(context_copy, instruction))
         << concat(instruction, " with stack ", param_types);
     EXPECT_TRUE(IsSame(context, result_types, context_copy.type_stack))
@@ -151,7 +151,8 @@ class ValidateInstructionTest : public ::testing::Test {
     TestErrors errors;
     Context context_copy{context, errors};
     context_copy.label_stack.back().unreachable = true;
-    context_copy.type_stack = ToStackTypeList(param_types);
+    auto stack_types = ToStackTypeList(param_types);
+    context_copy.type_stack.assign(stack_types.begin(), stack_types.end());
     EXPECT_TRUE(Validate(context_copy, instruction)) << instruction;
     EXPECT_TRUE(
         IsSame(context, ToStackTypeList(result_types), context_copy.type_stack))
@@ -163,7 +164,7 @@ class ValidateInstructionTest : public ::testing::Test {
                          const StackTypeList& param_types) {
     ErrorsNop errors_nop;
     Context context_copy{context, errors_nop};
-    context_copy.type_stack = param_types;
+    context_copy.type_stack.assign(param_types.begin(), param_types.end());
     EXPECT_FALSE(Validate(context_copy, instruction))
         << concat(instruction, " with stack ", param_types);
   }
@@ -2054,7 +2055,7 @@ TEST_F(ValidateInstructionTest, TableGrow) {
 }
 
 TEST_F(ValidateInstructionTest, TableGrow_TableIndexOOB) {
-  context.type_stack = StackTypeList{ST::Funcref(), ST::I32()};
+  context.type_stack = {ST::Funcref(), ST::I32()};
   Fail(I{O::TableGrow, Index{0}});
   ExpectError({"instruction", "Invalid table index 0, must be less than 0"},
                errors);
@@ -2077,7 +2078,7 @@ TEST_F(ValidateInstructionTest, TableFill) {
 }
 
 TEST_F(ValidateInstructionTest, TableFill_TableIndexOOB) {
-  context.type_stack = StackTypeList{ST::I32(), ST::Funcref(), ST::I32()};
+  context.type_stack = {ST::I32(), ST::Funcref(), ST::I32()};
   Fail(I{O::TableFill, Index{0}});
   ExpectError({"instruction", "Invalid table index 0, must be less than 0"},
                errors);
@@ -2298,17 +2299,17 @@ TEST_F(ValidateInstructionTest, SimdShuffle) {
 
 TEST_F(ValidateInstructionTest, SimdShuffle_ValidLane) {
   // Test valid indexes.
-  context.type_stack = StackTypeList{ST::V128(), ST::V128()};
+  context.type_stack = {ST::V128(), ST::V128()};
   Ok(I{O::I8X16Shuffle, ShuffleImmediate{{0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11,
                                           12, 13, 14, 15}}});
 
   // 16 through 31 is also allowed.
-  context.type_stack = StackTypeList{ST::V128(), ST::V128()};
+  context.type_stack = {ST::V128(), ST::V128()};
   Ok(I{O::I8X16Shuffle, ShuffleImmediate{{16, 17, 18, 19, 20, 21, 22, 23, 24,
                                           25, 26, 27, 28, 29, 30, 31}}});
 
   // >= 32 is not allowed.
-  context.type_stack = StackTypeList{ST::V128(), ST::V128()};
+  context.type_stack = {ST::V128(), ST::V128()};
   Fail(I{O::I8X16Shuffle,
          ShuffleImmediate{{32, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0}}});
 }
@@ -2365,12 +2366,12 @@ TEST_F(ValidateInstructionTest, SimdExtractLanes_ValidLane) {
   for (const auto& info: infos) {
     // Test valid indexes.
     for (SimdLaneImmediate imm = 0; imm < info.max_valid_lane; ++imm) {
-      context.type_stack = StackTypeList{ST::V128()};
+      context.type_stack = {ST::V128()};
       Ok(I{info.opcode, imm});
     }
 
     // Test invalid indexes.
-    context.type_stack = StackTypeList{ST::V128()};
+    context.type_stack = {ST::V128()};
     Fail(I{info.opcode, SimdLaneImmediate(info.max_valid_lane + 1)});
   }
 }
@@ -2404,12 +2405,12 @@ TEST_F(ValidateInstructionTest, SimdReplaceLanes_ValidLane) {
   for (const auto& info: infos) {
     // Test valid indexes.
     for (SimdLaneImmediate imm = 0; imm < info.max_valid_lane; ++imm) {
-      context.type_stack = StackTypeList{ST::V128(), info.stack_type};
+      context.type_stack = {ST::V128(), info.stack_type};
       Ok(I{info.opcode, imm});
     }
 
     // Test invalid indexes.
-    context.type_stack = StackTypeList{ST::V128(), info.stack_type};
+    context.type_stack = {ST::V128(), info.stack_type};
     Fail(I{info.opcode, SimdLaneImmediate(info.max_valid_lane + 1)});
   }
 }
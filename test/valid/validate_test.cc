@@ -525,6 +525,8 @@ TEST(ValidateTest, Export_IndexOOB) {
     TestErrors errors;
     Context context{errors};
     EXPECT_FALSE(Validate(context, export_));
+    // An invalid function index is not declared.
+    EXPECT_EQ(0u, context.declared_functions.size());
   }
 }
 
@@ -1086,6 +1088,15 @@ TEST(ValidateTest, Rtt) {
   EXPECT_TRUE(Validate(context, Rtt{123, HT_I31}));
   EXPECT_TRUE(Validate(context, Rtt{123, HT_Eq}));
   EXPECT_TRUE(Validate(context, Rtt{123, HT_0}));
+  EXPECT_TRUE(Validate(context, Rtt{StackType::kMaxRttDepth, HT_0}));
+}
+
+TEST(ValidateTest, Rtt_DepthTooLarge) {
+  TestErrors errors;
+  Context context{errors};
+  EXPECT_FALSE(Validate(context, Rtt{StackType::kMaxRttDepth + 1, HT_Any}));
+  EXPECT_FALSE(
+      Validate(context, ValueType{Rtt{StackType::kMaxRttDepth + 1, HT_Any}}));
 }
 
 TEST(ValidateTest, Start) {
@@ -0,0 +1,154 @@
+//
+// Copyright 2020 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "wasp/valid/validate_visitor.h"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "test/test_utils.h"
+#include "wasp/base/buffer.h"
+#include "wasp/base/concat.h"
+#include "wasp/base/features.h"
+#include "wasp/base/thread_pool.h"
+#include "wasp/binary/lazy_module.h"
+#include "wasp/binary/streaming_module_reader.h"
+
+using namespace ::wasp;
+using namespace ::wasp::binary;
+using namespace ::wasp::valid;
+using namespace ::wasp::test;
+
+namespace {
+
+// A module with one type `(func)` and six functions. Functions 2 and 4 have
+// invalid bodies (`drop` with an empty stack).
+const SpanU8 kModule =
+    "\0asm\x01\x00\x00\x00"
+    "\x01\x04\x01\x60\x00\x00"  // type section
+    "\x03\x07\x06\x00\x00\x00\x00\x00\x00"  // function section
+    "\x0a\x17\x06"  // code section
+    "\x02\x00\x0b"  // func 0
+    "\x02\x00\x0b"  // func 1
+    "\x04\x00\x01\x1a\x0b"  // func 2 (invalid)
+    "\x02\x00\x0b"  // func 3
+    "\x04\x00\x01\x1a\x0b"  // func 4 (invalid)
+    "\x02\x00\x0b"_su8;  // func 5
+
+// Code batches of kModule.size() bytes hold all of the functions; batches of
+// 1 byte hold one function each.
+const size_t kBatchSizes[] = {kModule.size(), 1};
+
+bool Validate(SpanU8 data,
+              TestErrors& errors,
+              ThreadPool* pool,
+              size_t code_batch_size = kModule.size()) {
+  Features features;
+  LazyModule module = ReadModule(data, features, errors);
+  ValidateVisitor visitor{features, errors, pool};
+  visitor.code_batch_size = code_batch_size;
+  return visit::Visit(module, visitor) == visit::Result::Ok;
+}
+
+// Streams `data` in chunks of `chunk_size` bytes. Each chunk is a copy that is
+// overwritten after it is pushed, like a reused read buffer.
+bool ValidateStreaming(SpanU8 data,
+                       size_t chunk_size,
+                       size_t code_batch_size,
+                       StreamingErrors& errors,
+                       ThreadPool* pool) {
+  Features features;
+  ValidateVisitor visitor{features, errors, pool};
+  visitor.code_batch_size = code_batch_size;
+  StreamingModuleReader<ValidateVisitor> reader{visitor, features, errors};
+  bool ok = true;
+  for (SpanU8 rest = data; !rest.empty();) {
+    Buffer chunk(rest.begin(),
+                 rest.begin() + std::min(chunk_size, rest.size()));
+    rest.remove_prefix(chunk.size());
+    ok &= reader.Push(chunk) == visit::Result::Ok;
+    std::fill(chunk.begin(), chunk.end(), 0xff);
+  }
+  return reader.Finish() == visit::Result::Ok && ok;
+}
+
+// Each error and its context, as the module offset and size of its location,
+// followed by its message.
+template <typename GetOffset>
+auto DescribeErrors(const TestErrors& errors, GetOffset&& get_offset)
+    -> std::vector<std::string> {
+  std::vector<std::string> result;
+  for (const auto& error_list : errors.errors) {
+    for (const auto& error : error_list) {
+      result.push_back(concat(get_offset(error.loc), "+", error.loc.size(),
+                              ": ", error.message));
+    }
+  }
+  return result;
+}
+
+}  // namespace
+
+TEST(ValidateVisitorTest, ParallelMatchesSerial) {
+  TestErrors serial_errors;
+  bool serial_ok = Validate(kModule, serial_errors, nullptr);
+  EXPECT_FALSE(serial_ok);
+  ASSERT_FALSE(serial_errors.errors.empty());
+
+  for (int thread_count : {1, 2, 4}) {
+    ThreadPool pool{thread_count};
+    for (size_t batch_size : kBatchSizes) {
+      TestErrors parallel_errors;
+      bool parallel_ok = Validate(kModule, parallel_errors, &pool, batch_size);
+      EXPECT_EQ(serial_ok, parallel_ok);
+      ExpectErrors(serial_errors.errors, parallel_errors);
+    }
+  }
+}
+
+TEST(ValidateVisitorTest, StreamingParallelMatchesSerial) {
+  TestErrors serial_errors;
+  bool serial_ok = Validate(kModule, serial_errors, nullptr);
+  ASSERT_FALSE(serial_errors.errors.empty());
+
+  auto serial = DescribeErrors(serial_errors, [](Location loc) {
+    return static_cast<size_t>(loc.data() - kModule.data());
+  });
+
+  // The streaming reader must keep each deferred function alive until the
+  // visitor has validated it, and the locations must still refer to the
+  // module once the reader is gone.
+  ThreadPool pool{2};
+  for (size_t batch_size : kBatchSizes) {
+    for (size_t chunk_size = 1; chunk_size <= kModule.size(); ++chunk_size) {
+      TestErrors errors;
+      StreamingErrors streaming_errors{errors};
+      bool ok = ValidateStreaming(kModule, chunk_size, batch_size,
+                                  streaming_errors, &pool);
+      EXPECT_EQ(serial_ok, ok) << "chunk size: " << chunk_size;
+      auto streaming = DescribeErrors(errors, [&](Location loc) {
+        auto offset = streaming_errors.module_offset(loc);
+        EXPECT_TRUE(offset.has_value());
+        EXPECT_EQ(kModule.subspan(offset.value_or(0), loc.size()), loc);
+        return offset.value_or(0);
+      });
+      EXPECT_EQ(serial, streaming)
+          << "chunk size: " << chunk_size << ", batch size: " << batch_size;
+    }
+  }
+}
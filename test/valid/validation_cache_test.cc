@@ -0,0 +1,179 @@
+//
+// Copyright 2020 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "wasp/valid/validation_cache.h"
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+
+#include "gtest/gtest.h"
+#include "test/test_utils.h"
+#include "wasp/base/features.h"
+#include "wasp/base/file.h"
+
+using namespace ::wasp;
+using namespace ::wasp::valid;
+using namespace ::wasp::test;
+
+namespace {
+
+// A module with one type `(func)` and two functions. Function 1 has an
+// invalid body (`drop` with an empty stack).
+const SpanU8 kInvalidModule =
+    "\0asm\x01\x00\x00\x00"
+    "\x01\x04\x01\x60\x00\x00"  // type section
+    "\x03\x03\x02\x00\x00"  // function section
+    "\x0a\x09\x02"  // code section
+    "\x02\x00\x0b"  // func 0
+    "\x04\x00\x01\x1a\x0b"_su8;  // func 1 (invalid)
+
+const SpanU8 kValidModule =
+    "\0asm\x01\x00\x00\x00"
+    "\x01\x04\x01\x60\x00\x00"  // type section
+    "\x03\x02\x01\x00"  // function section
+    "\x0a\x04\x01"  // code section
+    "\x02\x00\x0b"_su8;  // func 0
+
+// Returns a cache with no entries for `data`.
+ValidationCache MakeCache(SpanU8 data, const Features& features) {
+  ValidationCache cache{::testing::TempDir()};
+  std::remove(cache.EntryPath(data, features).c_str());
+  return cache;
+}
+
+}  // namespace
+
+TEST(ValidationCacheTest, MissThenHit) {
+  Features features;
+  auto cache = MakeCache(kInvalidModule, features);
+
+  TestErrors lookup_errors;
+  EXPECT_EQ(nullopt, cache.Lookup(kInvalidModule, features, lookup_errors));
+  ExpectNoErrors(lookup_errors);
+
+  TestErrors miss_errors;
+  EXPECT_FALSE(cache.Validate(kInvalidModule, features, miss_errors));
+  ASSERT_FALSE(miss_errors.errors.empty());
+
+  TestErrors hit_errors;
+  EXPECT_EQ(false, cache.Lookup(kInvalidModule, features, hit_errors));
+  ExpectErrors(miss_errors.errors, hit_errors);
+
+  TestErrors validate_errors;
+  EXPECT_FALSE(cache.Validate(kInvalidModule, features, validate_errors));
+  ExpectErrors(miss_errors.errors, validate_errors);
+}
+
+TEST(ValidationCacheTest, Valid) {
+  Features features;
+  auto cache = MakeCache(kValidModule, features);
+
+  TestErrors errors;
+  EXPECT_TRUE(cache.Validate(kValidModule, features, errors));
+  EXPECT_EQ(true, cache.Lookup(kValidModule, features, errors));
+  ExpectNoErrors(errors);
+}
+
+TEST(ValidationCacheTest, KeyIncludesFeatures) {
+  Features features;
+  Features all_features;
+  all_features.EnableAll();
+  ValidationCache cache{::testing::TempDir()};
+  EXPECT_NE(cache.EntryPath(kValidModule, features),
+            cache.EntryPath(kValidModule, all_features));
+  EXPECT_NE(cache.EntryPath(kValidModule, features),
+            cache.EntryPath(kInvalidModule, features));
+}
+
+TEST(ValidationCacheTest, KeyIncludesValidatorVersion) {
+  Features features;
+  ValidationCache cache{::testing::TempDir()};
+  auto version = ValidationCache::ValidatorVersion();
+  EXPECT_FALSE(version.empty());
+  std::string suffix = "-" + std::string{version} + ".wvc";
+  auto path = cache.EntryPath(kValidModule, features);
+  ASSERT_GE(path.size(), suffix.size());
+  EXPECT_EQ(suffix, path.substr(path.size() - suffix.size()));
+}
+
+TEST(ValidationCacheTest, OtherValidatorVersion) {
+  Features features;
+  auto cache = MakeCache(kInvalidModule, features);
+
+  TestErrors errors;
+  EXPECT_FALSE(cache.Validate(kInvalidModule, features, errors));
+
+  // An entry written by another build of the validator is a miss, even at
+  // the same path.
+  auto entry = ReadFile(cache.EntryPath(kInvalidModule, features));
+  ASSERT_TRUE(entry.has_value());
+  const size_t version_offset = 6 + 1 + 4;  // Magic, format, length.
+  ASSERT_GT(entry->size(), version_offset);
+  (*entry)[version_offset] ^= 1;
+  {
+    std::ofstream stream{cache.EntryPath(kInvalidModule, features),
+                         std::ios::out | std::ios::binary};
+    stream.write(reinterpret_cast<const char*>(entry->data()), entry->size());
+  }
+
+  EXPECT_EQ(nullopt, cache.Lookup(kInvalidModule, features, errors));
+}
+
+TEST(ValidationCacheTest, HitSkipsValidation) {
+  Features features;
+  auto cache = MakeCache(kInvalidModule, features);
+
+  TestErrors errors;
+  EXPECT_TRUE(cache.Validate(kValidModule, features, errors));
+
+  // Give the invalid module the valid module's entry; the cache trusts it.
+  auto entry = ReadFile(cache.EntryPath(kValidModule, features));
+  ASSERT_TRUE(entry.has_value());
+  {
+    std::ofstream stream{cache.EntryPath(kInvalidModule, features),
+                         std::ios::out | std::ios::binary};
+    stream.write(reinterpret_cast<const char*>(entry->data()), entry->size());
+  }
+
+  EXPECT_TRUE(cache.Validate(kInvalidModule, features, errors));
+  ExpectNoErrors(errors);
+}
+
+TEST(ValidationCacheTest, CorruptEntry) {
+  Features features;
+  auto cache = MakeCache(kInvalidModule, features);
+  {
+    std::ofstream stream{cache.EntryPath(kInvalidModule, features),
+                         std::ios::out | std::ios::binary};
+    stream << "not an entry";
+  }
+
+  TestErrors errors;
+  EXPECT_EQ(nullopt, cache.Lookup(kInvalidModule, features, errors));
+  EXPECT_FALSE(cache.Validate(kInvalidModule, features, errors));
+  EXPECT_FALSE(errors.errors.empty());
+  EXPECT_EQ(false, cache.Lookup(kInvalidModule, features, errors));
+}
+
+TEST(ValidationCacheTest, Hash) {
+  EXPECT_EQ(ValidationCache::Hash(kValidModule),
+            ValidationCache::Hash(kValidModule));
+  EXPECT_NE(ValidationCache::Hash(kValidModule),
+            ValidationCache::Hash(kInvalidModule));
+  EXPECT_NE(ValidationCache::Hash("abc"_su8), ValidationCache::Hash("abd"_su8));
+  EXPECT_NE(ValidationCache::Hash(""_su8), ValidationCache::Hash("\0"_su8));
+}
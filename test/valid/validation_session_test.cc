@@ -0,0 +1,207 @@
+//
+// Copyright 2020 WebAssembly Community Group participants
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "wasp/valid/validation_session.h"
+
+#include <string>
+
+#include "gtest/gtest.h"
+
+#include "test/binary/constants.h"
+#include "test/test_utils.h"
+#include "wasp/base/features.h"
+
+using namespace ::wasp;
+using namespace ::wasp::valid;
+using namespace ::wasp::binary;
+using namespace ::wasp::binary::test;
+using namespace ::wasp::test;
+
+namespace {
+
+using I = Instruction;
+using O = Opcode;
+
+auto MakeCode(InstructionList instructions) -> UnpackedCode {
+  instructions.push_back(I{O::End});
+  return UnpackedCode{LocalsList{}, UnpackedExpression{instructions}};
+}
+
+// An imported function 0, and two defined functions 1 and 2, of type (func).
+auto MakeModule() -> Module {
+  Module module;
+  module.types.push_back(DefinedType{FunctionType{}});
+  module.imports.push_back(Import{"a"_sv, "b"_sv, Index{0}});
+  module.functions.push_back(Function{Index{0}});
+  module.functions.push_back(Function{Index{0}});
+  module.exports.push_back(Export{ExternalKind::Function, "f1"_sv, 1});
+  module.codes.push_back(MakeCode({}));
+  module.codes.push_back(MakeCode({I{O::Nop}}));
+  return module;
+}
+
+Features ReferenceTypesFeatures() {
+  Features features;
+  features.enable_reference_types();
+  return features;
+}
+
+}  // namespace
+
+TEST(ValidValidationSessionTest, Validate) {
+  TestErrors errors;
+  ValidationSession session{Features{}, MakeModule()};
+  EXPECT_TRUE(session.Validate(errors));
+  EXPECT_TRUE(session.IsValid());
+  ExpectNoErrors(errors);
+}
+
+TEST(ValidValidationSessionTest, ReplaceFunctionBody) {
+  TestErrors errors;
+  ValidationSession session{Features{}, MakeModule()};
+  ASSERT_TRUE(session.Validate(errors));
+
+  // `drop` with an empty stack.
+  EXPECT_FALSE(session.ReplaceFunctionBody(2, MakeCode({I{O::Drop}}), errors));
+  EXPECT_FALSE(session.IsValid());
+  EXPECT_EQ(1u, errors.errors.size());
+  errors.Clear();
+
+  // Fixing the body makes the module valid again.
+  EXPECT_TRUE(session.ReplaceFunctionBody(
+      2, MakeCode({I{O::I32Const, s32{0}}, I{O::Drop}}), errors));
+  EXPECT_TRUE(session.IsValid());
+  EXPECT_EQ(3u, session.module().codes[1]->body.instructions.size());
+  ExpectNoErrors(errors);
+}
+
+TEST(ValidValidationSessionTest, ReplaceFunctionBody_InvalidIndex) {
+  TestErrors errors;
+  ValidationSession session{Features{}, MakeModule()};
+  ASSERT_TRUE(session.Validate(errors));
+
+  // Function 0 is imported, and function 3 doesn't exist.
+  EXPECT_FALSE(session.ReplaceFunctionBody(0, MakeCode({}), errors));
+  EXPECT_FALSE(session.ReplaceFunctionBody(3, MakeCode({}), errors));
+  EXPECT_EQ(2u, errors.errors.size());
+  EXPECT_TRUE(session.IsValid());
+}
+
+TEST(ValidValidationSessionTest, AddExport) {
+  TestErrors errors;
+  ValidationSession session{Features{}, MakeModule()};
+  ASSERT_TRUE(session.Validate(errors));
+
+  EXPECT_TRUE(
+      session.AddExport(Export{ExternalKind::Function, "f2"_sv, 2}, errors));
+  EXPECT_TRUE(session.IsValid());
+  ExpectNoErrors(errors);
+
+  // Duplicate name.
+  EXPECT_FALSE(
+      session.AddExport(Export{ExternalKind::Function, "f2"_sv, 1}, errors));
+  EXPECT_EQ(1u, errors.errors.size());
+}
+
+TEST(ValidValidationSessionTest, AddExport_Rejected) {
+  TestErrors errors;
+  ValidationSession session{Features{}, MakeModule()};
+  ASSERT_TRUE(session.Validate(errors));
+  auto export_count = session.module().exports.size();
+
+  // Duplicate name.
+  EXPECT_FALSE(
+      session.AddExport(Export{ExternalKind::Function, "f1"_sv, 2}, errors));
+  EXPECT_TRUE(session.IsValid());
+  EXPECT_EQ(export_count, session.module().exports.size());
+  EXPECT_EQ(1u, errors.errors.size());
+
+  // Invalid index; the name isn't kept.
+  EXPECT_FALSE(
+      session.AddExport(Export{ExternalKind::Function, "f2"_sv, 100}, errors));
+  EXPECT_TRUE(session.IsValid());
+  EXPECT_EQ(export_count, session.module().exports.size());
+  EXPECT_EQ(2u, errors.errors.size());
+
+  EXPECT_TRUE(
+      session.AddExport(Export{ExternalKind::Function, "f2"_sv, 2}, errors));
+  EXPECT_TRUE(session.IsValid());
+  EXPECT_EQ(export_count + 1, session.module().exports.size());
+}
+
+TEST(ValidValidationSessionTest, AddExport_RejectedDoesNotDeclare) {
+  TestErrors errors;
+  Module module = MakeModule();
+  module.codes[0] = MakeCode({I{O::RefFunc, Index{2}}, I{O::Drop}});
+  ValidationSession session{ReferenceTypesFeatures(), std::move(module)};
+  EXPECT_FALSE(session.Validate(errors));
+  errors.Clear();
+
+  // A duplicate name doesn't declare function 2, so function 1 stays invalid.
+  EXPECT_FALSE(
+      session.AddExport(Export{ExternalKind::Function, "f1"_sv, 2}, errors));
+  EXPECT_FALSE(session.IsValid());
+  EXPECT_EQ(1u, errors.errors.size());
+}
+
+TEST(ValidValidationSessionTest, AddExport_DeclaresRefFunc) {
+  TestErrors errors;
+  Module module = MakeModule();
+  // Function 1 uses `ref.func 2`, which isn't declared yet.
+  module.codes[0] = MakeCode({I{O::RefFunc, Index{2}}, I{O::Drop}});
+  ValidationSession session{ReferenceTypesFeatures(), std::move(module)};
+  EXPECT_FALSE(session.Validate(errors));
+  EXPECT_FALSE(errors.errors.empty());
+  errors.Clear();
+
+  // Exporting function 2 declares it, so function 1 is now valid.
+  EXPECT_TRUE(
+      session.AddExport(Export{ExternalKind::Function, "f2"_sv, 2}, errors));
+  EXPECT_TRUE(session.IsValid());
+  ExpectNoErrors(errors);
+}
+
+TEST(ValidValidationSessionTest, AddExport_TemporaryName) {
+  TestErrors errors;
+  ValidationSession session{Features{}, MakeModule()};
+  ASSERT_TRUE(session.Validate(errors));
+
+  {
+    std::string name = "f2";
+    EXPECT_TRUE(
+        session.AddExport(Export{ExternalKind::Function, name, 2}, errors));
+    name = "xx";
+  }
+  EXPECT_EQ("f2"_sv, session.module().exports.back()->name.value());
+
+  // The duplicate check uses the session's copy of the first name.
+  std::string name = "f2";
+  EXPECT_FALSE(
+      session.AddExport(Export{ExternalKind::Function, name, 1}, errors));
+  EXPECT_EQ(1u, errors.errors.size());
+}
+
+TEST(ValidValidationSessionTest, EditBeforeValidate) {
+  TestErrors errors;
+  ValidationSession session{Features{}, MakeModule()};
+
+  EXPECT_FALSE(session.ReplaceFunctionBody(1, MakeCode({}), errors));
+  EXPECT_FALSE(
+      session.AddExport(Export{ExternalKind::Function, "f2"_sv, 2}, errors));
+  EXPECT_EQ(2u, errors.errors.size());
+  EXPECT_FALSE(session.IsValid());
+  EXPECT_EQ(1u, session.module().exports.size());
+}